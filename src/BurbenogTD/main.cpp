@@ -10,7 +10,6 @@
 #include "ParticlePhysicsCmpt.h"
 #include "TurnController.h"
 #include "EventManager.h"
-#include "ActorTurnTask.h"
 #include "ParticleForceGen.h"
 
 using namespace engiX;
@@ -28,9 +27,18 @@ public:
     {
         WPN_Pistol,
         WPN_Shell,
+        WPN_Hitscan,
         WPN_COUNT
     };
 
+    enum CollisionLayerType
+    {
+        LAYER_Default,
+        LAYER_Bullet,
+        LAYER_Target,
+        LAYER_Rope
+    };
+
     BurbenogLogic() :
         m_isChargingFirePower(false),
         m_firePowerScaleVelocity(2.0f),
@@ -45,23 +53,74 @@ public:
         REGISTER_EVT(BurbenogLogic, StartFireWeaponEvt);
         REGISTER_EVT(BurbenogLogic, EndFireWeaponEvt);
         REGISTER_EVT(BurbenogLogic, ChangeWeaponEvt);
-        REGISTER_EVT(BurbenogLogic, ActorCreatedEvt);
-        REGISTER_EVT(BurbenogLogic, ActorDestroyedEvt);
         REGISTER_EVT(BurbenogLogic, ActorCollisionEvt);
 
         CBRB(m_controller.Init());
 
+        // Only bullets and targets collide, and only with each other
+        for (CollisionLayer layer = 0; layer < MaxCollisionLayers; ++layer)
+        {
+            Integrator().LayersCollide(LAYER_Bullet, layer, layer == LAYER_Target);
+            Integrator().LayersCollide(LAYER_Target, layer, layer == LAYER_Bullet);
+            Integrator().LayersCollide(LAYER_Rope, layer, false);
+        }
+
         return true;
     }
 
     bool LoadLevel()
     {
         ActorUniquePtr pHeroTank(CreateHero());
-        m_controller.Control(pHeroTank->Id());
+        m_heroId = pHeroTank->Id();
+        m_controller.Control(m_heroId);
 
         CBRB(AddInitActor(std::move(pHeroTank)));
         CBRB(AddInitActor(CreateTerrain()));
         CBRB(AddInitActor(CreateWorldBounds()));
+        CBRB(CreateRope(Vec3(-20.0f, 15.0f, 25.0f)));
+
+        return true;
+    }
+
+    // Chain of particles held by position constraints, it starts horizontal and swings down from its anchor
+    bool CreateRope(const Vec3& anchor)
+    {
+        const int LinkCount = 12;
+        const real LinkLength = 1.0f;
+        const real BendingCompliance = 0.001f;
+
+        std::vector<ActorUniquePtr> links;
+
+        for (int i = 0; i < LinkCount; ++i)
+        {
+            ActorUniquePtr pLink(eNEW Actor(L"RopeLink"));
+
+            SphereMeshComponent::Properties props;
+            props.Color = Color3(DirectX::Colors::Black);
+            props.Radius = 0.3f;
+
+            pLink->Add<SphereMeshComponent>(props);
+            pLink->Add<TransformCmpt>().Position(Vec3(anchor.x + LinkLength * (i + 1), anchor.y, anchor.z));
+
+            ParticlePhysicsCmpt& linkPhy = pLink->Add<ParticlePhysicsCmpt>();
+            linkPhy.Mass(1.0);
+            linkPhy.BaseAcceleraiton(Vec3(0.0f, -10.0f, 0.0f));
+            linkPhy.Radius(0.3f);
+            linkPhy.Layer(LAYER_Rope);
+
+            links.push_back(std::move(pLink));
+        }
+
+        ConstraintSolver().AddAnchor(*links[0], anchor, LinkLength);
+
+        for (int i = 1; i < LinkCount; ++i)
+            ConstraintSolver().AddDistance(*links[i - 1], *links[i], LinkLength);
+
+        for (int i = 2; i < LinkCount; ++i)
+            ConstraintSolver().AddBending(*links[i - 2], *links[i - 1], *links[i], BendingCompliance);
+
+        for (auto& pLink : links)
+            CBRB(AddInitActor(std::move(pLink)));
 
         return true;
     }
@@ -79,10 +138,10 @@ public:
         pActor->Add<SphereMeshComponent>(props);
         pActor->Add<TransformCmpt>();
 
-        m_worldBounds.Radius(50.0f);
+        // Bullets and targets leaving the world are destroyed
+        Volumes().AddSphere(ParticleVolumes::VOLUME_Kill, BoundingSphere(50.0f), (1u << LAYER_Bullet) | (1u << LAYER_Target), true);
 
-        m_taskMgr.AttachTask(
-            StrongTaskPtr(eNEW ActorTurnTask(pActor->Id(), Vec3(0.0, -0.10f, 0.0))));
+        Animator().AddTrack(*pActor, Vec3(0.0, -0.10f, 0.0));
 
         m_worldPullForceId = ForceRegistry().RegisterGenerator(
             std::shared_ptr<ParticleAnchoredSpring>(
@@ -107,8 +166,7 @@ public:
         pActor->Add<CylinderMeshComponent>(props);
         pActor->Add<TransformCmpt>().Position(Vec3(0.0, -30.0, 0.0));
 
-        m_taskMgr.AttachTask(
-            StrongTaskPtr(eNEW ActorTurnTask(pActor->Id(), Vec3(0.0, 0.20f, 0.0))));
+        Animator().AddTrack(*pActor, Vec3(0.0, 0.20f, 0.0));
 
         return pActor;
     }
@@ -151,36 +209,74 @@ public:
             m_firePowerScale += m_firePowerScaleVelocity * time.DeltaTime();
         }
 
+        // The hitscan turret fires every frame while the trigger is held
+        if (m_isChargingFirePower && m_currentWeapon == WPN_Hitscan)
+            FireHitscan();
+
         CollideActors(time);
     }
 
     void CollideActors(const Timer& time)
     {
-        for (auto bulletId : m_bullets)
+        // Contacts come sorted by time of impact and the layers only let bullet/target
+        // contacts through, a bullet only hits the first target on its way
+        std::set<ActorID> spentBullets;
+
+        for (auto& contact : Contacts())
         {
-            auto& b = GetActor(bulletId);
-            
-            if (b.IsNull())
-                continue;
+            ActorID bulletId = contact.A;
+            ActorID targetId = contact.B;
 
-            for (auto targetId : m_targets)
-            {
-                auto& t = GetActor(targetId);
+            auto& a = GetActor(bulletId);
 
-                if (t.IsNull())
-                    continue;;
+            if (a.IsNull() || GetActor(targetId).IsNull())
+                continue;
 
-                BoundingSphere sphereA = t.Get<ParticlePhysicsCmpt>().BoundingMesh();
-                BoundingSphere sphereB = b.Get<ParticlePhysicsCmpt>().BoundingMesh();
+            if (a.Get<ParticlePhysicsCmpt>().Layer() != LAYER_Bullet)
+                std::swap(bulletId, targetId);
 
-                if (sphereA.Collide(sphereB))
-                {
-                    g_EventMgr->Queue(EventPtr(eNEW ActorCollisionEvt(time.TotalTime(), bulletId, targetId)));
-                }
-            }
+            if (!spentBullets.insert(bulletId).second)
+                continue;
+
+            g_EventMgr->Queue(EventPtr(eNEW ActorCollisionEvt(time.TotalTime(), bulletId, targetId)));
         }
     }
     
+    // Casts a fan of rays from the hero nozzle in one batch and destroys the targets hit, no bullet actor is spawned
+    void FireHitscan()
+    {
+        const int RayCount = 9;
+        const real Spread = 0.2f;
+        const real Range = 60.0f;
+
+        auto& a = GetActor(m_heroId);
+
+        if (a.IsNull())
+            return;
+
+        const TransformCmpt& nozzleTsfm = a.Get<TransformCmpt>();
+        RaycastRay rays[RayCount];
+        RaycastHit hits[RayCount];
+
+        for (int i = 0; i < RayCount; ++i)
+        {
+            real angle = Spread * ((real)i / (real)(RayCount - 1) - 0.5f);
+            Vec3 dir = Math::Vec3RotTransform(Vec3(real_sin(angle), 0.0f, real_cos(angle)), nozzleTsfm.Transform());
+
+            rays[i] = RaycastRay(nozzleTsfm.Position(), dir, Range, 1u << LAYER_Target);
+        }
+
+        if (RaycastBatch(rays, RayCount, hits) == 0)
+            return;
+
+        // Several rays of the fan may hit the same target
+        for (auto& hit : hits)
+        {
+            if (hit.Actor != NullActorID && !GetActor(hit.Actor).IsNull())
+                RemoveActor(hit.Actor);
+        }
+    }
+
     void GenerateTarget()
     {
         LogVerbose("Generating Target");
@@ -202,6 +298,12 @@ public:
 
     void OnEndFireWeaponEvt(EventPtr evt)
     {
+        if (m_currentWeapon == WPN_Hitscan)
+        {
+            m_isChargingFirePower = false;
+            return;
+        }
+
         ActorUniquePtr pBullet;
 
         auto& a= g_pApp->Logic()->GetActor(m_heroId);
@@ -220,25 +322,6 @@ public:
         m_isChargingFirePower = false;
     }
 
-    void OnActorCreatedEvt(EventPtr evt)
-    {
-        std::shared_ptr<ActorCreatedEvt> pActorEvt = static_pointer_cast<ActorCreatedEvt>(evt);
-        auto& a = GetActor(pActorEvt->ActorId());
-
-        if (wcscmp(a.Typename(), TargetActorName) == 0)
-            m_targets.insert(pActorEvt->ActorId());
-        else if (wcscmp(a.Typename(), BulletActorName) == 0)
-            m_bullets.insert(pActorEvt->ActorId());
-    }
-
-    void OnActorDestroyedEvt(EventPtr evt)
-    {
-        std::shared_ptr<ActorCreatedEvt> pActorEvt = static_pointer_cast<ActorCreatedEvt>(evt);
-        
-        if (!m_targets.erase(pActorEvt->ActorId()))
-            m_bullets.erase(pActorEvt->ActorId());
-    }
-
     void OnActorCollisionEvt(EventPtr evt)
     {
         std::shared_ptr<ActorCollisionEvt> pActorEvt = static_pointer_cast<ActorCollisionEvt>(evt);
@@ -265,8 +348,8 @@ public:
         pBulletPhy.Mass(1.0);
         pBulletPhy.Velocity(Math::Vec3RotTransform(Vec3(0.0, 10.0, 20.0), nozzleTsfm.Transform()));
         pBulletPhy.BaseAcceleraiton(Math::Vec3RotTransform(Vec3(0.0, -20.0f, 0.0f), nozzleTsfm.Transform()));
-        pBulletPhy.LifetimeBound(m_worldBounds);
         pBulletPhy.Radius(1.0);
+        pBulletPhy.Layer(LAYER_Bullet);
 
         return pBullet;
     }
@@ -287,8 +370,8 @@ public:
         pBulletPhy.Mass(1.0);
         pBulletPhy.Velocity(Math::Vec3RotTransform(Vec3(0.0, 5.0, 30.0), nozzleTsfm.Transform()));
         pBulletPhy.BaseAcceleraiton(Math::Vec3RotTransform(Vec3(0.0, -5.0f, 0.0f), nozzleTsfm.Transform()));
-        pBulletPhy.LifetimeBound(m_worldBounds);
         pBulletPhy.Radius(0.25);
+        pBulletPhy.Layer(LAYER_Bullet);
 
         return pBullet;
     }
@@ -313,9 +396,9 @@ public:
         pTargetPhy.Mass(1.0);
         //pTargetPhy->Velocity(Vec3(0.0, Math::RandF(7, 15), 0.0));
         pTargetPhy.Radius(2.0);
-        pTargetPhy.LifetimeBound(m_worldBounds);
+        pTargetPhy.Layer(LAYER_Target);
 
-        ForceRegistry().RegisterActorForce(pTarget->Id(), m_worldPullForceId);
+        ForceRegistry().RegisterActorForce(*pTarget, m_worldPullForceId);
 
         return pTarget;
     }
@@ -330,9 +413,6 @@ private:
     real m_firePowerScale;
     real m_firePowerScaleVelocity;
     TurnController m_controller;
-    BoundingSphere m_worldBounds;
-    std::set<ActorID> m_bullets;
-    std::set<ActorID> m_targets;
     ParticleForceGenID m_worldPullForceId;
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#if defined(_WIN32)
 #include <wtypes.h>
+#endif
 #include "engiXDefs.h"
 
 namespace engiX
@@ -15,7 +17,9 @@ namespace engiX
         {}
 
         GameLogic* Logic() const { return m_pGameLogic; }
+#if defined(_WIN32)
         virtual bool Init(HINSTANCE hInstance, LPWSTR lpCmdLine) = 0;
+#endif
         virtual void Deinit() = 0;
         virtual void Run() = 0;
         virtual int ExitCode() const = 0;
@@ -1,5 +1,11 @@
 #include "Logger.h"
+#if defined(_WIN32)
 #include <Windows.h>
+#else
+#include <cstdio>
+#include <cstdarg>
+#include <cwchar>
+#endif
 #include "engiXDefs.h"
 
 using namespace engiX;
@@ -33,10 +39,12 @@ void Logger::Init()
 #if defined(DEBUG) | defined(_DEBUG)
         m_logToDebugWindow = true;
 #endif
+#if defined(_WIN32)
         _ASSERTE(!m_isConsoleInitialized);
         m_isConsoleInitialized = m_consoleWindow.Init();
         SetConsoleTitleW(L"engiX Log");
         _ASSERTE(m_isConsoleInitialized);
+#endif
 
         if (m_logToFile)
         {
@@ -69,15 +77,22 @@ void Logger::Log(LogType type,
     const wchar_t* pTxtFormat, ...)
 {
     _ASSERTE(m_isInitialized);
+    // The function name and line locate the call, the file name is not printed
+    (void)pFilename;
 
     wchar_t buffer1[LogBufferMax];
     wchar_t buffer2[LogBufferMax];
 
     va_list formatArgs;
     va_start(formatArgs, pTxtFormat);
+#if defined(_WIN32)
     vswprintf_s(buffer1, pTxtFormat, formatArgs);
+#else
+    vswprintf(buffer1, LogBufferMax, pTxtFormat, formatArgs);
+#endif
     va_end(formatArgs);
 
+#if defined(_WIN32)
     swprintf_s(buffer2, LogBufferMax, L"[%s] %s. {%s:%d}\n",
         LogTypeName[(unsigned)type],
         buffer1,
@@ -88,6 +103,15 @@ void Logger::Log(LogType type,
 
     if (m_logToDebugWindow && (IsDebuggerPresent() == TRUE))
         OutputDebugStringW(buffer2);
+#else
+    swprintf(buffer2, LogBufferMax, L"[%ls] %ls. {%ls:%d}\n",
+        LogTypeName[(unsigned)type],
+        buffer1,
+        pFuncName,
+        line);
+
+    fputws(buffer2, stdout);
+#endif
 
     if (m_logToFile && m_isLogFileInitialized)
         m_pen << buffer2;
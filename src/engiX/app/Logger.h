@@ -1,12 +1,18 @@
 #pragma once
 
 #include <fstream>
+#if defined(_WIN32)
 #include "Console.h"
+#endif
 
 namespace engiX
 {
 
+#if defined(_WIN32)
 #define LOG_FILENAME L"engiXLog.txt"
+#else
+#define LOG_FILENAME "engiXLog.txt"
+#endif
 
     enum LogType
     {
@@ -40,7 +46,9 @@ namespace engiX
         {}
 
         std::wfstream m_pen;
+#if defined(_WIN32)
         CConsole m_consoleWindow;
+#endif
         bool m_logToDebugWindow;
         bool m_isLogFileInitialized;
         bool m_isConsoleInitialized;
@@ -52,13 +60,24 @@ namespace engiX
 
 #define g_Logger					engiX::Logger::Inst()
 
-#if defined(UNICODE) | defined(_UNICODE)
+// Other platforms log to the standard output without the console window, the file and function
+// names are not available as wide strings there
+#if !defined(_WIN32)
+#define LogMsg(Type, Format, ...)   { if ((int)engiX::Type <= g_Logger->LogLevel()) { g_Logger->Log(engiX::Type, L"", L"", __LINE__, L##Format, ##__VA_ARGS__); } }
+#elif defined(UNICODE) | defined(_UNICODE)
 #define LogMsg(Type, Format, ...)   { if ((int)engiX::Type <= g_Logger->LogLevel()) { g_Logger->Log(engiX::Type, __FILEW__, __FUNCTIONW__, __LINE__, L##Format, __VA_ARGS__); } }
 #else
 #define LogMsg(Type, Format, ...)   { if ((int)engiX::Type <= g_Logger->LogLevel()) { g_Logger->Log(engiX::Type, __FILE__, __FUNCTION__, __LINE__, Format, __VA_ARGS__); } }
 #endif
 
+#if defined(_WIN32)
 #define LogError(Format, ...)		LogMsg(LOG_Error, Format, __VA_ARGS__)
 #define LogWarning(Format, ...)		LogMsg(LOG_Warning, Format, __VA_ARGS__)
 #define LogInfo(Format, ...)		LogMsg(LOG_Info, Format, __VA_ARGS__)
 #define LogVerbose(Format, ...)     LogMsg(LOG_Verbose, Format, __VA_ARGS__)
+#else
+#define LogError(Format, ...)		LogMsg(LOG_Error, Format, ##__VA_ARGS__)
+#define LogWarning(Format, ...)		LogMsg(LOG_Warning, Format, ##__VA_ARGS__)
+#define LogInfo(Format, ...)		LogMsg(LOG_Info, Format, ##__VA_ARGS__)
+#define LogVerbose(Format, ...)     LogMsg(LOG_Verbose, Format, ##__VA_ARGS__)
+#endif
@@ -245,6 +245,7 @@ void WinGameApp::CalcAndDisplayFrameStatistics()
     std::wostringstream outs;   
     outs.precision(6);
     outs << GameAppTitle() << L"    "
-        << DXUTGetFrameStats(true);
+        << DXUTGetFrameStats(true) << L"    "
+        << m_pGameLogic->View()->FrameStats();
     SetWindowText(DXUTGetHWND(), outs.str().c_str());
 }
\ No newline at end of file
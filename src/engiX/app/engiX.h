@@ -1,6 +1,8 @@
 #pragma once
 
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
 #include "Timer.h"
 #include "Events.h"
 #include "Delegate.h"
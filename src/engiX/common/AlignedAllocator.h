@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <cstdlib>
+#endif
+#include "Precision.h"
+
+namespace engiX
+{
+    // STL compatible allocator that returns memory aligned on the specified
+    // boundary, it is used to back structure-of-arrays (SoA) containers so that
+    // SIMD code can use the aligned load/store variants (e.g XMLoadFloat4A)
+    template<class T, size_t Alignment>
+    class AlignedAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U>
+        struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+        AlignedAllocator() {}
+        AlignedAllocator(const AlignedAllocator&) {}
+        template<class U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+        size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+        pointer allocate(size_type n, const void* /*hint*/ = 0)
+        {
+#if defined(_WIN32)
+            void* pMem = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+            void* pMem = nullptr;
+            if (posix_memalign(&pMem, Alignment, n * sizeof(T)) != 0)
+                pMem = nullptr;
+#endif
+
+            if (pMem == nullptr)
+                throw std::bad_alloc();
+
+            return static_cast<pointer>(pMem);
+        }
+
+#if defined(_WIN32)
+        void deallocate(pointer p, size_type /*n*/) { _aligned_free(p); }
+#else
+        void deallocate(pointer p, size_type /*n*/) { free(p); }
+#endif
+
+        void construct(pointer p, const T& val) { new((void*)p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+
+        template<class U, class... Args>
+        void construct(U* p, Args&&... args) { new((void*)p) U(std::forward<Args>(args)...); }
+        template<class U>
+        void destroy(U* p) { p->~U(); }
+
+        bool operator == (const AlignedAllocator&) const { return true; }
+        bool operator != (const AlignedAllocator&) const { return false; }
+    };
+
+    // The widest SIMD register the engine targets is AVX 256-bit, aligning
+    // on 32 bytes satisfies both SSE and AVX aligned loads
+    const size_t SimdAlignment = 32;
+
+    typedef std::vector<real, AlignedAllocator<real, SimdAlignment>> RealArray;
+    typedef std::vector<unsigned, AlignedAllocator<unsigned, SimdAlignment>> UIntArray;
+}
@@ -171,62 +171,23 @@ using namespace DirectX;
 //	return randomTexSRV;
 //}
 
-void ExtractFrustumPlanes(XMFLOAT4 planes[6], CXMMATRIX M)
+//---------------------------------------------------------------------------------------------------------------------
+// Gribb/Hartmann plane extraction: with row vectors a clip space point is inside when -w <= x <= w, -w <= y <= w and
+// 0 <= z <= w, each inequality is a plane made of M columns. The transposed matrix rows are these columns. The planes
+// point inwards and are normalized so that dot(plane, (p, 1)) is the signed distance of p to them.
+//---------------------------------------------------------------------------------------------------------------------
+void engiX::ExtractFrustumPlanes(XMFLOAT4 planes[6], CXMMATRIX M)
 {
-	//
-	// Left
-	//
-    planes[0].x = XMVectorGetZ(M.r[0]) + XMVectorGetX(M.r[0]);
-	planes[0].y = XMVectorGetZ(M.r[1]) + XMVectorGetX(M.r[1]);
-	planes[0].z = XMVectorGetZ(M.r[2]) + XMVectorGetX(M.r[2]);
-	planes[0].w = XMVectorGetZ(M.r[3]) + XMVectorGetX(M.r[3]);
+    XMMATRIX T = XMMatrixTranspose(M);
 
-    // Port all the code below to use DirecXMath, follow Left plane porting code
-    assert(0);
-	////
-	//// Right
-	////
-	//planes[1].x = M(0,3) - M(0,0);
-	//planes[1].y = M(1,3) - M(1,0);
-	//planes[1].z = M(2,3) - M(2,0);
-	//planes[1].w = M(3,3) - M(3,0);
+    // Left, right, bottom, top, near, far
+    XMStoreFloat4(&planes[0], XMVectorAdd(T.r[3], T.r[0]));
+    XMStoreFloat4(&planes[1], XMVectorSubtract(T.r[3], T.r[0]));
+    XMStoreFloat4(&planes[2], XMVectorAdd(T.r[3], T.r[1]));
+    XMStoreFloat4(&planes[3], XMVectorSubtract(T.r[3], T.r[1]));
+    XMStoreFloat4(&planes[4], T.r[2]);
+    XMStoreFloat4(&planes[5], XMVectorSubtract(T.r[3], T.r[2]));
 
-	////
-	//// Bottom
-	////
-	//planes[2].x = M(0,3) + M(0,1);
-	//planes[2].y = M(1,3) + M(1,1);
-	//planes[2].z = M(2,3) + M(2,1);
-	//planes[2].w = M(3,3) + M(3,1);
-
-	////
-	//// Top
-	////
-	//planes[3].x = M(0,3) - M(0,1);
-	//planes[3].y = M(1,3) - M(1,1);
-	//planes[3].z = M(2,3) - M(2,1);
-	//planes[3].w = M(3,3) - M(3,1);
-
-	////
-	//// Near
-	////
-	//planes[4].x = M(0,2);
-	//planes[4].y = M(1,2);
-	//planes[4].z = M(2,2);
-	//planes[4].w = M(3,2);
-
-	////
-	//// Far
-	////
-	//planes[5].x = M(0,3) - M(0,2);
-	//planes[5].y = M(1,3) - M(1,2);
-	//planes[5].z = M(2,3) - M(2,2);
-	//planes[5].w = M(3,3) - M(3,2);
-
-	// Normalize the plane equations.
-	for(int i = 0; i < 6; ++i)
-	{
-		XMVECTOR v = XMPlaneNormalize(XMLoadFloat4(&planes[i]));
-		XMStoreFloat4(&planes[i], v);
-	}
-}
\ No newline at end of file
+    for (int i = 0; i < 6; ++i)
+        XMStoreFloat4(&planes[i], XMPlaneNormalize(XMLoadFloat4(&planes[i])));
+}
@@ -2,15 +2,21 @@
 
 #include <list>
 #include <cassert>
+#if defined(_WIN32)
 #include <process.h>
 #include <windows.h>
+#else
+#include <thread>
+#endif
 #include <set>
 #include "engiXDefs.h"
 
 namespace engiX
 {
+#if defined(_WIN32)
     // Used to cast Win32 CreateThread threastart to CRT _beginthreadex threadstart
     typedef unsigned(__stdcall *PfnCrtThreadStartEx)(void*);
+#endif
 
     /// <summary>
     /// Represents a delegate to a member function that returns void and takes no parameters
@@ -70,6 +76,7 @@ namespace engiX
             (m_pObj->*m_pfnCallback)();
         }
 
+#if defined(_WIN32)
         void CallAsync()
         {
             HANDLE hThread = (HANDLE)_beginthreadex(nullptr, 0, (PfnCrtThreadStartEx)CallAsyncThreadStart_Static, this, 0, nullptr);
@@ -86,6 +93,12 @@ namespace engiX
 
             return 0;
         }
+#else
+        void CallAsync()
+        {
+            std::thread(&Delegate::Call, this).detach();
+        }
+#endif
 
     private:
         Callback m_pfnCallback;
@@ -104,7 +117,7 @@ namespace engiX
         Delegate1P(TReciever* pObj, Callback pfnCallback) :
             m_pObj(pObj), m_pfnCallback(pfnCallback) {}
 
-        bool Equals(const IDelegate1P* pOther) const
+        bool Equals(const IDelegate1P<TParam>* pOther) const
         {
             const Delegate1P<TReciever, TParam>* other = static_cast<const Delegate1P<TReciever, TParam>*>(pOther);
             _ASSERTE(pOther);
@@ -147,7 +160,7 @@ namespace engiX
     public:
         typedef std::set<std::shared_ptr<TDelegate>> ObserverList;
 
-        virtual MulticastDelegateBase::~MulticastDelegateBase()
+        virtual ~MulticastDelegateBase()
         {
             m_observers.clear();
         }
@@ -162,7 +175,7 @@ namespace engiX
         /// <param name="pCallback">The delegate to unregister</param>
         /// <returns>true on successful unregister, false otherwise</returns>
         ///
-        bool operator -= (std::shared_ptr<TDelegate> callpCallbackback) { return Unregister(pCallback); }
+        bool operator -= (std::shared_ptr<TDelegate> pCallback) { return Unregister(pCallback); }
 
         /// <summary>Fire the MulticastDelegate by calling all registered delegates</summary>
 
@@ -193,7 +206,7 @@ namespace engiX
         ///
         void operator () () { Fire(); }
 
-        void MulticastDelegate::Fire()
+        void Fire()
         {
             for(auto handler : m_observers)
                 handler->Call();
@@ -213,7 +226,7 @@ namespace engiX
 
         void Fire(TParam param)
         {
-            for(auto handler : m_observers)
+            for(auto handler : this->m_observers)
                 handler->Call(param);
         }
     };
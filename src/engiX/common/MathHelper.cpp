@@ -3,11 +3,12 @@
 //***************************************************************************************
 
 #include "MathHelper.h"
+#include "Random.h"
 #include <float.h>
 #include <cmath>
 
 using namespace engiX;
-using namespace DirectX;
+using namespace engiX::VecMath;
 
 const real Math::Infinity = FLT_MAX;
 const real Math::Pi       = R_PI;
@@ -34,49 +35,29 @@ float Math::AngleFromXY(float x, float y)
 	return theta;
 }
 
-XMVECTOR Math::RandUnitVec3()
+real Math::RandF()
 {
-	XMVECTOR One  = XMVectorSet(1.0f, 1.0f, 1.0f, 1.0f);
-
-	// Keep trying until we get a point on/in the hemisphere.
-	while(true)
-	{
-		// Generate random point in the cube [-1,1]^3.
-		XMVECTOR v = XMVectorSet(Math::RandF(-1.0f, 1.0f), Math::RandF(-1.0f, 1.0f), Math::RandF(-1.0f, 1.0f), 0.0f);
-
-		// Ignore points outside the unit sphere in order to get an even distribution 
-		// over the unit sphere.  Otherwise points will clump more on the sphere near 
-		// the corners of the cube.
-
-		if( XMVector3Greater( XMVector3LengthSq(v), One) )
-			continue;
-
-		return XMVector3Normalize(v);
-	}
+	return Random::ThreadReal();
 }
 
-XMVECTOR Math::RandHemisphereUnitVec3(XMVECTOR n)
+// Direct sampling, a uniform z and a uniform angle around z give a uniform point
+// on the sphere with no rejection loop.
+Vector Math::RandUnitVec3()
 {
-	XMVECTOR One  = XMVectorSet(1.0f, 1.0f, 1.0f, 1.0f);
-	XMVECTOR Zero = XMVectorZero();
+	real z = Math::RandF(-1.0f, 1.0f);
+	real phi = Math::RandF(0.0f, 2.0f*Pi);
+	real r = sqrtf(Math::Max(1.0f - z*z, 0.0f));
 
-	// Keep trying until we get a point on/in the hemisphere.
-	while(true)
-	{
-		// Generate random point in the cube [-1,1]^3.
-		XMVECTOR v = XMVectorSet(Math::RandF(-1.0f, 1.0f), Math::RandF(-1.0f, 1.0f), Math::RandF(-1.0f, 1.0f), 0.0f);
+	return Set(r*cosf(phi), r*sinf(phi), z, 0.0f);
+}
 
-		// Ignore points outside the unit sphere in order to get an even distribution 
-		// over the unit sphere.  Otherwise points will clump more on the sphere near 
-		// the corners of the cube.
-		
-		if( XMVector3Greater( XMVector3LengthSq(v), One) )
-			continue;
+Vector Math::RandHemisphereUnitVec3(Vector n)
+{
+	Vector v = RandUnitVec3();
 
-		// Ignore points in the bottom hemisphere.
-		if( XMVector3Less( XMVector3Dot(n, v), Zero ) )
-			continue;
+	// Flip the points in the bottom hemisphere.
+	if( GetX(Dot3(n, v)) < 0.0f )
+		v = Negate(v);
 
-		return XMVector3Normalize(v);
-	}
+	return v;
 }
\ No newline at end of file
@@ -6,22 +6,20 @@
 
 #pragma  once
 
-#include <Windows.h>
-#include <DirectXMath.h>
-#include <DirectXPackedVector.h>
-#include <crtdbg.h>
 #include "engiXDefs.h"
+#include "VecMath.h"
+
+#if defined(ENGIX_DIRECTXMATH)
+#include <DirectXPackedVector.h>
+#endif
 
 namespace engiX
 {
     class Math
     {
     public:
-        // Returns random real in [0, 1).
-        static real RandF()
-        {
-            return (real)(rand()) / (real)RAND_MAX;
-        }
+        // Returns random real in [0, 1) from the calling thread generator, see Random.
+        static real RandF();
 
         // Returns random real in [a, b).
         static real RandF(real a, real b)
@@ -56,6 +54,7 @@ namespace engiX
         // Returns the polar angle of the point (x,y) in [0, 2*PI).
         static real AngleFromXY(real x, real y);
 
+#if defined(ENGIX_DIRECTXMATH)
         static DirectX::XMMATRIX InverseTranspose(DirectX::CXMMATRIX M)
         {
             // Inverse-transpose is just applied to normals.  So zero out 
@@ -67,6 +66,7 @@ namespace engiX
             DirectX::XMVECTOR det = XMMatrixDeterminant(A);
             return DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(&det, A));
         }
+#endif
 
         // Spherical Coordinates (radius r, inclination Theta, azimuth Phi)
         // Radius r: The radius of the spherical coordinate system
@@ -79,13 +79,13 @@ namespace engiX
         // rotating around the Y axis in the XZ plane is the counter clock wise angle with the vector (1.0, 0.0, 0.0)
         //
         //
-        static void ConvertSphericalToCartesian(_In_ const real& sphericalRadius, _In_ const real& sphericalTheta, _In_ const real& sphericalPhi, _Out_ DirectX::XMFLOAT3& cartesianXyz)
+        static void ConvertSphericalToCartesian(_In_ const real& sphericalRadius, _In_ const real& sphericalTheta, _In_ const real& sphericalPhi, _Out_ Vec3& cartesianXyz)
         {
             _ASSERTE(sphericalRadius >= 0.0f);
             _ASSERTE(sphericalTheta >= 0.0f);
-            _ASSERTE(sphericalTheta <= DirectX::g_XMTwoPi.f[0]);
+            _ASSERTE(sphericalTheta <= 2.0f * Pi);
             _ASSERTE(sphericalPhi >= 0.0f);
-            _ASSERTE(sphericalPhi <= DirectX::g_XMPi.f[0]);
+            _ASSERTE(sphericalPhi <= Pi);
 
             cartesianXyz.x = sphericalRadius * real_sin(sphericalPhi) * real_cos(sphericalTheta);
             cartesianXyz.z = sphericalRadius * real_sin(sphericalPhi) * real_sin(sphericalTheta);
@@ -108,41 +108,35 @@ namespace engiX
         static void Vec3ScaledAdd(_In_ const Vec3& vec, _In_ real scale, _Inout_ Vec3& res)
         {
             // res = res + vec * scale
-            DirectX::XMStoreFloat3(&res,
-                DirectX::XMVectorMultiplyAdd(
-                DirectX::XMLoadFloat3(&vec), DirectX::XMVectorReplicate(scale), DirectX::XMLoadFloat3(&res)));
+            VecMath::Store3(res,
+                VecMath::MultiplyAdd(
+                VecMath::Load3(vec), VecMath::Replicate(scale), VecMath::Load3(res)));
         }
 
         // res = res + a^b
         static void Vec3AddPow(_In_ const real& a, _In_ real b, _Inout_ Vec3& res)
         {
             // res = res + a^b
-            DirectX::XMStoreFloat3(&res,
-                DirectX::XMVectorMultiply(DirectX::XMLoadFloat3(&res), DirectX::XMVectorReplicate(real_pow(a, b))));
+            VecMath::Store3(res,
+                VecMath::Scale(VecMath::Load3(res), real_pow(a, b)));
         }
 
         static Vec3 Vec3RotTransform(_In_ const Vec3& v0, _In_ const Mat4x4& tsfm)
         {
-            Mat4x4 rotTsfm = tsfm;
-            Math::TransformZeroPosition(rotTsfm);
-
-            Vec3 v;
-            DirectX::XMStoreFloat3(&v,
-                DirectX::XMVector3Transform(
-                DirectX::XMLoadFloat3(&v0),
-                DirectX::XMLoadFloat4x4(&rotTsfm)));
-
-            return v;
+            return VecMath::ToVec3(
+                VecMath::TransformNormal3(
+                VecMath::Load3(v0),
+                VecMath::LoadMatrix(tsfm)));
         }
 
         static void Vec3Accumulate(_Inout_ Vec3& v, _In_ const Vec3& acc)
         {
-            DirectX::XMStoreFloat3(&v,
-                DirectX::XMVectorAdd(DirectX::XMLoadFloat3(&v), DirectX::XMLoadFloat3(&acc)));
+            VecMath::Store3(v,
+                VecMath::Add(VecMath::Load3(v), VecMath::Load3(acc)));
         }
 
-        static DirectX::XMVECTOR RandUnitVec3();
-        static DirectX::XMVECTOR RandHemisphereUnitVec3(DirectX::XMVECTOR n);
+        static VecMath::Vector RandUnitVec3();
+        static VecMath::Vector RandHemisphereUnitVec3(VecMath::Vector n);
 
         static const real Infinity;
         static const real Pi;
@@ -81,4 +81,10 @@ namespace engiX {
     #define real_epsilon DBL_EPSILON
     #define R_PI 3.14159265358979
 #endif
+
+    /**
+     * Defines the default accuracy of the batch sine, cosine, exponent
+     * and power, see SimdMath.h.
+     */
+    #define REAL_BATCH_ACCURACY engiX::Simd::ACCURACY_Full
 }
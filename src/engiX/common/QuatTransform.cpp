@@ -0,0 +1,104 @@
+#include "QuatTransform.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace engiX;
+using namespace std;
+using namespace engiX::VecMath;
+
+Vec4 QuatTransform::EulerToQuaternion(_In_ const Vec3& rotationXYZ)
+{
+    return ToVec4(QuaternionRotationRollPitchYaw(rotationXYZ.x, rotationXYZ.y, rotationXYZ.z));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Reads the angles back from the rotation matrix terms, see ToMatrix: _32 = -sin(x), _31 / _33 = tan(y) and
+// _12 / _22 = tan(z). X is in [-PI/2, PI/2], Y and Z in [-PI, PI].
+//---------------------------------------------------------------------------------------------------------------------
+Vec3 QuatTransform::QuaternionToEuler(_In_ const Vec4& rotation)
+{
+    real x = rotation.x;
+    real y = rotation.y;
+    real z = rotation.z;
+    real w = rotation.w;
+
+    real m31 = 2.0f * (x * z + y * w);
+    real m32 = 2.0f * (y * z - x * w);
+    real m33 = 1.0f - 2.0f * (x * x + y * y);
+    real m12 = 2.0f * (x * y + z * w);
+    real m22 = 1.0f - 2.0f * (x * x + z * z);
+
+    return Vec3(
+        asin(max(-1.0f, min(1.0f, -m32))),
+        atan2(m31, m33),
+        atan2(m12, m22));
+}
+
+QuatTransform QuatTransform::Compose(_In_ const QuatTransform& local, _In_ const QuatTransform& parent)
+{
+    Vector parentQ = Load4(parent.Rotation);
+
+    QuatTransform result;
+    Store4(result.Rotation, QuaternionMultiply(Load4(local.Rotation), parentQ));
+    Store3(result.Translation,
+        Add(
+            Rotate3(VecMath::Scale(Load3(local.Translation), parent.Scale), parentQ),
+            Load3(parent.Translation)));
+    result.Scale = local.Scale * parent.Scale;
+
+    return result;
+}
+
+QuatTransform QuatTransform::Inverse() const
+{
+    Vector invQ = QuaternionConjugate(Load4(Rotation));
+    real invScale = 1.0f / Scale;
+
+    QuatTransform result;
+    Store4(result.Rotation, invQ);
+    Store3(result.Translation, VecMath::Scale(Rotate3(Load3(Translation), invQ), -invScale));
+    result.Scale = invScale;
+
+    return result;
+}
+
+Vec3 QuatTransform::TransformPoint(_In_ const Vec3& point) const
+{
+    return ToVec3(
+        Add(
+            Rotate3(VecMath::Scale(Load3(point), Scale), Load4(Rotation)),
+            Load3(Translation)));
+}
+
+Vec3 QuatTransform::TransformDirection(_In_ const Vec3& direction) const
+{
+    return ToVec3(Rotate3(Load3(direction), Load4(Rotation)));
+}
+
+// Third row of the rotation matrix, no need to rotate a vector
+Vec3 QuatTransform::Forward() const
+{
+    real x = Rotation.x;
+    real y = Rotation.y;
+    real z = Rotation.z;
+    real w = Rotation.w;
+
+    return Vec3(
+        2.0f * (x * z + y * w),
+        2.0f * (y * z - x * w),
+        1.0f - 2.0f * (x * x + y * y));
+}
+
+Mat4x4 QuatTransform::ToMatrix() const
+{
+    Matrix m = MatrixRotationQuaternion(Load4(Rotation));
+    m.r[0] = VecMath::Scale(m.r[0], Scale);
+    m.r[1] = VecMath::Scale(m.r[1], Scale);
+    m.r[2] = VecMath::Scale(m.r[2], Scale);
+    m.r[3] = Set(Translation.x, Translation.y, Translation.z, 1.0f);
+
+    Mat4x4 result;
+    StoreMatrix(result, m);
+
+    return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engiXDefs.h"
+#include "VecMath.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // QuatTransform struct
+    //
+    // Rotation quaternion, translation and uniform scale, a point p maps to Rotate(p * Scale) + Translation. Compose,
+    // Inverse and the point and direction transforms work on the quaternion directly, which takes fewer operations than
+    // the 4x4 matrix path and keeps the rotation orthonormal when transforms are chained, e.g world to view.
+    // ToMatrix gives the equivalent DirectX row-vector matrix.
+    //
+    // Euler angles follow the TransformCmpt order: Z first, then X, then Y.
+    //---------------------------------------------------------------------------------------------------------------------
+    struct QuatTransform
+    {
+        QuatTransform() :
+            Rotation(0.0f, 0.0f, 0.0f, 1.0f),
+            Translation(0.0f, 0.0f, 0.0f),
+            Scale(1.0f)
+        {}
+
+        QuatTransform(_In_ const Vec4& rotation, _In_ const Vec3& translation, _In_ real scale = 1.0f) :
+            Rotation(rotation),
+            Translation(translation),
+            Scale(scale)
+        {}
+
+        static Vec4 EulerToQuaternion(_In_ const Vec3& rotationXYZ);
+        static Vec3 QuaternionToEuler(_In_ const Vec4& rotation);
+        // Transform that applies local then parent
+        static QuatTransform Compose(_In_ const QuatTransform& local, _In_ const QuatTransform& parent);
+
+        QuatTransform Inverse() const;
+        Vec3 TransformPoint(_In_ const Vec3& point) const;
+        // Rotation only, directions are neither scaled nor translated
+        Vec3 TransformDirection(_In_ const Vec3& direction) const;
+        // Rotated +Z axis
+        Vec3 Forward() const;
+        Mat4x4 ToMatrix() const;
+
+        Vec4 Rotation;
+        Vec3 Translation;
+        real Scale;
+    };
+}
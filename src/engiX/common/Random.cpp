@@ -0,0 +1,249 @@
+#include "Random.h"
+#include <atomic>
+#include <algorithm>
+
+#if defined(ENGIX_DIRECTXMATH)
+#include "WorkerPool.h"
+#endif
+
+#if defined(_XM_SSE_INTRINSICS_)
+#include <emmintrin.h>
+#endif
+
+// VS2013 has no thread_local, __declspec(thread) works for the plain data the thread generator needs
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define ENGIX_THREAD_LOCAL __declspec(thread)
+#else
+#define ENGIX_THREAD_LOCAL thread_local
+#endif
+
+using namespace engiX;
+using namespace std;
+
+const uint64_t Random::DefaultSeed = 0x2545F4914F6CDD1DULL;
+
+static ENGIX_THREAD_LOCAL uint32_t t_threadState[4];
+static ENGIX_THREAD_LOCAL bool t_isThreadSeeded = false;
+static atomic<uint64_t> s_nextThreadStream(0);
+
+static uint64_t SplitMix64(_Inout_ uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint32_t RotateLeft(_In_ uint32_t x, _In_ int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+void Random::ExpandSeed(_In_ uint64_t seed, _In_ uint64_t stream, _Out_ uint32_t state[4])
+{
+    // The stream is mixed in before the expansion so that consecutive streams start far apart
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    uint64_t a = SplitMix64(x);
+    uint64_t b = SplitMix64(x);
+
+    state[0] = uint32_t(a);
+    state[1] = uint32_t(a >> 32);
+    state[2] = uint32_t(b);
+    state[3] = uint32_t(b >> 32);
+
+    // The all zero state is the only one that never leaves itself
+    if ((state[0] | state[1] | state[2] | state[3]) == 0)
+        state[0] = 1;
+}
+
+uint32_t Random::Next(_Inout_ uint32_t s[4])
+{
+    uint32_t result = s[0] + s[3];
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 11);
+
+    return result;
+}
+
+void Random::SeedThread(_In_ uint64_t seed, _In_ uint64_t stream)
+{
+    ExpandSeed(seed, stream, t_threadState);
+    t_isThreadSeeded = true;
+}
+
+real Random::ThreadReal()
+{
+    if (!t_isThreadSeeded)
+        SeedThread(DefaultSeed, s_nextThreadStream++);
+
+    return ToReal(Next(t_threadState));
+}
+
+#if defined(ENGIX_DIRECTXMATH)
+using namespace DirectX;
+
+void Random4::Seed(_In_ uint64_t seed, _In_ uint64_t stream)
+{
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        uint32_t laneState[4];
+        Random::ExpandSeed(seed, stream * 4 + lane, laneState);
+
+        for (int w = 0; w < 4; ++w)
+            m_state[w][lane] = laneState[w];
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Random::Next on the 4 lanes at once, SSE2 has no 32 bit rotate so it is done with 2 shifts
+//---------------------------------------------------------------------------------------------------------------------
+XMVECTOR XM_CALLCONV Random4::NextReal4()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    __m128i s0 = _mm_loadu_si128((const __m128i*)m_state[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)m_state[1]);
+    __m128i s2 = _mm_loadu_si128((const __m128i*)m_state[2]);
+    __m128i s3 = _mm_loadu_si128((const __m128i*)m_state[3]);
+
+    __m128i result = _mm_add_epi32(s0, s3);
+    __m128i t = _mm_slli_epi32(s1, 9);
+
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+    _mm_storeu_si128((__m128i*)m_state[0], s0);
+    _mm_storeu_si128((__m128i*)m_state[1], s1);
+    _mm_storeu_si128((__m128i*)m_state[2], s2);
+    _mm_storeu_si128((__m128i*)m_state[3], s3);
+
+    // Same conversion as Random::ToReal, the 24 bit integers convert exactly
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(result, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+#else
+    XMFLOAT4A lanes;
+    real* pLanes = &lanes.x;
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        uint32_t laneState[4] = { m_state[0][lane], m_state[1][lane], m_state[2][lane], m_state[3][lane] };
+        pLanes[lane] = Random::ToReal(Random::Next(laneState));
+
+        for (int w = 0; w < 4; ++w)
+            m_state[w][lane] = laneState[w];
+    }
+
+    return XMLoadFloat4A(&lanes);
+#endif
+}
+
+// A last partial group still consumes 4 numbers per lane
+void Random4::FillUniform(_Out_ real* p, _In_ size_t count, _In_ real a, _In_ real b)
+{
+    XMVECTOR vA = XMVectorReplicate(a);
+    XMVECTOR vRange = XMVectorReplicate(b - a);
+    XMFLOAT4A lanes;
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        XMVECTOR v = XMVectorMultiplyAdd(NextReal4(), vRange, vA);
+
+        if (i + 4 <= count)
+        {
+            XMStoreFloat4((XMFLOAT4*)(p + i), v);
+        }
+        else
+        {
+            XMStoreFloat4A(&lanes, v);
+            copy(&lanes.x, &lanes.x + (count - i), p + i);
+        }
+    }
+}
+
+void Random4::FillUnitVec3(_Out_ real* pX, _Out_ real* pY, _Out_ real* pZ, _In_ size_t count)
+{
+    const XMVECTOR one = XMVectorReplicate(1.0f);
+    const XMVECTOR two = XMVectorReplicate(2.0f);
+    const XMVECTOR twoPi = XMVectorReplicate(XM_2PI);
+    XMFLOAT4A lanes[3];
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        XMVECTOR z = XMVectorSubtract(XMVectorMultiply(NextReal4(), two), one);
+        XMVECTOR phi = XMVectorMultiply(NextReal4(), twoPi);
+        XMVECTOR r = XMVectorSqrt(XMVectorMax(XMVectorNegativeMultiplySubtract(z, z, one), XMVectorZero()));
+        XMVECTOR sinPhi, cosPhi;
+
+        XMVectorSinCos(&sinPhi, &cosPhi, phi);
+
+        XMStoreFloat4A(&lanes[0], XMVectorMultiply(r, cosPhi));
+        XMStoreFloat4A(&lanes[1], XMVectorMultiply(r, sinPhi));
+        XMStoreFloat4A(&lanes[2], z);
+
+        size_t n = min(count - i, size_t(4));
+
+        copy(&lanes[0].x, &lanes[0].x + n, pX + i);
+        copy(&lanes[1].x, &lanes[1].x + n, pY + i);
+        copy(&lanes[2].x, &lanes[2].x + n, pZ + i);
+    }
+}
+
+void Random4::FillHemisphereVec3(_In_ const Vec3& normal, _Out_ real* pX, _Out_ real* pY, _Out_ real* pZ, _In_ size_t count)
+{
+    FillUnitVec3(pX, pY, pZ, count);
+
+    const XMVECTOR nX = XMVectorReplicate(normal.x);
+    const XMVECTOR nY = XMVectorReplicate(normal.y);
+    const XMVECTOR nZ = XMVectorReplicate(normal.z);
+    const XMVECTOR signBit = XMVectorReplicateInt(0x80000000);
+    XMFLOAT4A lanes[3];
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        size_t n = min(count - i, size_t(4));
+
+        // Partial groups are padded with 0, which is on the normal side and left alone
+        XMFLOAT4A x(0.0f, 0.0f, 0.0f, 0.0f), y(0.0f, 0.0f, 0.0f, 0.0f), z(0.0f, 0.0f, 0.0f, 0.0f);
+        copy(pX + i, pX + i + n, &x.x);
+        copy(pY + i, pY + i + n, &y.x);
+        copy(pZ + i, pZ + i + n, &z.x);
+
+        XMVECTOR vX = XMLoadFloat4A(&x);
+        XMVECTOR vY = XMLoadFloat4A(&y);
+        XMVECTOR vZ = XMLoadFloat4A(&z);
+
+        // Flip the vectors below the plane by xoring the dot product sign into the components
+        XMVECTOR dot = XMVectorMultiplyAdd(vZ, nZ, XMVectorMultiplyAdd(vY, nY, XMVectorMultiply(vX, nX)));
+        XMVECTOR flip = XMVectorAndInt(dot, signBit);
+
+        XMStoreFloat4A(&lanes[0], XMVectorXorInt(vX, flip));
+        XMStoreFloat4A(&lanes[1], XMVectorXorInt(vY, flip));
+        XMStoreFloat4A(&lanes[2], XMVectorXorInt(vZ, flip));
+
+        copy(&lanes[0].x, &lanes[0].x + n, pX + i);
+        copy(&lanes[1].x, &lanes[1].x + n, pY + i);
+        copy(&lanes[2].x, &lanes[2].x + n, pZ + i);
+    }
+}
+
+void Random4::ParallelBlocks(_In_ WorkerPool& workers, _In_ uint64_t seed, _In_ size_t count, _In_ const BlockJob& job)
+{
+    size_t blockCount = (count + StreamBlockSize - 1) / StreamBlockSize;
+
+    workers.ParallelFor(blockCount, 1, [&](size_t beginBlock, size_t endBlock) {
+        for (size_t b = beginBlock; b < endBlock; ++b)
+        {
+            Random4 rng(seed, b);
+            job(rng, b * StreamBlockSize, min((b + 1) * StreamBlockSize, count));
+        }
+    });
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include "engiXDefs.h"
+
+#if defined(ENGIX_DIRECTXMATH)
+#include "Simd.h"
+#endif
+
+namespace engiX
+{
+    class WorkerPool;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // Random class
+    //
+    // xoshiro128+ pseudo random generator, 128 bits of state and a 2^128 - 1 period. A generator is identified by a
+    // seed and a stream, the state is expanded from both with SplitMix64, so the same seed and stream always give
+    // the same sequence and different streams give unrelated sequences. Jobs running in parallel get reproducible
+    // results by using one stream each, see Random4::ParallelBlocks.
+    //
+    // Each thread also has its own generator behind ThreadReal, seeded on first use with DefaultSeed and the next
+    // free stream, or explicitly with SeedThread. Math::RandF uses it.
+    //---------------------------------------------------------------------------------------------------------------------
+    class Random
+    {
+    public:
+        static const uint64_t DefaultSeed;
+
+        Random(_In_ uint64_t seed = DefaultSeed, _In_ uint64_t stream = 0) { Seed(seed, stream); }
+        void Seed(_In_ uint64_t seed, _In_ uint64_t stream = 0) { ExpandSeed(seed, stream, m_state); }
+        uint32_t NextUInt() { return Next(m_state); }
+        // Uniform in [0, 1)
+        real NextReal() { return ToReal(Next(m_state)); }
+        // Uniform in [a, b)
+        real NextReal(_In_ real a, _In_ real b) { return a + NextReal() * (b - a); }
+
+        static void SeedThread(_In_ uint64_t seed, _In_ uint64_t stream);
+        static real ThreadReal();
+
+        // Generator core shared with Random4 scalar lanes
+        static void ExpandSeed(_In_ uint64_t seed, _In_ uint64_t stream, _Out_ uint32_t state[4]);
+        static uint32_t Next(_Inout_ uint32_t state[4]);
+        // The upper 24 bits scaled to [0, 1), exact in single precision
+        static real ToReal(_In_ uint32_t x) { return real(x >> 8) * (1.0f / 16777216.0f); }
+
+    private:
+        uint32_t m_state[4];
+    };
+
+#if defined(ENGIX_DIRECTXMATH)
+    //---------------------------------------------------------------------------------------------------------------------
+    // Random4 class
+    //
+    // 4 xoshiro128+ generators side by side, stepped 4 lanes per instruction. Lane i of stream s is the Random
+    // sequence of stream s * 4 + i, the SIMD and scalar flavors produce the same numbers. The Fill methods write SoA
+    // arrays and always consume whole groups of 4 numbers, so the output of a given seed and stream only depends on
+    // the fill calls order and counts.
+    //
+    // Unit vectors are sampled directly instead of by rejection: z = 2u - 1 and phi = 2 Pi v give a uniform point
+    // on the sphere at (sqrt(1 - z^2) cos(phi), sqrt(1 - z^2) sin(phi), z). Hemisphere vectors are unit vectors
+    // flipped to the normal side.
+    //---------------------------------------------------------------------------------------------------------------------
+    class Random4
+    {
+    public:
+        // Elements per stream for ParallelBlocks, the results do not depend on how the pool splits the range
+        static const size_t StreamBlockSize = 1024;
+
+        typedef std::function<void(Random4& rng, size_t begin, size_t end)> BlockJob;
+
+        Random4(_In_ uint64_t seed = Random::DefaultSeed, _In_ uint64_t stream = 0) { Seed(seed, stream); }
+        void Seed(_In_ uint64_t seed, _In_ uint64_t stream = 0);
+        // 4 uniform reals in [0, 1)
+        DirectX::XMVECTOR XM_CALLCONV NextReal4();
+
+        void FillUniform(_Out_ real* p, _In_ size_t count, _In_ real a = 0.0f, _In_ real b = 1.0f);
+        void FillUnitVec3(_Out_ real* pX, _Out_ real* pY, _Out_ real* pZ, _In_ size_t count);
+        void FillHemisphereVec3(_In_ const Vec3& normal, _Out_ real* pX, _Out_ real* pY, _Out_ real* pZ, _In_ size_t count);
+
+        // Runs job over [0, count) in StreamBlockSize blocks spread on the workers, block b gets stream b
+        static void ParallelBlocks(_In_ WorkerPool& workers, _In_ uint64_t seed, _In_ size_t count, _In_ const BlockJob& job);
+
+    private:
+        // Lane i of state word w at m_state[w][i]
+        uint32_t m_state[4][4];
+    };
+#endif
+}
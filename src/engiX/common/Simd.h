@@ -0,0 +1,78 @@
+#pragma once
+
+#include "engiXDefs.h"
+
+//
+// SIMD batch kernel configuration
+//
+// Batch kernels (particle integration, broadphase, culling, etc.) work on structure-of-arrays data
+// and come in 3 flavors selected at compile time:
+//  - AVX: 8 lanes per instruction, enabled when the compiler targets AVX (/arch:AVX)
+//  - SSE: 4 lanes per instruction through DirectXMath, the engine default (/arch:SSE2)
+//  - Scalar: plain C++ loops, forced by defining ENGIX_SIMD_SCALAR, when DirectXMath is compiled
+//    with _XM_NO_INTRINSICS_ or when it is not available, see VecMath.h
+//
+#if (defined(_XM_NO_INTRINSICS_) || !defined(ENGIX_DIRECTXMATH)) && !defined(ENGIX_SIMD_SCALAR)
+#define ENGIX_SIMD_SCALAR
+#endif
+
+#if !defined(ENGIX_SIMD_SCALAR) && defined(__AVX__)
+#define ENGIX_SIMD_AVX
+#include <immintrin.h>
+#endif
+
+namespace engiX
+{
+    namespace Simd
+    {
+#if defined(ENGIX_SIMD_AVX)
+        const size_t Width = 8;
+#elif defined(ENGIX_SIMD_SCALAR)
+        const size_t Width = 1;
+#else
+        const size_t Width = 4;
+#endif
+
+        // SoA arrays consumed by the batch kernels are padded to a multiple of the
+        // widest batch so that any kernel flavor can run without a scalar tail
+        const size_t BatchPadding = 8;
+
+        inline size_t PaddedCount(_In_ size_t count) { return (count + BatchPadding - 1) & ~(BatchPadding - 1); }
+
+#if defined(ENGIX_DIRECTXMATH)
+        inline DirectX::XMVECTOR XM_CALLCONV Load4(_In_ const real* p) { return DirectX::XMLoadFloat4A((const DirectX::XMFLOAT4A*)p); }
+        inline void XM_CALLCONV Store4(_Out_ real* p, _In_ DirectX::FXMVECTOR v) { DirectX::XMStoreFloat4A((DirectX::XMFLOAT4A*)p, v); }
+        // Loads 4 lanes of 0 / ~0 bit masks, e.g to AND with a comparison mask
+        inline DirectX::XMVECTOR XM_CALLCONV LoadMask4(_In_ const unsigned* p) { return DirectX::XMLoadInt4A((const uint32_t*)p); }
+
+        // Indexed load/store of 4 lanes from/to non contiguous elements of a SoA array
+        inline DirectX::XMVECTOR XM_CALLCONV Gather4(_In_ const real* p, _In_ const unsigned* pIdx)
+        {
+            return DirectX::XMVectorSet(p[pIdx[0]], p[pIdx[1]], p[pIdx[2]], p[pIdx[3]]);
+        }
+
+        inline void XM_CALLCONV ScatterAdd4(_Inout_ real* p, _In_ const unsigned* pIdx, _In_ DirectX::FXMVECTOR v)
+        {
+            DirectX::XMFLOAT4A lanes;
+            DirectX::XMStoreFloat4A(&lanes, v);
+            p[pIdx[0]] += lanes.x;
+            p[pIdx[1]] += lanes.y;
+            p[pIdx[2]] += lanes.z;
+            p[pIdx[3]] += lanes.w;
+        }
+
+        // Returns the sign bit of each of the 4 lanes of a comparison mask packed in the lower 4 bits
+        inline unsigned XM_CALLCONV MoveMask4(_In_ DirectX::FXMVECTOR mask)
+        {
+#if defined(_XM_SSE_INTRINSICS_)
+            return (unsigned)_mm_movemask_ps(mask);
+#else
+            return (DirectX::XMVectorGetIntX(mask) ? 1u : 0u) |
+                (DirectX::XMVectorGetIntY(mask) ? 2u : 0u) |
+                (DirectX::XMVectorGetIntZ(mask) ? 4u : 0u) |
+                (DirectX::XMVectorGetIntW(mask) ? 8u : 0u);
+#endif
+        }
+#endif
+    }
+}
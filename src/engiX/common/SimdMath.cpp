@@ -0,0 +1,363 @@
+#include "SimdMath.h"
+#include <algorithm>
+
+using namespace engiX;
+using namespace engiX::Simd;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------
+// Polynomial coefficients
+//
+// Full is the Cephes single precision set. Medium and Fast are minimax fits on the same reduced ranges, for sine
+// and cosine |r| <= Pi/4, for the exponent |r| <= ln(2)/2 and for the logarithm |s| <= 3 - 2 sqrt(2) where
+// ln(m) = 2 atanh(s), s = (m - 1) / (m + 1).
+//---------------------------------------------------------------------------------------------------------------------
+
+// Exponent inputs range, see SimdMath.h
+static const real ExpMin = -87.0f;
+static const real ExpMax = 88.0f;
+
+#if !defined(ENGIX_SIMD_SCALAR)
+// Pi/2 split in 3 so that x - j Pi/2 is exact for |j| < 2^12
+static const real PiOver2Hi = 1.5703125f;
+static const real PiOver2Mid = 4.837512969970703125e-4f;
+static const real PiOver2Lo = 7.54978995489188216e-8f;
+static const real TwoOverPi = 0.636619772367581343f;
+
+// ln(2) split in 2 so that x - n ln(2) is exact for the clamped inputs
+static const real Ln2Hi = 0.693359375f;
+static const real Ln2Lo = -2.12194440e-4f;
+static const real Log2E = 1.44269504088896341f;
+
+static const real Sqrt2 = 1.41421356237309505f;
+
+// Loads count < 4 elements padded with 1, which is in every function domain
+static XMVECTOR XM_CALLCONV LoadPartial4(_In_ const real* p, _In_ size_t count)
+{
+    XMFLOAT4A lanes(1.0f, 1.0f, 1.0f, 1.0f);
+    copy(p, p + count, &lanes.x);
+    return XMLoadFloat4A(&lanes);
+}
+
+static void XM_CALLCONV StorePartial4(_Out_ real* p, _In_ FXMVECTOR v, _In_ size_t count)
+{
+    XMFLOAT4A lanes;
+    XMStoreFloat4A(&lanes, v);
+    copy(&lanes.x, &lanes.x + count, p);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Sine and cosine of the 4 lanes, x is reduced to r = x - j Pi/2 with j the nearest integer, then:
+//  sin(x) = sin(r), cos(r), -sin(r), -cos(r) for j mod 4 = 0, 1, 2, 3
+//  cos(x) = cos(r), -sin(r), -cos(r), sin(r) for j mod 4 = 0, 1, 2, 3
+// The quadrant tests use integer lanes so that j stays exact, (j + 1) mod 4 gives the cosine sign.
+//---------------------------------------------------------------------------------------------------------------------
+template<MathAccuracy Accuracy>
+static void XM_CALLCONV SinCos4(_In_ FXMVECTOR x, _Out_ XMVECTOR* pSin, _Out_ XMVECTOR* pCos)
+{
+    XMVECTOR j = XMVectorRound(XMVectorMultiply(x, XMVectorReplicate(TwoOverPi)));
+
+    XMVECTOR r = XMVectorNegativeMultiplySubtract(j, XMVectorReplicate(PiOver2Hi), x);
+    r = XMVectorNegativeMultiplySubtract(j, XMVectorReplicate(PiOver2Mid), r);
+    r = XMVectorNegativeMultiplySubtract(j, XMVectorReplicate(PiOver2Lo), r);
+
+    XMVECTOR z = XMVectorMultiply(r, r);
+    XMVECTOR sinR;
+    XMVECTOR cosR;
+
+    // sin(r) = r + r^3 P(r^2), cos(r) = 1 + r^2 Q(r^2)
+    if (Accuracy == ACCURACY_Full)
+    {
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(-1.9515295891e-4f), z, XMVectorReplicate(8.3321608736e-3f));
+        p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(-1.6666654611e-1f));
+        sinR = XMVectorMultiplyAdd(XMVectorMultiply(p, z), r, r);
+
+        XMVECTOR q = XMVectorMultiplyAdd(XMVectorReplicate(2.443315711809948e-5f), z, XMVectorReplicate(-1.388731625493765e-3f));
+        q = XMVectorMultiplyAdd(q, z, XMVectorReplicate(4.166664568298827e-2f));
+        q = XMVectorMultiplyAdd(q, z, XMVectorReplicate(-0.5f));
+        cosR = XMVectorMultiplyAdd(q, z, XMVectorReplicate(1.0f));
+    }
+    else if (Accuracy == ACCURACY_Medium)
+    {
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(8.163281925714186e-3f), z, XMVectorReplicate(-1.6663390377530968e-1f));
+        sinR = XMVectorMultiplyAdd(XMVectorMultiply(p, z), r, r);
+
+        XMVECTOR q = XMVectorMultiplyAdd(XMVectorReplicate(4.0488935878976874e-2f), z, XMVectorReplicate(-4.997763070932839e-1f));
+        cosR = XMVectorMultiplyAdd(q, z, XMVectorReplicate(1.0f));
+    }
+    else
+    {
+        sinR = XMVectorMultiplyAdd(XMVectorMultiply(XMVectorReplicate(-1.624279152104156e-1f), z), r, r);
+        cosR = XMVectorMultiplyAdd(XMVectorReplicate(-4.791038368149084e-1f), z, XMVectorReplicate(1.0f));
+    }
+
+    XMVECTOR one = XMVectorReplicateInt(1);
+    XMVECTOR two = XMVectorReplicateInt(2);
+    XMVECTOR quadrant = XMConvertVectorFloatToInt(j, 0);
+    XMVECTOR nextQuadrant = XMConvertVectorFloatToInt(XMVectorAdd(j, XMVectorReplicate(1.0f)), 0);
+
+    XMVECTOR isOdd = XMVectorEqualInt(XMVectorAndInt(quadrant, one), one);
+    XMVECTOR isSinNegative = XMVectorEqualInt(XMVectorAndInt(quadrant, two), two);
+    XMVECTOR isCosNegative = XMVectorEqualInt(XMVectorAndInt(nextQuadrant, two), two);
+
+    XMVECTOR s = XMVectorSelect(sinR, cosR, isOdd);
+    XMVECTOR c = XMVectorSelect(cosR, sinR, isOdd);
+
+    *pSin = XMVectorSelect(s, XMVectorNegate(s), isSinNegative);
+    *pCos = XMVectorSelect(c, XMVectorNegate(c), isCosNegative);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// e^x = 2^n e^r with n the nearest integer to x / ln(2) and r = x - n ln(2), 2^n is built from its exponent bits
+// since n + 127 is in the normal range for the clamped inputs
+//---------------------------------------------------------------------------------------------------------------------
+template<MathAccuracy Accuracy>
+static XMVECTOR XM_CALLCONV Exp4(_In_ FXMVECTOR x)
+{
+    XMVECTOR clamped = XMVectorClamp(x, XMVectorReplicate(ExpMin), XMVectorReplicate(ExpMax));
+    XMVECTOR n = XMVectorRound(XMVectorMultiply(clamped, XMVectorReplicate(Log2E)));
+
+    XMVECTOR r = XMVectorNegativeMultiplySubtract(n, XMVectorReplicate(Ln2Hi), clamped);
+    r = XMVectorNegativeMultiplySubtract(n, XMVectorReplicate(Ln2Lo), r);
+
+    XMVECTOR one = XMVectorReplicate(1.0f);
+    XMVECTOR expR;
+
+    if (Accuracy == ACCURACY_Full)
+    {
+        // e^r = 1 + r + r^2 P(r)
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(1.9875691500e-4f), r, XMVectorReplicate(1.3981999507e-3f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(8.3334519073e-3f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(4.1665795894e-2f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(1.6666665459e-1f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(5.0000001201e-1f));
+        expR = XMVectorAdd(XMVectorMultiplyAdd(p, XMVectorMultiply(r, r), r), one);
+    }
+    else if (Accuracy == ACCURACY_Medium)
+    {
+        // e^r = 1 + r P(r)
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(4.1513847125519476e-2f), r, XMVectorReplicate(1.67874733621068e-1f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(5.000301364957984e-1f));
+        p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(9.999668365262527e-1f));
+        expR = XMVectorMultiplyAdd(p, r, one);
+    }
+    else
+    {
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(4.992455383061105e-1f), r, XMVectorReplicate(1.0141306452230543f));
+        expR = XMVectorMultiplyAdd(p, r, one);
+    }
+
+    XMVECTOR twoPowN = XMConvertVectorFloatToInt(XMVectorAdd(n, XMVectorReplicate(127.0f)), 23);
+
+    return XMVectorMultiply(expR, twoPowN);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// ln(x) = e ln(2) + ln(m) with x = m 2^e and m in [sqrt(2)/2, sqrt(2)), ln(m) = 2s + s^3 P(s^2) with
+// s = (m - 1) / (m + 1). Only meant for Pow, x must be a positive normal number.
+//---------------------------------------------------------------------------------------------------------------------
+template<MathAccuracy Accuracy>
+static XMVECTOR XM_CALLCONV Log4(_In_ FXMVECTOR x)
+{
+    XMVECTOR one = XMVectorReplicate(1.0f);
+    XMVECTOR e = XMVectorSubtract(
+        XMConvertVectorIntToFloat(XMVectorAndInt(x, XMVectorReplicateInt(0x7F800000)), 23),
+        XMVectorReplicate(127.0f));
+    XMVECTOR m = XMVectorOrInt(XMVectorAndInt(x, XMVectorReplicateInt(0x007FFFFF)), one);
+
+    XMVECTOR isAboveSqrt2 = XMVectorGreater(m, XMVectorReplicate(Sqrt2));
+    m = XMVectorSelect(m, XMVectorMultiply(m, XMVectorReplicate(0.5f)), isAboveSqrt2);
+    e = XMVectorSelect(e, XMVectorAdd(e, one), isAboveSqrt2);
+
+    XMVECTOR s = XMVectorDivide(XMVectorSubtract(m, one), XMVectorAdd(m, one));
+    XMVECTOR twoS = XMVectorAdd(s, s);
+    XMVECTOR lnM;
+
+    if (Accuracy == ACCURACY_Full)
+    {
+        XMVECTOR z = XMVectorMultiply(s, s);
+        XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(2.0f / 9.0f), z, XMVectorReplicate(2.0f / 7.0f));
+        p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(2.0f / 5.0f));
+        p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(2.0f / 3.0f));
+        lnM = XMVectorMultiplyAdd(XMVectorMultiply(p, z), s, twoS);
+    }
+    else
+    {
+        // Also used by Fast, the power error is the logarithm error times the exponent and 2s alone is too coarse
+        XMVECTOR z = XMVectorMultiply(s, s);
+        lnM = XMVectorMultiplyAdd(XMVectorMultiply(XMVectorReplicate(6.771028608025023e-1f), z), s, twoS);
+    }
+
+    // The 2 parts ln(2) keeps e ln(2) exact before adding the small ln(m)
+    return XMVectorMultiplyAdd(e, XMVectorReplicate(Ln2Hi), XMVectorMultiplyAdd(e, XMVectorReplicate(Ln2Lo), lnM));
+}
+
+template<MathAccuracy Accuracy>
+static XMVECTOR XM_CALLCONV Pow4(_In_ FXMVECTOR base, _In_ FXMVECTOR exponent)
+{
+    XMVECTOR pow = Exp4<Accuracy>(XMVectorMultiply(exponent, Log4<Accuracy>(base)));
+
+    return XMVectorSelect(XMVectorZero(), pow, XMVectorGreater(base, XMVectorZero()));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Batch loops, one instantiation per accuracy tier so that the tier tests fold away
+//---------------------------------------------------------------------------------------------------------------------
+template<MathAccuracy Accuracy>
+static void SinCosBatch(_In_ const real* pX, _Out_opt_ real* pSin, _Out_opt_ real* pCos, _In_ size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        size_t n = min(count - i, size_t(4));
+        XMVECTOR x = (n == 4 ? XMLoadFloat4((const XMFLOAT4*)(pX + i)) : LoadPartial4(pX + i, n));
+        XMVECTOR s, c;
+
+        SinCos4<Accuracy>(x, &s, &c);
+
+        if (n == 4)
+        {
+            if (pSin) XMStoreFloat4((XMFLOAT4*)(pSin + i), s);
+            if (pCos) XMStoreFloat4((XMFLOAT4*)(pCos + i), c);
+        }
+        else
+        {
+            if (pSin) StorePartial4(pSin + i, s, n);
+            if (pCos) StorePartial4(pCos + i, c, n);
+        }
+    }
+}
+
+template<MathAccuracy Accuracy>
+static void ExpBatch(_In_ const real* pX, _Out_ real* pExp, _In_ size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        size_t n = min(count - i, size_t(4));
+
+        if (n == 4)
+            XMStoreFloat4((XMFLOAT4*)(pExp + i), Exp4<Accuracy>(XMLoadFloat4((const XMFLOAT4*)(pX + i))));
+        else
+            StorePartial4(pExp + i, Exp4<Accuracy>(LoadPartial4(pX + i, n)), n);
+    }
+}
+
+// A null pExponent uses exponent for every element
+template<MathAccuracy Accuracy>
+static void PowBatch(_In_ const real* pBase, _In_opt_ const real* pExponent, _In_ real exponent, _Out_ real* pPow, _In_ size_t count)
+{
+    XMVECTOR y = XMVectorReplicate(exponent);
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        size_t n = min(count - i, size_t(4));
+
+        if (n == 4)
+        {
+            if (pExponent)
+                y = XMLoadFloat4((const XMFLOAT4*)(pExponent + i));
+
+            XMStoreFloat4((XMFLOAT4*)(pPow + i), Pow4<Accuracy>(XMLoadFloat4((const XMFLOAT4*)(pBase + i)), y));
+        }
+        else
+        {
+            if (pExponent)
+                y = LoadPartial4(pExponent + i, n);
+
+            StorePartial4(pPow + i, Pow4<Accuracy>(LoadPartial4(pBase + i, n), y), n);
+        }
+    }
+}
+
+static void SinCosBatch(_In_ const real* pX, _Out_opt_ real* pSin, _Out_opt_ real* pCos, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    switch (accuracy)
+    {
+    case ACCURACY_Full: SinCosBatch<ACCURACY_Full>(pX, pSin, pCos, count); break;
+    case ACCURACY_Medium: SinCosBatch<ACCURACY_Medium>(pX, pSin, pCos, count); break;
+    default: SinCosBatch<ACCURACY_Fast>(pX, pSin, pCos, count); break;
+    }
+}
+
+static void ExpBatch(_In_ const real* pX, _Out_ real* pExp, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    switch (accuracy)
+    {
+    case ACCURACY_Full: ExpBatch<ACCURACY_Full>(pX, pExp, count); break;
+    case ACCURACY_Medium: ExpBatch<ACCURACY_Medium>(pX, pExp, count); break;
+    default: ExpBatch<ACCURACY_Fast>(pX, pExp, count); break;
+    }
+}
+
+static void PowBatch(_In_ const real* pBase, _In_opt_ const real* pExponent, _In_ real exponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    switch (accuracy)
+    {
+    case ACCURACY_Full: PowBatch<ACCURACY_Full>(pBase, pExponent, exponent, pPow, count); break;
+    case ACCURACY_Medium: PowBatch<ACCURACY_Medium>(pBase, pExponent, exponent, pPow, count); break;
+    default: PowBatch<ACCURACY_Fast>(pBase, pExponent, exponent, pPow, count); break;
+    }
+}
+#else
+//---------------------------------------------------------------------------------------------------------------------
+// Scalar flavor, plain loops over the C library functions. They are at least as accurate as the Full tier so the
+// accuracy is ignored, the exponent clamping and the power domain match the SIMD flavors.
+//---------------------------------------------------------------------------------------------------------------------
+static void SinCosBatch(_In_ const real* pX, _Out_opt_ real* pSin, _Out_opt_ real* pCos, _In_ size_t count, _In_ MathAccuracy /*accuracy*/)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pSin) pSin[i] = real_sin(pX[i]);
+        if (pCos) pCos[i] = real_cos(pX[i]);
+    }
+}
+
+static void ExpBatch(_In_ const real* pX, _Out_ real* pExp, _In_ size_t count, _In_ MathAccuracy /*accuracy*/)
+{
+    for (size_t i = 0; i < count; ++i)
+        pExp[i] = real_exp(min(max(pX[i], ExpMin), ExpMax));
+}
+
+// A null pExponent uses exponent for every element
+static void PowBatch(_In_ const real* pBase, _In_opt_ const real* pExponent, _In_ real exponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy /*accuracy*/)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        real y = pExponent ? pExponent[i] : exponent;
+
+        pPow[i] = pBase[i] > 0.0f ? real_pow(pBase[i], y) : 0.0f;
+    }
+}
+#endif
+
+void Simd::Sin(_In_ const real* pX, _Out_ real* pSin, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    SinCosBatch(pX, pSin, nullptr, count, accuracy);
+}
+
+void Simd::Cos(_In_ const real* pX, _Out_ real* pCos, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    SinCosBatch(pX, nullptr, pCos, count, accuracy);
+}
+
+void Simd::SinCos(_In_ const real* pX, _Out_ real* pSin, _Out_ real* pCos, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    SinCosBatch(pX, pSin, pCos, count, accuracy);
+}
+
+void Simd::Exp(_In_ const real* pX, _Out_ real* pExp, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    ExpBatch(pX, pExp, count, accuracy);
+}
+
+void Simd::Pow(_In_ const real* pBase, _In_ const real* pExponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    PowBatch(pBase, pExponent, 0.0f, pPow, count, accuracy);
+}
+
+void Simd::Pow(_In_ const real* pBase, _In_ real exponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy accuracy)
+{
+    PowBatch(pBase, nullptr, exponent, pPow, count, accuracy);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "engiXDefs.h"
+#include "Simd.h"
+
+//
+// SIMD batch transcendental functions
+//
+// Batch versions of real_sin, real_cos, real_exp and real_pow for SoA arrays, evaluated 4 lanes at a time with
+// DirectXMath on the SSE and AVX flavors and one element at a time with the C library functions on the scalar
+// flavor. The arrays need no alignment or padding, a last partial group of 4 is handled separately. Each function
+// comes in 3 accuracy tiers, the errors are relative for exponent and power and absolute for sine and cosine:
+//  - Full: about 1e-7, as good as the C library single precision functions for sine and cosine on |x| < 8192
+//  - Medium: about 2e-5
+//  - Fast: about 3e-3
+// Power adds the logarithm error times |y| on top, about 1e-8 |y| for Full and 1e-5 |y| for Medium and Fast.
+// The default tier is REAL_BATCH_ACCURACY, see Precision.h. Exponent inputs are clamped to [-87, 88] to stay in the
+// normal single precision range and power bases must be positive, 0 or negative bases give 0.
+//
+namespace engiX
+{
+    namespace Simd
+    {
+        enum MathAccuracy
+        {
+            ACCURACY_Full,
+            ACCURACY_Medium,
+            ACCURACY_Fast
+        };
+
+        void Sin(_In_ const real* pX, _Out_ real* pSin, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+        void Cos(_In_ const real* pX, _Out_ real* pCos, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+        void SinCos(_In_ const real* pX, _Out_ real* pSin, _Out_ real* pCos, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+        void Exp(_In_ const real* pX, _Out_ real* pExp, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+        // pPow[i] = pBase[i] ^ pExponent[i]
+        void Pow(_In_ const real* pBase, _In_ const real* pExponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+        // pPow[i] = pBase[i] ^ exponent, e.g damping ^ dt
+        void Pow(_In_ const real* pBase, _In_ real exponent, _Out_ real* pPow, _In_ size_t count, _In_ MathAccuracy accuracy = REAL_BATCH_ACCURACY);
+    }
+}
@@ -1,15 +1,44 @@
-#include <windows.h>
 #include "Timer.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <chrono>
+#endif
 
 using namespace engiX;
 
+#if defined(_WIN32)
+static int64_t CountsPerSecond()
+{
+	int64_t countsPerSec;
+	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
+	return countsPerSec;
+}
+
+static int64_t QueryCounter()
+{
+	int64_t count;
+	QueryPerformanceCounter((LARGE_INTEGER*)&count);
+	return count;
+}
+#else
+// Other platforms count the steady clock ticks
+static int64_t CountsPerSecond()
+{
+	return (int64_t)std::chrono::steady_clock::period::den / (int64_t)std::chrono::steady_clock::period::num;
+}
+
+static int64_t QueryCounter()
+{
+	return (int64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+#endif
+
 Timer::Timer()
 : mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
   mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0f / (real)countsPerSec;
+	mSecondsPerCount = 1.0f / (real)CountsPerSecond();
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -53,8 +82,7 @@ real Timer::DeltaTime()const
 
 void Timer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	int64_t currTime = QueryCounter();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
@@ -64,8 +92,7 @@ void Timer::Reset()
 
 void Timer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	int64_t startTime = QueryCounter();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -88,8 +115,7 @@ void Timer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+		int64_t currTime = QueryCounter();
 
 		mStopTime = currTime;
 		mStopped  = true;
@@ -104,8 +130,7 @@ void Timer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	int64_t currTime = QueryCounter();
 	mCurrTime = currTime;
 
 	// Time difference between this frame and the previous.
@@ -123,3 +148,22 @@ void Timer::Tick()
 	}
 }
 
+StopWatch::StopWatch()
+: mSecondsPerCount(0.0), mElapsedTime(0.0), mStartTime(0)
+{
+	mSecondsPerCount = 1.0f / (real)CountsPerSecond();
+}
+
+void StopWatch::Start()
+{
+	mStartTime = QueryCounter();
+}
+
+real StopWatch::Stop()
+{
+	int64_t currTime = QueryCounter();
+
+	mElapsedTime = (currTime - mStartTime)*mSecondsPerCount;
+
+	return mElapsedTime;
+}
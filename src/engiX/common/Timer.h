@@ -4,6 +4,7 @@
 
 #pragma  once
 
+#include <cstdint>
 #include "Precision.h"
 
 namespace engiX
@@ -25,12 +26,28 @@ namespace engiX
         real mSecondsPerCount;
         real mDeltaTime;
 
-        __int64 mBaseTime;
-        __int64 mPausedTime;
-        __int64 mStopTime;
-        __int64 mPrevTime;
-        __int64 mCurrTime;
+        int64_t mBaseTime;
+        int64_t mPausedTime;
+        int64_t mStopTime;
+        int64_t mPrevTime;
+        int64_t mCurrTime;
 
         bool mStopped;
     };
+
+    // High resolution stop watch used to profile engine systems
+    class StopWatch
+    {
+    public:
+        StopWatch();
+
+        void Start();
+        real Stop(); // Returns the elapsed seconds since the last Start
+        real ElapsedTime() const { return mElapsedTime; } // in seconds
+
+    private:
+        real mSecondsPerCount;
+        real mElapsedTime;
+        int64_t mStartTime;
+    };
 }
\ No newline at end of file
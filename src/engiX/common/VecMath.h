@@ -0,0 +1,489 @@
+#pragma once
+
+#include <cmath>
+#include "Precision.h"
+
+//
+// Portable vector math
+//
+// Vec2, Vec3, Vec4 and Mat4x4 storage types and the 4 lanes VecMath::Vector / VecMath::Matrix operations the logic
+// and physics code runs on. Windows builds keep the DirectXMath storage types so the view and the D3D code can use
+// them as is; other platforms, or defining ENGIX_NO_DIRECTXMATH, get layout compatible engiX structs with the same
+// member names.
+//
+// The operations backend is selected at compile time:
+//  - SSE: x86/x64, the default there. Dot products use SSE4.1 when the compiler targets it (/arch:AVX,
+//    -msse4.1) and the multiply adds are fused when it targets FMA (-mfma)
+//  - AVX2: the SSE backend with fused multiply adds and 8 lanes matrix products, 2 rows per instruction, selected
+//    when the compiler targets AVX2 (/arch:AVX2, -mavx2 -mfma)
+//  - NEON: ARM and ARM64
+//  - Scalar: plain C++, forced by defining ENGIX_VECMATH_SCALAR
+//
+#if !defined(ENGIX_VECMATH_SCALAR) && !defined(ENGIX_VECMATH_SSE) && !defined(ENGIX_VECMATH_NEON)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+#define ENGIX_VECMATH_NEON
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ENGIX_VECMATH_SSE
+#else
+#define ENGIX_VECMATH_SCALAR
+#endif
+#endif
+
+#if defined(ENGIX_VECMATH_SSE)
+#include <emmintrin.h>
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define ENGIX_VECMATH_SSE4
+#include <smmintrin.h>
+#endif
+// MSVC /arch:AVX2 also enables FMA, GCC and Clang need -mfma along with -mavx2
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ENGIX_VECMATH_FMA
+#include <immintrin.h>
+#endif
+#if defined(ENGIX_VECMATH_FMA) && defined(__AVX2__)
+#define ENGIX_VECMATH_AVX2
+#endif
+#elif defined(ENGIX_VECMATH_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_WIN32) && !defined(ENGIX_NO_DIRECTXMATH)
+#define ENGIX_DIRECTXMATH
+#include <DirectXMath.h>
+
+typedef DirectX::XMFLOAT4X4 Mat4x4;
+typedef DirectX::XMFLOAT3 Vec3;
+typedef DirectX::XMFLOAT4 Vec4;
+typedef DirectX::XMFLOAT2 Vec2;
+typedef DirectX::XMFLOAT3 Color3;
+#else
+namespace engiX
+{
+    struct Float2
+    {
+        float x;
+        float y;
+
+        Float2() {}
+        Float2(float _x, float _y) : x(_x), y(_y) {}
+        explicit Float2(const float* pArray) : x(pArray[0]), y(pArray[1]) {}
+    };
+
+    struct Float3
+    {
+        float x;
+        float y;
+        float z;
+
+        Float3() {}
+        Float3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+        explicit Float3(const float* pArray) : x(pArray[0]), y(pArray[1]), z(pArray[2]) {}
+    };
+
+    struct Float4
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+
+        Float4() {}
+        Float4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+        explicit Float4(const float* pArray) : x(pArray[0]), y(pArray[1]), z(pArray[2]), w(pArray[3]) {}
+    };
+
+    struct Float4x4
+    {
+        union
+        {
+            struct
+            {
+                float _11, _12, _13, _14;
+                float _21, _22, _23, _24;
+                float _31, _32, _33, _34;
+                float _41, _42, _43, _44;
+            };
+            float m[4][4];
+        };
+
+        Float4x4() {}
+        Float4x4(float m00, float m01, float m02, float m03,
+            float m10, float m11, float m12, float m13,
+            float m20, float m21, float m22, float m23,
+            float m30, float m31, float m32, float m33) :
+            _11(m00), _12(m01), _13(m02), _14(m03),
+            _21(m10), _22(m11), _23(m12), _24(m13),
+            _31(m20), _32(m21), _33(m22), _34(m23),
+            _41(m30), _42(m31), _43(m32), _44(m33)
+        {}
+    };
+}
+
+typedef engiX::Float4x4 Mat4x4;
+typedef engiX::Float3 Vec3;
+typedef engiX::Float4 Vec4;
+typedef engiX::Float2 Vec2;
+typedef engiX::Float3 Color3;
+#endif
+
+namespace engiX
+{
+    namespace VecMath
+    {
+#if defined(ENGIX_VECMATH_SSE)
+        typedef __m128 Vector;
+        const char* const BackendName =
+#if defined(ENGIX_VECMATH_AVX2)
+            "AVX2+FMA";
+#elif defined(ENGIX_VECMATH_FMA)
+            "SSE4.1+FMA";
+#elif defined(ENGIX_VECMATH_SSE4)
+            "SSE4.1";
+#else
+            "SSE2";
+#endif
+#elif defined(ENGIX_VECMATH_NEON)
+        typedef float32x4_t Vector;
+        const char* const BackendName = "NEON";
+#else
+        struct Vector { float v[4]; };
+        const char* const BackendName = "Scalar";
+#endif
+
+        // Row vector convention like DirectXMath, points transform as p * M and the translation is the last row
+        struct Matrix { Vector r[4]; };
+
+        //
+        // Backend primitives
+        //
+#if defined(ENGIX_VECMATH_SSE)
+        inline Vector Set(float x, float y, float z, float w) { return _mm_set_ps(w, z, y, x); }
+        inline Vector Replicate(float s) { return _mm_set1_ps(s); }
+        inline Vector Zero() { return _mm_setzero_ps(); }
+        inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+        inline Vector Subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+        inline Vector Multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+        inline Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+        inline Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+        inline Vector Sqrt(Vector a) { return _mm_sqrt_ps(a); }
+        inline float GetX(Vector a) { return _mm_cvtss_f32(a); }
+        inline float GetY(Vector a) { return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))); }
+        inline float GetZ(Vector a) { return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2))); }
+        inline float GetW(Vector a) { return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3))); }
+        inline Vector SplatX(Vector a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)); }
+        inline Vector SplatY(Vector a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)); }
+        inline Vector SplatZ(Vector a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)); }
+        inline Vector SplatW(Vector a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)); }
+        // (y, z, x, w)
+        inline Vector SwizzleYZX(Vector a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)); }
+
+        // a * b + c
+        inline Vector MultiplyAdd(Vector a, Vector b, Vector c)
+        {
+#if defined(ENGIX_VECMATH_FMA)
+            return _mm_fmadd_ps(a, b, c);
+#else
+            return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+        }
+
+        // c - a * b
+        inline Vector NegativeMultiplySubtract(Vector a, Vector b, Vector c)
+        {
+#if defined(ENGIX_VECMATH_FMA)
+            return _mm_fnmadd_ps(a, b, c);
+#else
+            return _mm_sub_ps(c, _mm_mul_ps(a, b));
+#endif
+        }
+
+        // x, y and z lanes dot product replicated in all the lanes
+        inline Vector Dot3(Vector a, Vector b)
+        {
+#if defined(ENGIX_VECMATH_SSE4)
+            return _mm_dp_ps(a, b, 0x7F);
+#else
+            Vector p = _mm_mul_ps(a, b);
+            Vector sum = _mm_add_ss(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)));
+            return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+#endif
+        }
+
+        inline Vector Dot4(Vector a, Vector b)
+        {
+#if defined(ENGIX_VECMATH_SSE4)
+            return _mm_dp_ps(a, b, 0xFF);
+#else
+            Vector p = _mm_mul_ps(a, b);
+            Vector sum = _mm_add_ps(p, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+#endif
+        }
+#elif defined(ENGIX_VECMATH_NEON)
+        inline Vector Set(float x, float y, float z, float w) { float v[4] = { x, y, z, w }; return vld1q_f32(v); }
+        inline Vector Replicate(float s) { return vdupq_n_f32(s); }
+        inline Vector Zero() { return vdupq_n_f32(0.0f); }
+        inline Vector Add(Vector a, Vector b) { return vaddq_f32(a, b); }
+        inline Vector Subtract(Vector a, Vector b) { return vsubq_f32(a, b); }
+        inline Vector Multiply(Vector a, Vector b) { return vmulq_f32(a, b); }
+        inline Vector Min(Vector a, Vector b) { return vminq_f32(a, b); }
+        inline Vector Max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+        inline float GetX(Vector a) { return vgetq_lane_f32(a, 0); }
+        inline float GetY(Vector a) { return vgetq_lane_f32(a, 1); }
+        inline float GetZ(Vector a) { return vgetq_lane_f32(a, 2); }
+        inline float GetW(Vector a) { return vgetq_lane_f32(a, 3); }
+        inline Vector SplatX(Vector a) { return vdupq_lane_f32(vget_low_f32(a), 0); }
+        inline Vector SplatY(Vector a) { return vdupq_lane_f32(vget_low_f32(a), 1); }
+        inline Vector SplatZ(Vector a) { return vdupq_lane_f32(vget_high_f32(a), 0); }
+        inline Vector SplatW(Vector a) { return vdupq_lane_f32(vget_high_f32(a), 1); }
+        inline Vector SwizzleYZX(Vector a) { return Set(GetY(a), GetZ(a), GetX(a), GetW(a)); }
+        inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return vmlaq_f32(c, a, b); }
+        inline Vector NegativeMultiplySubtract(Vector a, Vector b, Vector c) { return vmlsq_f32(c, a, b); }
+
+        inline Vector Sqrt(Vector a)
+        {
+#if defined(__aarch64__) || defined(_M_ARM64)
+            return vsqrtq_f32(a);
+#else
+            return Set(sqrtf(GetX(a)), sqrtf(GetY(a)), sqrtf(GetZ(a)), sqrtf(GetW(a)));
+#endif
+        }
+
+        inline Vector Dot3(Vector a, Vector b)
+        {
+            Vector p = vmulq_f32(a, b);
+            float32x2_t xy = vpadd_f32(vget_low_f32(p), vget_low_f32(p));
+            float32x2_t xyz = vadd_f32(xy, vdup_lane_f32(vget_high_f32(p), 0));
+            return vcombine_f32(xyz, xyz);
+        }
+
+        inline Vector Dot4(Vector a, Vector b)
+        {
+            Vector p = vmulq_f32(a, b);
+            float32x2_t sum = vadd_f32(vget_low_f32(p), vget_high_f32(p));
+            sum = vpadd_f32(sum, sum);
+            return vcombine_f32(sum, sum);
+        }
+#else
+        inline Vector Set(float x, float y, float z, float w) { Vector r = { { x, y, z, w } }; return r; }
+        inline Vector Replicate(float s) { return Set(s, s, s, s); }
+        inline Vector Zero() { return Set(0.0f, 0.0f, 0.0f, 0.0f); }
+        inline Vector Add(Vector a, Vector b) { return Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]); }
+        inline Vector Subtract(Vector a, Vector b) { return Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]); }
+        inline Vector Multiply(Vector a, Vector b) { return Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]); }
+        inline Vector Min(Vector a, Vector b) { return Set(fminf(a.v[0], b.v[0]), fminf(a.v[1], b.v[1]), fminf(a.v[2], b.v[2]), fminf(a.v[3], b.v[3])); }
+        inline Vector Max(Vector a, Vector b) { return Set(fmaxf(a.v[0], b.v[0]), fmaxf(a.v[1], b.v[1]), fmaxf(a.v[2], b.v[2]), fmaxf(a.v[3], b.v[3])); }
+        inline Vector Sqrt(Vector a) { return Set(sqrtf(a.v[0]), sqrtf(a.v[1]), sqrtf(a.v[2]), sqrtf(a.v[3])); }
+        inline float GetX(Vector a) { return a.v[0]; }
+        inline float GetY(Vector a) { return a.v[1]; }
+        inline float GetZ(Vector a) { return a.v[2]; }
+        inline float GetW(Vector a) { return a.v[3]; }
+        inline Vector SplatX(Vector a) { return Replicate(a.v[0]); }
+        inline Vector SplatY(Vector a) { return Replicate(a.v[1]); }
+        inline Vector SplatZ(Vector a) { return Replicate(a.v[2]); }
+        inline Vector SplatW(Vector a) { return Replicate(a.v[3]); }
+        inline Vector SwizzleYZX(Vector a) { return Set(a.v[1], a.v[2], a.v[0], a.v[3]); }
+        inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return Add(Multiply(a, b), c); }
+        inline Vector NegativeMultiplySubtract(Vector a, Vector b, Vector c) { return Subtract(c, Multiply(a, b)); }
+        inline Vector Dot3(Vector a, Vector b) { return Replicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]); }
+        inline Vector Dot4(Vector a, Vector b) { return Replicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]); }
+#endif
+
+        //
+        // Loads and stores, the w lane of a 3 component load is 0
+        //
+        inline Vector Load3(const Vec3& v) { return Set(v.x, v.y, v.z, 0.0f); }
+        inline Vector Load4(const Vec4& v) { return Set(v.x, v.y, v.z, v.w); }
+        inline void Store3(Vec3& dst, Vector v) { dst.x = GetX(v); dst.y = GetY(v); dst.z = GetZ(v); }
+        inline void Store4(Vec4& dst, Vector v) { dst.x = GetX(v); dst.y = GetY(v); dst.z = GetZ(v); dst.w = GetW(v); }
+        inline Vec3 ToVec3(Vector v) { return Vec3(GetX(v), GetY(v), GetZ(v)); }
+        inline Vec4 ToVec4(Vector v) { return Vec4(GetX(v), GetY(v), GetZ(v), GetW(v)); }
+
+        inline Matrix LoadMatrix(const Mat4x4& m)
+        {
+            Matrix r;
+            r.r[0] = Set(m._11, m._12, m._13, m._14);
+            r.r[1] = Set(m._21, m._22, m._23, m._24);
+            r.r[2] = Set(m._31, m._32, m._33, m._34);
+            r.r[3] = Set(m._41, m._42, m._43, m._44);
+            return r;
+        }
+
+        inline void StoreMatrix(Mat4x4& dst, const Matrix& m)
+        {
+            dst._11 = GetX(m.r[0]); dst._12 = GetY(m.r[0]); dst._13 = GetZ(m.r[0]); dst._14 = GetW(m.r[0]);
+            dst._21 = GetX(m.r[1]); dst._22 = GetY(m.r[1]); dst._23 = GetZ(m.r[1]); dst._24 = GetW(m.r[1]);
+            dst._31 = GetX(m.r[2]); dst._32 = GetY(m.r[2]); dst._33 = GetZ(m.r[2]); dst._34 = GetW(m.r[2]);
+            dst._41 = GetX(m.r[3]); dst._42 = GetY(m.r[3]); dst._43 = GetZ(m.r[3]); dst._44 = GetW(m.r[3]);
+        }
+
+        //
+        // Vector operations built on the primitives
+        //
+        inline Vector Scale(Vector v, float s) { return Multiply(v, Replicate(s)); }
+        inline Vector Negate(Vector v) { return Subtract(Zero(), v); }
+
+        // a + (b - a) * t
+        inline Vector Lerp(Vector a, Vector b, float t) { return MultiplyAdd(Subtract(b, a), Replicate(t), a); }
+
+        inline Vector Cross3(Vector a, Vector b)
+        {
+            // a.yzx * b.zxy - a.zxy * b.yzx, computed as (a * b.yzx - a.yzx * b).yzx
+            Vector c = NegativeMultiplySubtract(SwizzleYZX(a), b, Multiply(a, SwizzleYZX(b)));
+            return SwizzleYZX(c);
+        }
+
+        inline float LengthSq3(Vector v) { return GetX(Dot3(v, v)); }
+        inline float Length3(Vector v) { return GetX(Sqrt(Dot3(v, v))); }
+
+        // Zero length vectors normalize to zero
+        inline Vector Normalize3(Vector v)
+        {
+            float lengthSq = LengthSq3(v);
+            return (lengthSq > 0.0f ? Scale(v, 1.0f / sqrtf(lengthSq)) : Zero());
+        }
+
+        //
+        // Matrix operations
+        //
+        inline Matrix MatrixIdentity()
+        {
+            Matrix m;
+            m.r[0] = Set(1.0f, 0.0f, 0.0f, 0.0f);
+            m.r[1] = Set(0.0f, 1.0f, 0.0f, 0.0f);
+            m.r[2] = Set(0.0f, 0.0f, 1.0f, 0.0f);
+            m.r[3] = Set(0.0f, 0.0f, 0.0f, 1.0f);
+            return m;
+        }
+
+        // v.x * r0 + v.y * r1 + v.z * r2 + v.w * r3
+        inline Vector Transform4(Vector v, const Matrix& m)
+        {
+            Vector r = Multiply(SplatX(v), m.r[0]);
+            r = MultiplyAdd(SplatY(v), m.r[1], r);
+            r = MultiplyAdd(SplatZ(v), m.r[2], r);
+            return MultiplyAdd(SplatW(v), m.r[3], r);
+        }
+
+        // Point with an implicit w of 1, no perspective divide
+        inline Vector TransformPoint3(Vector v, const Matrix& m)
+        {
+            Vector r = MultiplyAdd(SplatX(v), m.r[0], m.r[3]);
+            r = MultiplyAdd(SplatY(v), m.r[1], r);
+            return MultiplyAdd(SplatZ(v), m.r[2], r);
+        }
+
+        // Direction, the translation is ignored
+        inline Vector TransformNormal3(Vector v, const Matrix& m)
+        {
+            Vector r = Multiply(SplatX(v), m.r[0]);
+            r = MultiplyAdd(SplatY(v), m.r[1], r);
+            return MultiplyAdd(SplatZ(v), m.r[2], r);
+        }
+
+#if defined(ENGIX_VECMATH_AVX2)
+        // Transform4 of the 2 rows held in the 128 bits halves of v2, b0..b3 hold a row of the matrix in both halves
+        inline __m256 Transform4x2(__m256 v2, __m256 b0, __m256 b1, __m256 b2, __m256 b3)
+        {
+            __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+            r = _mm256_fmadd_ps(_mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(1, 1, 1, 1)), b1, r);
+            r = _mm256_fmadd_ps(_mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(2, 2, 2, 2)), b2, r);
+            return _mm256_fmadd_ps(_mm256_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 3, 3)), b3, r);
+        }
+#endif
+
+        // a then b
+        inline Matrix MatrixMultiply(const Matrix& a, const Matrix& b)
+        {
+            Matrix m;
+#if defined(ENGIX_VECMATH_AVX2)
+            __m256 b0 = _mm256_broadcast_ps(&b.r[0]);
+            __m256 b1 = _mm256_broadcast_ps(&b.r[1]);
+            __m256 b2 = _mm256_broadcast_ps(&b.r[2]);
+            __m256 b3 = _mm256_broadcast_ps(&b.r[3]);
+            __m256 r01 = Transform4x2(_mm256_insertf128_ps(_mm256_castps128_ps256(a.r[0]), a.r[1], 1), b0, b1, b2, b3);
+            __m256 r23 = Transform4x2(_mm256_insertf128_ps(_mm256_castps128_ps256(a.r[2]), a.r[3], 1), b0, b1, b2, b3);
+
+            m.r[0] = _mm256_castps256_ps128(r01);
+            m.r[1] = _mm256_extractf128_ps(r01, 1);
+            m.r[2] = _mm256_castps256_ps128(r23);
+            m.r[3] = _mm256_extractf128_ps(r23, 1);
+#else
+            m.r[0] = Transform4(a.r[0], b);
+            m.r[1] = Transform4(a.r[1], b);
+            m.r[2] = Transform4(a.r[2], b);
+            m.r[3] = Transform4(a.r[3], b);
+#endif
+            return m;
+        }
+
+        inline Matrix MatrixTranspose(const Matrix& m)
+        {
+#if defined(ENGIX_VECMATH_SSE)
+            Matrix t = m;
+            _MM_TRANSPOSE4_PS(t.r[0], t.r[1], t.r[2], t.r[3]);
+            return t;
+#else
+            Matrix t;
+            t.r[0] = Set(GetX(m.r[0]), GetX(m.r[1]), GetX(m.r[2]), GetX(m.r[3]));
+            t.r[1] = Set(GetY(m.r[0]), GetY(m.r[1]), GetY(m.r[2]), GetY(m.r[3]));
+            t.r[2] = Set(GetZ(m.r[0]), GetZ(m.r[1]), GetZ(m.r[2]), GetZ(m.r[3]));
+            t.r[3] = Set(GetW(m.r[0]), GetW(m.r[1]), GetW(m.r[2]), GetW(m.r[3]));
+            return t;
+#endif
+        }
+
+        //
+        // Quaternions, (x, y, z) is the vector part and w the scalar part
+        //
+
+        // Rotation about X (pitch), Y (yaw) and Z (roll) applied Z first, then X, then Y
+        inline Vector QuaternionRotationRollPitchYaw(float pitch, float yaw, float roll)
+        {
+            float sp = sinf(0.5f * pitch), cp = cosf(0.5f * pitch);
+            float sy = sinf(0.5f * yaw), cy = cosf(0.5f * yaw);
+            float sr = sinf(0.5f * roll), cr = cosf(0.5f * roll);
+
+            return Set(
+                sp * cy * cr + cp * sy * sr,
+                cp * sy * cr - sp * cy * sr,
+                cp * cy * sr - sp * sy * cr,
+                cp * cy * cr + sp * sy * sr);
+        }
+
+        inline Vector QuaternionConjugate(Vector q) { return Multiply(q, Set(-1.0f, -1.0f, -1.0f, 1.0f)); }
+
+        // Rotation by q1 then q2, the Hamilton product q2 * q1
+        inline Vector QuaternionMultiply(Vector q1, Vector q2)
+        {
+            float x1 = GetX(q1), y1 = GetY(q1), z1 = GetZ(q1), w1 = GetW(q1);
+            float x2 = GetX(q2), y2 = GetY(q2), z2 = GetZ(q2), w2 = GetW(q2);
+
+            return Set(
+                w2 * x1 + x2 * w1 + y2 * z1 - z2 * y1,
+                w2 * y1 - x2 * z1 + y2 * w1 + z2 * x1,
+                w2 * z1 + x2 * y1 - y2 * x1 + z2 * w1,
+                w2 * w1 - x2 * x1 - y2 * y1 - z2 * z1);
+        }
+
+        // v + 2w (q x v) + 2 q x (q x v), with q the unit quaternion vector part
+        inline Vector Rotate3(Vector v, Vector q)
+        {
+            Vector t = Scale(Cross3(q, v), 2.0f);
+            return Add(MultiplyAdd(SplatW(q), t, v), Cross3(q, t));
+        }
+
+        inline Matrix MatrixRotationQuaternion(Vector q)
+        {
+            float x = GetX(q), y = GetY(q), z = GetZ(q), w = GetW(q);
+
+            Matrix m;
+            m.r[0] = Set(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f);
+            m.r[1] = Set(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f);
+            m.r[2] = Set(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f);
+            m.r[3] = Set(0.0f, 0.0f, 0.0f, 1.0f);
+            return m;
+        }
+    }
+}
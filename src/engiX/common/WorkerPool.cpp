@@ -0,0 +1,129 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+using namespace engiX;
+using namespace std;
+
+// Chunks per thread, more chunks than threads balance uneven chunks at the cost of more synchronization
+static const size_t ChunksPerThread = 4;
+
+unsigned WorkerPool::DefaultThreadCount()
+{
+    unsigned hardwareThreads = thread::hardware_concurrency();
+
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+WorkerPool::WorkerPool(_In_ unsigned threadCount) :
+    m_generation(0),
+    m_busyWorkerCount(0),
+    m_quit(false),
+    m_pJob(nullptr),
+    m_count(0),
+    m_chunkSize(0),
+    m_chunkCount(0)
+{
+    m_nextChunk = 0;
+    m_doneChunkCount = 0;
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_threads.push_back(thread(&WorkerPool::WorkerMain, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_wakeCv.notify_all();
+
+    for (auto& worker : m_threads)
+        worker.join();
+}
+
+void WorkerPool::ParallelFor(_In_ size_t count, _In_ size_t minChunkSize, _In_ const RangeJob& job)
+{
+    if (count == 0)
+        return;
+
+    size_t maxChunkCount = (m_threads.size() + 1) * ChunksPerThread;
+    size_t chunkCount = min((count + minChunkSize - 1) / max(minChunkSize, size_t(1)), maxChunkCount);
+
+    if (m_threads.empty() || chunkCount <= 1)
+    {
+        job(0, count);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_pJob = &job;
+        m_count = count;
+        m_chunkSize = (count + chunkCount - 1) / chunkCount;
+        m_chunkCount = (count + m_chunkSize - 1) / m_chunkSize;
+        m_doneChunkCount = 0;
+        m_nextChunk = 0;
+        ++m_generation;
+    }
+
+    m_wakeCv.notify_all();
+
+    RunChunks();
+
+    // Waiting for the workers to leave RunChunks too keeps the next job setup from racing with them
+    unique_lock<mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this]() { return m_doneChunkCount == m_chunkCount && m_busyWorkerCount == 0; });
+}
+
+void WorkerPool::WorkerMain()
+{
+    unique_lock<mutex> lock(m_mutex);
+    unsigned seenGeneration = m_generation;
+
+    for (;;)
+    {
+        m_wakeCv.wait(lock, [&]() { return m_quit || m_generation != seenGeneration; });
+
+        if (m_quit)
+            return;
+
+        seenGeneration = m_generation;
+
+        // Woke up too late, the job is already done
+        if (m_nextChunk >= m_chunkCount)
+            continue;
+
+        ++m_busyWorkerCount;
+
+        lock.unlock();
+        RunChunks();
+        lock.lock();
+
+        if (--m_busyWorkerCount == 0)
+            m_doneCv.notify_all();
+    }
+}
+
+void WorkerPool::RunChunks()
+{
+    for (;;)
+    {
+        size_t chunk = m_nextChunk++;
+
+        if (chunk >= m_chunkCount)
+            return;
+
+        size_t begin = chunk * m_chunkSize;
+        size_t end = min(begin + m_chunkSize, m_count);
+
+        (*m_pJob)(begin, end);
+
+        if (++m_doneChunkCount == m_chunkCount)
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_doneCv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "engiXDefs.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // WorkerPool class
+    //
+    // Fixed set of worker threads for data parallel loops. ParallelFor splits an index range in chunks which are
+    // picked by the workers and the calling thread until all are done, then returns. Chunk boundaries only depend on
+    // the range, the minimum chunk size and the thread count.
+    //
+    // A pool with 0 threads runs everything on the calling thread. ParallelFor is not reentrant and must only be
+    // called from one thread at a time.
+    //---------------------------------------------------------------------------------------------------------------------
+    class WorkerPool
+    {
+    public:
+        typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+        // One worker per hardware thread besides the calling thread
+        static unsigned DefaultThreadCount();
+
+        WorkerPool(_In_ unsigned threadCount = DefaultThreadCount());
+        ~WorkerPool();
+
+        void ParallelFor(_In_ size_t count, _In_ size_t minChunkSize, _In_ const RangeJob& job);
+        unsigned ThreadCount() const { return (unsigned)m_threads.size(); }
+
+    protected:
+        void WorkerMain();
+        void RunChunks();
+
+    private:
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCv;
+        std::condition_variable m_doneCv;
+        unsigned m_generation;
+        unsigned m_busyWorkerCount;
+        bool m_quit;
+
+        // Current job, only written under the mutex while no worker is running chunks
+        const RangeJob* m_pJob;
+        size_t m_count;
+        size_t m_chunkSize;
+        size_t m_chunkCount;
+        std::atomic<size_t> m_nextChunk;
+        std::atomic<size_t> m_doneChunkCount;
+    };
+}
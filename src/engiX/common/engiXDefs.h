@@ -2,9 +2,48 @@
 
 #include "Precision.h"
 #include "Logger.h"
+#include "VecMath.h"
 
-#include <DirectXMath.h>
+#if defined(_WIN32)
 #include <dxerr.h>
+#else
+#include <cassert>
+#include <cstddef>
+#include <cwchar>
+
+#ifndef _ASSERTE
+#define _ASSERTE(expr) assert(expr)
+#endif
+
+// SAL annotations come with the Windows SDK headers, they only document the parameters elsewhere
+#ifndef _In_
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#endif
+
+// The few Win32 types the engine interfaces are declared with
+typedef long HRESULT;
+typedef unsigned int UINT;
+typedef size_t WPARAM;
+typedef ptrdiff_t LPARAM;
+
+#ifndef S_OK
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#endif
+
+#define _wcsicmp wcscasecmp
+#endif
+
+// L"x" for the x token sequence, MSVC also accepts L#x but other compilers do not
+#define WIDEN_(s) L ## s
+#define WIDEN(s) WIDEN_(s)
+#define WSTRINGIFY(x) WIDEN(#x)
 
 #ifndef CHR
 #define CHR(x)                                               \
@@ -12,7 +51,7 @@
     hr = (x);                                       \
     if(FAILED(hr))                                          \
     {                                                       \
-    LogError("'%s' failed, hr=%x", L#x, hr);                \
+    LogError("'%s' failed, hr=%x", WSTRINGIFY(x), hr);                \
     }                                                       \
     }
 #else
@@ -25,7 +64,7 @@
     HRESULT hr = (x);                                       \
     if(FAILED(hr))                                          \
     {                                                       \
-    LogError("'%s' failed, hr=%x", L#x, hr);                \
+    LogError("'%s' failed, hr=%x", WSTRINGIFY(x), hr);                \
     return;                                        \
     }                                                       \
     }
@@ -39,7 +78,7 @@
     HRESULT hr = (x);                                       \
     if(FAILED(hr))                                          \
     {                                                       \
-    LogError("'%s' failed, hr=%x", L#x, hr);                \
+    LogError("'%s' failed, hr=%x", WSTRINGIFY(x), hr);                \
     return hr;                                        \
     }                                                       \
     }
@@ -53,8 +92,8 @@
     HRESULT hr = (x);                                       \
     if(FAILED(hr))                                          \
     {                                                       \
-	LogError("'%s' failed, hr=%x, error=%d, %s", L#x, hr, HRESULT_CODE(hr), DXGetErrorString(hr));                \
-	DXTRACE_ERR_MSGBOX(L#x, hr); \
+	LogError("'%s' failed, hr=%x, error=%d, %s", WSTRINGIFY(x), hr, HRESULT_CODE(hr), DXGetErrorString(hr));                \
+	DXTRACE_ERR_MSGBOX(WSTRINGIFY(x), hr); \
     return (SUCCEEDED(hr) ? true : false);                                        \
     }                                                       \
     }
@@ -67,7 +106,7 @@
     {                                                       \
     if(!(x))                                         \
     {                                                       \
-    LogError("'%s' failed, hr=%x", L#x, hr);                \
+    LogError("'%s' failed, hr=%x", WSTRINGIFY(x), hr);                \
     return hr;                                        \
     }                                                       \
     }
@@ -80,7 +119,7 @@
     {                                                       \
     if(!(x))                                         \
     {                                                       \
-    LogError("'%s' failed", L#x);                \
+    LogError("'%s' failed", WSTRINGIFY(x));                \
     return false;                                        \
     }                                                       \
     }
@@ -93,7 +132,7 @@
     {                                                       \
     if(!(x))                                         \
     {                                                       \
-    LogError("'%s' failed", L#x);                \
+    LogError("'%s' failed", WSTRINGIFY(x));                \
     return;                                        \
     }                                                       \
     }
@@ -113,8 +152,4 @@
 #define SAFE_RELEASE(p)      { if (p) { (p)->Release(); (p)=NULL; } }
 #endif
 
-typedef DirectX::XMFLOAT4X4 Mat4x4;
-typedef DirectX::XMFLOAT3 Vec3;
-typedef DirectX::XMFLOAT4 Vec4;
-typedef DirectX::XMFLOAT2 Vec2;
-typedef DirectX::XMFLOAT3 Color3;
+// Vec2, Vec3, Vec4, Mat4x4 and Color3 are defined in VecMath.h
@@ -0,0 +1,521 @@
+#include "AabbTree.h"
+#include <algorithm>
+
+using namespace engiX;
+using namespace std;
+
+const real AabbTree::DefaultFatMargin = 0.5f;
+
+// Inverse of a ray direction component, a large value stands for the infinite inverse of 0
+// so that the slabs test does not have to deal with infinities
+static real InverseDirection(_In_ real x)
+{
+    if (real_abs(x) > real_epsilon)
+        return 1.0f / x;
+    else
+        return x < 0.0f ? -1e30f : 1e30f;
+}
+
+AabbTree::AabbTree(_In_ real fatMargin) :
+    m_root(NullNode),
+    m_freeList(NullNode),
+    m_proxyCount(0),
+    m_fatMargin(fatMargin)
+{
+}
+
+void AabbTree::Clear()
+{
+    m_nodes.clear();
+    m_root = NullNode;
+    m_freeList = NullNode;
+    m_proxyCount = 0;
+    m_detachedLeaves.clear();
+}
+
+AabbProxy AabbTree::CreateProxy(_In_ const AxisAlignedBox& box, _In_ ActorID actorId, _In_ unsigned userData)
+{
+    unsigned leaf = AllocateNode();
+
+    m_nodes[leaf].TightBox = box;
+    m_nodes[leaf].FatBox = box.Expand(m_fatMargin);
+    m_nodes[leaf].Actor = actorId;
+    m_nodes[leaf].UserData = userData;
+
+    InsertLeaf(leaf);
+    ++m_proxyCount;
+
+    return leaf;
+}
+
+void AabbTree::DestroyProxy(_In_ AabbProxy proxy)
+{
+    _ASSERTE(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+    if (IsDetached(proxy))
+        m_detachedLeaves.erase(find(m_detachedLeaves.begin(), m_detachedLeaves.end(), proxy));
+    else
+        RemoveLeaf(proxy);
+
+    FreeNode(proxy);
+    --m_proxyCount;
+}
+
+bool AabbTree::MoveProxy(_In_ AabbProxy proxy, _In_ const AxisAlignedBox& box)
+{
+    _ASSERTE(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+    m_nodes[proxy].TightBox = box;
+
+    if (m_nodes[proxy].FatBox.Contains(box))
+        return false;
+
+    m_nodes[proxy].FatBox = box.Expand(m_fatMargin);
+
+    // A detached leaf is inserted with its new box by Refit
+    if (IsDetached(proxy))
+        return false;
+
+    RemoveLeaf(proxy);
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// A leaf that escaped its fat box is detached from the tree and waits for Refit to be inserted back, the tree stays
+// consistent but misses the detached leaves until then. Queries must not run between RefitProxy and Refit.
+//---------------------------------------------------------------------------------------------------------------------
+void AabbTree::RefitProxy(_In_ AabbProxy proxy, _In_ const AxisAlignedBox& box)
+{
+    _ASSERTE(proxy < m_nodes.size() && m_nodes[proxy].IsLeaf());
+
+    m_nodes[proxy].TightBox = box;
+
+    if (m_nodes[proxy].FatBox.Contains(box))
+        return;
+
+    m_nodes[proxy].FatBox = box.Expand(m_fatMargin);
+
+    if (IsDetached(proxy))
+        return;
+
+    RemoveLeaf(proxy);
+    m_nodes[proxy].Parent = NullNode;
+    m_detachedLeaves.push_back(proxy);
+}
+
+void AabbTree::Refit()
+{
+    for (auto leaf : m_detachedLeaves)
+        InsertLeaf(leaf);
+
+    m_detachedLeaves.clear();
+}
+
+unsigned AabbTree::AllocateNode()
+{
+    unsigned node;
+
+    if (m_freeList != NullNode)
+    {
+        node = m_freeList;
+        m_freeList = m_nodes[node].Parent;
+    }
+    else
+    {
+        node = (unsigned)m_nodes.size();
+        m_nodes.push_back(Node());
+    }
+
+    Node& n = m_nodes[node];
+    n.Parent = NullNode;
+    n.Child1 = NullNode;
+    n.Child2 = NullNode;
+    n.Height = 0;
+    n.Actor = NullActorID;
+    n.UserData = 0;
+
+    return node;
+}
+
+void AabbTree::FreeNode(_In_ unsigned node)
+{
+    m_nodes[node].Parent = m_freeList;
+    m_nodes[node].Height = -1;
+    m_freeList = node;
+}
+
+void AabbTree::UpdateNode(_In_ unsigned node)
+{
+    Node& n = m_nodes[node];
+    const Node& child1 = m_nodes[n.Child1];
+    const Node& child2 = m_nodes[n.Child2];
+
+    n.FatBox = AxisAlignedBox::Union(child1.FatBox, child2.FatBox);
+    n.Height = 1 + max(child1.Height, child2.Height);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Walks down to the sibling that minimizes the surface area added to the tree, a node becomes the sibling when going
+// further down would cost more than pairing the leaf with it.
+//---------------------------------------------------------------------------------------------------------------------
+void AabbTree::InsertLeaf(_In_ unsigned leaf)
+{
+    if (m_root == NullNode)
+    {
+        m_root = leaf;
+        m_nodes[leaf].Parent = NullNode;
+        return;
+    }
+
+    AxisAlignedBox leafBox = m_nodes[leaf].FatBox;
+    unsigned index = m_root;
+
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node& node = m_nodes[index];
+        real area = node.FatBox.SurfaceArea();
+        real combinedArea = AxisAlignedBox::Union(node.FatBox, leafBox).SurfaceArea();
+
+        // Cost of creating a new parent for this node and the leaf
+        real cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down, every ancestor grows
+        real inheritanceCost = 2.0f * (combinedArea - area);
+
+        real childCost[2];
+        unsigned children[2] = { node.Child1, node.Child2 };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const Node& child = m_nodes[children[i]];
+            real childArea = AxisAlignedBox::Union(child.FatBox, leafBox).SurfaceArea();
+
+            if (child.IsLeaf())
+                childCost[i] = childArea + inheritanceCost;
+            else
+                childCost[i] = childArea - child.FatBox.SurfaceArea() + inheritanceCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+            break;
+
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    unsigned sibling = index;
+    unsigned oldParent = m_nodes[sibling].Parent;
+    unsigned newParent = AllocateNode();
+
+    Node& parent = m_nodes[newParent];
+    parent.Parent = oldParent;
+    parent.Child1 = sibling;
+    parent.Child2 = leaf;
+    parent.FatBox = AxisAlignedBox::Union(leafBox, m_nodes[sibling].FatBox);
+    parent.Height = m_nodes[sibling].Height + 1;
+
+    if (oldParent != NullNode)
+    {
+        if (m_nodes[oldParent].Child1 == sibling)
+            m_nodes[oldParent].Child1 = newParent;
+        else
+            m_nodes[oldParent].Child2 = newParent;
+    }
+    else
+    {
+        m_root = newParent;
+    }
+
+    m_nodes[sibling].Parent = newParent;
+    m_nodes[leaf].Parent = newParent;
+
+    for (index = m_nodes[leaf].Parent; index != NullNode; index = m_nodes[index].Parent)
+    {
+        index = Balance(index);
+        UpdateNode(index);
+    }
+}
+
+void AabbTree::RemoveLeaf(_In_ unsigned leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = NullNode;
+        return;
+    }
+
+    unsigned parent = m_nodes[leaf].Parent;
+    unsigned grandParent = m_nodes[parent].Parent;
+    unsigned sibling = m_nodes[parent].Child1 == leaf ? m_nodes[parent].Child2 : m_nodes[parent].Child1;
+
+    FreeNode(parent);
+
+    if (grandParent == NullNode)
+    {
+        m_root = sibling;
+        m_nodes[sibling].Parent = NullNode;
+        return;
+    }
+
+    // The sibling takes the parent place
+    if (m_nodes[grandParent].Child1 == parent)
+        m_nodes[grandParent].Child1 = sibling;
+    else
+        m_nodes[grandParent].Child2 = sibling;
+
+    m_nodes[sibling].Parent = grandParent;
+
+    for (unsigned index = grandParent; index != NullNode; index = m_nodes[index].Parent)
+    {
+        index = Balance(index);
+        UpdateNode(index);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Rotates the taller child up when the children heights differ by more than 1, returns the node now at the root of
+// the subtree.
+//---------------------------------------------------------------------------------------------------------------------
+unsigned AabbTree::Balance(_In_ unsigned node)
+{
+    const Node& n = m_nodes[node];
+
+    if (n.IsLeaf() || n.Height < 2)
+        return node;
+
+    int balance = m_nodes[n.Child2].Height - m_nodes[n.Child1].Height;
+
+    if (balance > 1)
+        return Rotate(node, n.Child2);
+    else if (balance < -1)
+        return Rotate(node, n.Child1);
+    else
+        return node;
+}
+
+unsigned AabbTree::Rotate(_In_ unsigned node, _In_ unsigned child)
+{
+    Node& a = m_nodes[node];
+    Node& c = m_nodes[child];
+
+    unsigned tallGrandChild = c.Child1;
+    unsigned shortGrandChild = c.Child2;
+
+    if (m_nodes[tallGrandChild].Height < m_nodes[shortGrandChild].Height)
+        swap(tallGrandChild, shortGrandChild);
+
+    // The child takes the node place
+    c.Parent = a.Parent;
+    a.Parent = child;
+
+    if (c.Parent != NullNode)
+    {
+        if (m_nodes[c.Parent].Child1 == node)
+            m_nodes[c.Parent].Child1 = child;
+        else
+            m_nodes[c.Parent].Child2 = child;
+    }
+    else
+    {
+        m_root = child;
+    }
+
+    // The node goes under its old child along with the taller grand child, the shorter one replaces the child
+    c.Child1 = node;
+    c.Child2 = tallGrandChild;
+
+    if (a.Child1 == child)
+        a.Child1 = shortGrandChild;
+    else
+        a.Child2 = shortGrandChild;
+
+    m_nodes[shortGrandChild].Parent = node;
+
+    UpdateNode(node);
+    UpdateNode(child);
+
+    return child;
+}
+
+namespace
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // Nodes left to visit by a query. The balanced tree rarely needs more than the fixed part, deeper trees spill
+    // into the heap instead of overflowing.
+    //---------------------------------------------------------------------------------------------------------------------
+    class NodeStack
+    {
+    public:
+        NodeStack() : m_top(0) {}
+
+        bool IsEmpty() const { return m_top == 0 && m_overflow.empty(); }
+
+        void Push(_In_ unsigned node)
+        {
+            if (m_top < FixedSize)
+                m_fixed[m_top++] = node;
+            else
+                m_overflow.push_back(node);
+        }
+
+        // Overflowed nodes were pushed last, they are popped first
+        unsigned Pop()
+        {
+            if (!m_overflow.empty())
+            {
+                unsigned node = m_overflow.back();
+                m_overflow.pop_back();
+                return node;
+            }
+
+            return m_fixed[--m_top];
+        }
+
+    private:
+        static const int FixedSize = 64;
+
+        unsigned m_fixed[FixedSize];
+        int m_top;
+        vector<unsigned> m_overflow;
+    };
+
+    // Collects every hit along with its distance
+    class RayHitsCollector : public IAabbRayCallback
+    {
+    public:
+        RayHitsCollector(_In_ const AabbTree& tree, _In_ const Vec3& origin, _In_ const Vec3& invDirection) :
+            m_tree(tree),
+            m_origin(origin),
+            m_invDirection(invDirection)
+        {}
+
+        real ReportProxy(_In_ AabbProxy proxy, _In_ real maxDistance)
+        {
+            real distance;
+
+            if (m_tree.ProxyBox(proxy).IntersectRay(m_origin, m_invDirection, maxDistance, distance))
+                Hits.push_back(make_pair(distance, m_tree.ProxyActor(proxy)));
+
+            return maxDistance;
+        }
+
+        vector<pair<real, ActorID>> Hits;
+
+    private:
+        const AabbTree& m_tree;
+        Vec3 m_origin;
+        Vec3 m_invDirection;
+    };
+}
+
+void AabbTree::Raycast(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Out_ std::vector<ActorID>& actors) const
+{
+    Vec3 invDirection(InverseDirection(direction.x), InverseDirection(direction.y), InverseDirection(direction.z));
+    RayHitsCollector collector(*this, origin, invDirection);
+
+    Raycast(origin, direction, maxDistance, collector);
+    sort(collector.Hits.begin(), collector.Hits.end());
+
+    actors.clear();
+    for (auto& hit : collector.Hits)
+        actors.push_back(hit.second);
+}
+
+void AabbTree::Raycast(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Inout_ IAabbRayCallback& callback) const
+{
+    _ASSERTE(m_detachedLeaves.empty());
+
+    if (m_root == NullNode)
+        return;
+
+    Vec3 invDirection(InverseDirection(direction.x), InverseDirection(direction.y), InverseDirection(direction.z));
+
+    NodeStack stack;
+    stack.Push(m_root);
+
+    while (!stack.IsEmpty())
+    {
+        unsigned nodeIdx = stack.Pop();
+        const Node& node = m_nodes[nodeIdx];
+        real distance;
+
+        if (!node.FatBox.IntersectRay(origin, invDirection, maxDistance, distance))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (node.TightBox.IntersectRay(origin, invDirection, maxDistance, distance))
+                maxDistance = callback.ReportProxy(nodeIdx, maxDistance);
+        }
+        else
+        {
+            stack.Push(node.Child1);
+            stack.Push(node.Child2);
+        }
+    }
+}
+
+void AabbTree::OverlapSphere(_In_ const BoundingSphere& sphere, _Out_ std::vector<ActorID>& actors) const
+{
+    _ASSERTE(m_detachedLeaves.empty());
+
+    actors.clear();
+
+    if (m_root == NullNode)
+        return;
+
+    NodeStack stack;
+    stack.Push(m_root);
+
+    while (!stack.IsEmpty())
+    {
+        const Node& node = m_nodes[stack.Pop()];
+
+        if (!node.FatBox.Overlap(sphere))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (node.TightBox.Overlap(sphere))
+                actors.push_back(node.Actor);
+        }
+        else
+        {
+            stack.Push(node.Child1);
+            stack.Push(node.Child2);
+        }
+    }
+}
+
+void AabbTree::OverlapBox(_In_ const AxisAlignedBox& box, _Out_ std::vector<ActorID>& actors) const
+{
+    _ASSERTE(m_detachedLeaves.empty());
+
+    actors.clear();
+
+    if (m_root == NullNode)
+        return;
+
+    NodeStack stack;
+    stack.Push(m_root);
+
+    while (!stack.IsEmpty())
+    {
+        const Node& node = m_nodes[stack.Pop()];
+
+        if (!node.FatBox.Overlap(box))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            if (node.TightBox.Overlap(box))
+                actors.push_back(node.Actor);
+        }
+        else
+        {
+            stack.Push(node.Child1);
+            stack.Push(node.Child2);
+        }
+    }
+}
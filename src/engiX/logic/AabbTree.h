@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "CollisionDetection.h"
+#include "Actor.h"
+
+namespace engiX
+{
+    typedef unsigned AabbProxy;
+    const AabbProxy NullAabbProxy = unsigned(-1);
+
+    // Receives the proxies whose box a ray hits, see AabbTree::Raycast
+    class IAabbRayCallback
+    {
+    public:
+        virtual ~IAabbRayCallback() {}
+        // Returns the distance the ray is clipped to from now on, e.g the distance of the closest hit
+        // so far, boxes beyond it are skipped. Returning maxDistance keeps the ray as it is
+        virtual real ReportProxy(_In_ AabbProxy proxy, _In_ real maxDistance) = 0;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // AabbTree class
+    //
+    // Dynamic bounding volume hierarchy of axis aligned boxes for ray and volume queries. Every leaf (proxy) holds
+    // the box of one actor; internal nodes hold the union of their children. Nodes live in a single pool and are
+    // linked by index, freed nodes are recycled.
+    //
+    // Leaves are fattened by a margin so that small moves do not touch the tree at all. Leaves are inserted next to
+    // the sibling that grows the tree surface area the least and the tree is kept balanced by AVL-like rotations on
+    // the way back to the root.
+    //
+    // MoveProxy reinserts a leaf that escaped its fat box right away. When many leaves move in a batch (e.g once per
+    // physics step) RefitProxy only takes the escaped leaves out of the tree and Refit inserts them all back at once,
+    // so each one is placed next to the final boxes of the others instead of their boxes of the last batch.
+    //
+    // Queries test the fat boxes while walking the tree and the actual (tight) leaf box before reporting an actor.
+    //---------------------------------------------------------------------------------------------------------------------
+    class AabbTree
+    {
+    public:
+        static const real DefaultFatMargin;
+
+        AabbTree(_In_ real fatMargin = DefaultFatMargin);
+
+        AabbProxy CreateProxy(_In_ const AxisAlignedBox& box, _In_ ActorID actorId, _In_ unsigned userData = 0);
+        void DestroyProxy(_In_ AabbProxy proxy);
+        // Returns true if the proxy was reinserted
+        bool MoveProxy(_In_ AabbProxy proxy, _In_ const AxisAlignedBox& box);
+        void RefitProxy(_In_ AabbProxy proxy, _In_ const AxisAlignedBox& box);
+        void Refit();
+        void Clear();
+
+        // Actors hit by the ray, sorted by hit distance. The direction does not need to be normalized,
+        // distances are in direction length units
+        void Raycast(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Out_ std::vector<ActorID>& actors) const;
+        // Reports the proxies whose tight box the ray hits, in no particular order
+        void Raycast(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Inout_ IAabbRayCallback& callback) const;
+        void OverlapSphere(_In_ const BoundingSphere& sphere, _Out_ std::vector<ActorID>& actors) const;
+        void OverlapBox(_In_ const AxisAlignedBox& box, _Out_ std::vector<ActorID>& actors) const;
+
+        ActorID ProxyActor(_In_ AabbProxy proxy) const { return m_nodes[proxy].Actor; }
+        const AxisAlignedBox& ProxyBox(_In_ AabbProxy proxy) const { return m_nodes[proxy].TightBox; }
+        unsigned ProxyUserData(_In_ AabbProxy proxy) const { return m_nodes[proxy].UserData; }
+        size_t ProxyCount() const { return m_proxyCount; }
+        int Height() const { return m_root == NullNode ? 0 : m_nodes[m_root].Height; }
+
+    protected:
+        static const unsigned NullNode = unsigned(-1);
+
+        struct Node
+        {
+            bool IsLeaf() const { return Child1 == NullNode; }
+
+            AxisAlignedBox FatBox;
+            AxisAlignedBox TightBox;
+            unsigned Parent; // next free node when the node is in the free list
+            unsigned Child1;
+            unsigned Child2;
+            int Height;      // leaves are at 0, free nodes at -1
+            ActorID Actor;
+            unsigned UserData;
+        };
+
+        unsigned AllocateNode();
+        void FreeNode(_In_ unsigned node);
+        void InsertLeaf(_In_ unsigned leaf);
+        void RemoveLeaf(_In_ unsigned leaf);
+        unsigned Balance(_In_ unsigned node);
+        unsigned Rotate(_In_ unsigned node, _In_ unsigned child);
+        void UpdateNode(_In_ unsigned node);
+        bool IsDetached(_In_ unsigned leaf) const { return m_nodes[leaf].Parent == NullNode && leaf != m_root; }
+
+    private:
+        std::vector<Node> m_nodes;
+        unsigned m_root;
+        unsigned m_freeList;
+        size_t m_proxyCount;
+        real m_fatMargin;
+        // Leaves taken out of the tree by RefitProxy, inserted back by Refit
+        std::vector<unsigned> m_detachedLeaves;
+    };
+}
@@ -1,6 +1,5 @@
 #include "Actor.h"
 #include "Logger.h"
-#include "WinGameApp.h"
 
 using namespace engiX;
 
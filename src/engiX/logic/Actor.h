@@ -10,7 +10,7 @@
 #define DECLARE_COMPONENT(CmptName, CmptGuid) \
     static const ComponentID TypeID = CmptGuid; \
     ComponentID TypeId() const { return TypeID; } \
-    const wchar_t* Typename() const { return L#CmptName; } \
+    const wchar_t* Typename() const { return WSTRINGIFY(CmptName); } \
 
 namespace engiX
 {
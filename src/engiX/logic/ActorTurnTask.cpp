@@ -1,5 +1,5 @@
 #include "ActorTurnTask.h"
-#include "WinGameApp.h"
+#include "GameApp.h"
 #include "MathHelper.h"
 #include "GameLogic.h"
 
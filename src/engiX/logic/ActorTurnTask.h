@@ -13,6 +13,7 @@ namespace engiX
             m_actorId(actorId),
             m_turnVelocities(turnVelocities)
         {}
+        const wchar_t* Typename() const { return L"ActorTurnTask"; }
         void OnUpdate(_In_ const Timer& time);
 
     private:
@@ -0,0 +1,158 @@
+#include "BatchCollision.h"
+#include <cstring>
+#include "Simd.h"
+
+using namespace engiX;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+namespace
+{
+    // Receives the hit lanes of each batch that hit anything, batches start at a multiple of
+    // their width which is a divisor of 32 so a batch lanes never straddle 2 bitmask words
+    class HitBitsSink
+    {
+    public:
+        HitBitsSink(_Out_ unsigned* pHitBits) : m_pHitBits(pHitBits) {}
+
+        void Add(_In_ size_t first, _In_ unsigned laneMask)
+        {
+            m_pHitBits[first >> 5] |= laneMask << (first & 31);
+        }
+
+    private:
+        unsigned* m_pHitBits;
+    };
+
+    class HitIndicesSink
+    {
+    public:
+        HitIndicesSink(_Out_ unsigned* pIndices) : m_pIndices(pIndices), m_count(0) {}
+
+        void Add(_In_ size_t first, _In_ unsigned laneMask)
+        {
+            for (unsigned lane = 0; laneMask != 0; ++lane, laneMask >>= 1)
+            {
+                if (laneMask & 1)
+                    m_pIndices[m_count++] = unsigned(first + lane);
+            }
+        }
+
+        size_t Count() const { return m_count; }
+
+    private:
+        unsigned* m_pIndices;
+        size_t m_count;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // Sphere i hits when its radius is positive and ||center - pos[i]||^2 <= (queryRadius + radius[i])^2, a point is
+    // a 0 radius query.
+    //---------------------------------------------------------------------------------------------------------------------
+    template<class TSink>
+    void TestSpheres(_In_ const Vec3& center, _In_ real queryRadius, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+        _In_ const real* pRadius, _In_ size_t count, _Inout_ TSink& sink)
+    {
+        size_t i = 0;
+
+#if defined(ENGIX_SIMD_AVX)
+        __m256 cx = _mm256_set1_ps(center.x);
+        __m256 cy = _mm256_set1_ps(center.y);
+        __m256 cz = _mm256_set1_ps(center.z);
+        __m256 qr = _mm256_set1_ps(queryRadius);
+        __m256 vZero = _mm256_setzero_ps();
+
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 dx = _mm256_sub_ps(_mm256_load_ps(pX + i), cx);
+            __m256 dy = _mm256_sub_ps(_mm256_load_ps(pY + i), cy);
+            __m256 dz = _mm256_sub_ps(_mm256_load_ps(pZ + i), cz);
+            __m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            __m256 radius = _mm256_load_ps(pRadius + i);
+            __m256 radiusSum = _mm256_add_ps(radius, qr);
+            __m256 hit = _mm256_and_ps(
+                _mm256_cmp_ps(distSq, _mm256_mul_ps(radiusSum, radiusSum), _CMP_LE_OQ),
+                _mm256_cmp_ps(radius, vZero, _CMP_GT_OQ));
+
+            unsigned laneMask = (unsigned)_mm256_movemask_ps(hit);
+
+            if (laneMask != 0)
+                sink.Add(i, laneMask);
+        }
+#elif !defined(ENGIX_SIMD_SCALAR)
+        XMVECTOR cx = XMVectorReplicate(center.x);
+        XMVECTOR cy = XMVectorReplicate(center.y);
+        XMVECTOR cz = XMVectorReplicate(center.z);
+        XMVECTOR qr = XMVectorReplicate(queryRadius);
+        XMVECTOR vZero = XMVectorZero();
+
+        for (; i + 4 <= count; i += 4)
+        {
+            XMVECTOR dx = XMVectorSubtract(Simd::Load4(pX + i), cx);
+            XMVECTOR dy = XMVectorSubtract(Simd::Load4(pY + i), cy);
+            XMVECTOR dz = XMVectorSubtract(Simd::Load4(pZ + i), cz);
+            XMVECTOR distSq = XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx)));
+            XMVECTOR radius = Simd::Load4(pRadius + i);
+            XMVECTOR radiusSum = XMVectorAdd(radius, qr);
+            XMVECTOR hit = XMVectorAndInt(
+                XMVectorLessOrEqual(distSq, XMVectorMultiply(radiusSum, radiusSum)),
+                XMVectorGreater(radius, vZero));
+
+            unsigned laneMask = Simd::MoveMask4(hit);
+
+            if (laneMask != 0)
+                sink.Add(i, laneMask);
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            real dx = pX[i] - center.x;
+            real dy = pY[i] - center.y;
+            real dz = pZ[i] - center.z;
+            real radiusSum = pRadius[i] + queryRadius;
+            unsigned laneMask = (pRadius[i] > 0.0f && dx * dx + dy * dy + dz * dz <= radiusSum * radiusSum) ? 1u : 0u;
+
+            if (laneMask != 0)
+                sink.Add(i, laneMask);
+        }
+    }
+}
+
+void BatchCollision::OverlapSphere(_In_ const BoundingSphere& sphere, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+    _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pHitBits)
+{
+    memset(pHitBits, 0, HitBitsWordCount(count) * sizeof(unsigned));
+
+    HitBitsSink sink(pHitBits);
+    TestSpheres(sphere.Position(), sphere.Radius(), pX, pY, pZ, pRadius, count, sink);
+}
+
+size_t BatchCollision::OverlapSphereIndices(_In_ const BoundingSphere& sphere, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+    _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pIndices)
+{
+    HitIndicesSink sink(pIndices);
+    TestSpheres(sphere.Position(), sphere.Radius(), pX, pY, pZ, pRadius, count, sink);
+
+    return sink.Count();
+}
+
+void BatchCollision::ContainsPoint(_In_ const Vec3& point, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+    _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pHitBits)
+{
+    memset(pHitBits, 0, HitBitsWordCount(count) * sizeof(unsigned));
+
+    HitBitsSink sink(pHitBits);
+    TestSpheres(point, 0.0f, pX, pY, pZ, pRadius, count, sink);
+}
+
+size_t BatchCollision::ContainsPointIndices(_In_ const Vec3& point, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+    _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pIndices)
+{
+    HitIndicesSink sink(pIndices);
+    TestSpheres(point, 0.0f, pX, pY, pZ, pRadius, count, sink);
+
+    return sink.Count();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "engiXDefs.h"
+#include "CollisionDetection.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // BatchCollision class
+    //
+    // Tests one query sphere or point against N spheres stored as structure-of-arrays (e.g the ParticleIntegrator
+    // arrays), 8 spheres per instruction with AVX, 4 with SSE or one at a time with the scalar fallback, see Simd.h.
+    // Distances are compared squared, no square root is taken.
+    //
+    // The input arrays must be aligned like RealArray. Spheres with a 0 radius (e.g free integrator slots) never
+    // hit. Results are either written as a bitmask, bit i of word i / 32 is set for a hit on sphere i, or as the
+    // compacted list of the spheres indices that hit, in increasing order.
+    //---------------------------------------------------------------------------------------------------------------------
+    class BatchCollision
+    {
+    public:
+        static size_t HitBitsWordCount(_In_ size_t count) { return (count + 31) / 32; }
+
+        // pHitBits holds HitBitsWordCount(count) words
+        static void OverlapSphere(_In_ const BoundingSphere& sphere, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+            _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pHitBits);
+        // pIndices holds up to count indices, returns the number of hits
+        static size_t OverlapSphereIndices(_In_ const BoundingSphere& sphere, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+            _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pIndices);
+        static void ContainsPoint(_In_ const Vec3& point, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+            _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pHitBits);
+        static size_t ContainsPointIndices(_In_ const Vec3& point, _In_ const real* pX, _In_ const real* pY, _In_ const real* pZ,
+            _In_ const real* pRadius, _In_ size_t count, _Out_ unsigned* pIndices);
+    };
+}
@@ -1,30 +1,172 @@
 #include "CollisionDetection.h"
+#include <algorithm>
 #include "MathHelper.h"
 
 using namespace engiX;
-using namespace DirectX;
+using namespace engiX::VecMath;
+using namespace std;
 
-bool BoundingSphere::IsPointInside(_In_ const Vec3& point)
+bool BoundingSphere::IsPointInside(_In_ const Vec3& point) const
 {
-     Vec3 distSq;
-     
-     // distSq = ||v1 - v2||^2
-     XMStoreFloat3(&distSq,
-         XMVector3LengthSq(
-         XMVectorSubtract(XMLoadFloat3(&point), XMLoadFloat3(&m_position))));
+    // distSq = ||v1 - v2||^2
+    real distSq = LengthSq3(Subtract(Load3(point), Load3(m_position)));
 
-     return (distSq.x <= m_radiusSq);
+    return (distSq <= m_radiusSq);
 }
 
-bool BoundingSphere::Collide(_In_ const BoundingSphere& other)
+bool BoundingSphere::Collide(_In_ const BoundingSphere& other) const
 {
-    Vec3 dist;
+    real radiusSum = m_radius + other.m_radius;
 
-    // dist = ||v1 - v2||
-    XMStoreFloat3(&dist,
-        XMVector3Length(
-        XMVectorSubtract(XMLoadFloat3(&other.m_position), XMLoadFloat3(&m_position))));
+    // distSq = ||v1 - v2||^2, compared squared to save the square root
+    real distSq = LengthSq3(Subtract(Load3(other.m_position), Load3(m_position)));
 
-    return (dist.x <= (m_radius + other.m_radius));
+    return (distSq <= radiusSum * radiusSum);
 }
 
+
+//---------------------------------------------------------------------------------------------------------------------
+// Solves ||s + v*t|| = r for the smallest t in [0, 1], where s and v are the relative position and displacement of
+// the other sphere and r is the sum of the radii.
+//---------------------------------------------------------------------------------------------------------------------
+bool BoundingSphere::Sweep(_In_ const Vec3& displacement, _In_ const BoundingSphere& other, _In_ const Vec3& otherDisplacement, _Out_ real& toi) const
+{
+    Vector s = Subtract(Load3(other.m_position), Load3(m_position));
+    Vector v = Subtract(Load3(otherDisplacement), Load3(displacement));
+
+    real radiusSum = m_radius + other.m_radius;
+    real c = GetX(Dot3(s, s)) - radiusSum * radiusSum;
+
+    toi = 0.0f;
+
+    if (c <= 0.0f)
+        return true;
+
+    real a = GetX(Dot3(v, v));
+    real b = GetX(Dot3(s, v));
+
+    // Not moving relative to each other or moving apart
+    if (a <= real_epsilon || b >= 0.0f)
+        return false;
+
+    real discriminant = b * b - a * c;
+
+    if (discriminant < 0.0f)
+        return false;
+
+    toi = (-b - real_sqrt(discriminant)) / a;
+
+    return toi <= 1.0f;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Solves ||m + d*t|| = r for the smallest t in [0, maxDistance], where m is the ray origin relative to the sphere
+// center and d the ray direction. A ray starting inside the sphere hits it at 0.
+//---------------------------------------------------------------------------------------------------------------------
+bool BoundingSphere::IntersectRay(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Out_ real& distance) const
+{
+    Vector m = Subtract(Load3(origin), Load3(m_position));
+    Vector d = Load3(direction);
+
+    real c = GetX(Dot3(m, m)) - m_radiusSq;
+
+    distance = 0.0f;
+
+    if (c <= 0.0f)
+        return true;
+
+    real a = GetX(Dot3(d, d));
+    real b = GetX(Dot3(m, d));
+
+    // Null direction or pointing away from the sphere
+    if (a <= real_epsilon || b >= 0.0f)
+        return false;
+
+    real discriminant = b * b - a * c;
+
+    if (discriminant < 0.0f)
+        return false;
+
+    distance = (-b - real_sqrt(discriminant)) / a;
+
+    return distance <= maxDistance;
+}
+
+AxisAlignedBox AxisAlignedBox::FromSphere(_In_ const Vec3& center, _In_ real radius)
+{
+    return AxisAlignedBox(
+        Vec3(center.x - radius, center.y - radius, center.z - radius),
+        Vec3(center.x + radius, center.y + radius, center.z + radius));
+}
+
+AxisAlignedBox AxisAlignedBox::Union(_In_ const AxisAlignedBox& a, _In_ const AxisAlignedBox& b)
+{
+    return AxisAlignedBox(
+        Vec3(min(a.m_min.x, b.m_min.x), min(a.m_min.y, b.m_min.y), min(a.m_min.z, b.m_min.z)),
+        Vec3(max(a.m_max.x, b.m_max.x), max(a.m_max.y, b.m_max.y), max(a.m_max.z, b.m_max.z)));
+}
+
+bool AxisAlignedBox::Contains(_In_ const AxisAlignedBox& other) const
+{
+    return m_min.x <= other.m_min.x && m_min.y <= other.m_min.y && m_min.z <= other.m_min.z &&
+        other.m_max.x <= m_max.x && other.m_max.y <= m_max.y && other.m_max.z <= m_max.z;
+}
+
+bool AxisAlignedBox::Overlap(_In_ const AxisAlignedBox& other) const
+{
+    return m_min.x <= other.m_max.x && other.m_min.x <= m_max.x &&
+        m_min.y <= other.m_max.y && other.m_min.y <= m_max.y &&
+        m_min.z <= other.m_max.z && other.m_min.z <= m_max.z;
+}
+
+bool AxisAlignedBox::Overlap(_In_ const BoundingSphere& sphere) const
+{
+    const Vec3& center = sphere.Position();
+
+    // Squared distance from the sphere center to the closest point of the box
+    real dx = max(max(m_min.x - center.x, center.x - m_max.x), 0.0f);
+    real dy = max(max(m_min.y - center.y, center.y - m_max.y), 0.0f);
+    real dz = max(max(m_min.z - center.z, center.z - m_max.z), 0.0f);
+
+    return (dx * dx + dy * dy + dz * dz) <= sphere.Radius() * sphere.Radius();
+}
+
+real AxisAlignedBox::SurfaceArea() const
+{
+    real dx = m_max.x - m_min.x;
+    real dy = m_max.y - m_min.y;
+    real dz = m_max.z - m_min.z;
+
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+AxisAlignedBox AxisAlignedBox::Expand(_In_ real margin) const
+{
+    return AxisAlignedBox(
+        Vec3(m_min.x - margin, m_min.y - margin, m_min.z - margin),
+        Vec3(m_max.x + margin, m_max.y + margin, m_max.z + margin));
+}
+
+bool AxisAlignedBox::IntersectRay(_In_ const Vec3& origin, _In_ const Vec3& invDirection, _In_ real maxDistance, _Out_ real& distance) const
+{
+    // Slabs test
+    real t1 = (m_min.x - origin.x) * invDirection.x;
+    real t2 = (m_max.x - origin.x) * invDirection.x;
+    real tMin = min(t1, t2);
+    real tMax = max(t1, t2);
+
+    t1 = (m_min.y - origin.y) * invDirection.y;
+    t2 = (m_max.y - origin.y) * invDirection.y;
+    tMin = max(tMin, min(t1, t2));
+    tMax = min(tMax, max(t1, t2));
+
+    t1 = (m_min.z - origin.z) * invDirection.z;
+    t2 = (m_max.z - origin.z) * invDirection.z;
+    tMin = max(tMin, min(t1, t2));
+    tMax = min(tMax, max(t1, t2));
+
+    tMin = max(tMin, 0.0f);
+    distance = tMin;
+
+    return tMin <= tMax && tMin <= maxDistance;
+}
@@ -9,7 +9,8 @@ namespace engiX
     public:
         BoundingSphere() :
             m_radius(0.0),
-            m_position(DirectX::g_XMZero)
+            m_radiusSq(0.0),
+            m_position(0.0f, 0.0f, 0.0f)
         {}
 
         BoundingSphere(_In_ real radius, _In_ Vec3 position = Vec3(0.0, 0.0, 0.0)) :
@@ -18,8 +19,14 @@ namespace engiX
             m_position(position)
         {}
 
-        bool IsPointInside(_In_ const Vec3& point);
-        bool Collide(_In_ const BoundingSphere& other);
+        bool IsPointInside(_In_ const Vec3& point) const;
+        bool Collide(_In_ const BoundingSphere& other) const;
+        // Continuous collision of both spheres moving linearly by their displacement from their current
+        // position. toi is the fraction of the motion at first contact, 0 if they already overlap
+        bool Sweep(_In_ const Vec3& displacement, _In_ const BoundingSphere& other, _In_ const Vec3& otherDisplacement, _Out_ real& toi) const;
+        // Distance along the ray to the sphere entry, 0 if the origin is inside. The direction does not need to be
+        // normalized, distances are in direction length units
+        bool IntersectRay(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _Out_ real& distance) const;
         const Vec3& Position() const { return m_position; }
         void Position(Vec3 val) { m_position = val; }
         real Radius() const { return m_radius; }
@@ -31,4 +38,41 @@ namespace engiX
         real m_radius;
         real m_radiusSq;
     };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // AxisAlignedBox class
+    //
+    // Box defined by its min and max corners, used as the bounding volume of the spatial query structures.
+    //---------------------------------------------------------------------------------------------------------------------
+    class AxisAlignedBox
+    {
+    public:
+        AxisAlignedBox() :
+            m_min(0.0, 0.0, 0.0),
+            m_max(0.0, 0.0, 0.0)
+        {}
+
+        AxisAlignedBox(_In_ const Vec3& minCorner, _In_ const Vec3& maxCorner) :
+            m_min(minCorner),
+            m_max(maxCorner)
+        {}
+
+        static AxisAlignedBox FromSphere(_In_ const Vec3& center, _In_ real radius);
+        static AxisAlignedBox Union(_In_ const AxisAlignedBox& a, _In_ const AxisAlignedBox& b);
+
+        const Vec3& Min() const { return m_min; }
+        const Vec3& Max() const { return m_max; }
+        bool Contains(_In_ const AxisAlignedBox& other) const;
+        bool Overlap(_In_ const AxisAlignedBox& other) const;
+        bool Overlap(_In_ const BoundingSphere& sphere) const;
+        real SurfaceArea() const;
+        AxisAlignedBox Expand(_In_ real margin) const;
+        // Distance along the ray to the box entry, 0 if the origin is inside. invDirection is the per component
+        // inverse of the ray direction, with a large value in place of the inverse of a 0 component
+        bool IntersectRay(_In_ const Vec3& origin, _In_ const Vec3& invDirection, _In_ real maxDistance, _Out_ real& distance) const;
+
+    private:
+        Vec3 m_min;
+        Vec3 m_max;
+    };
 }
\ No newline at end of file
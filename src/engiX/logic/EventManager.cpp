@@ -4,6 +4,26 @@ using namespace engiX;
 
 EventManager* g_pEventMgrInst = nullptr;
 
+// The type ids are initialized in Events.h, they are defined here for the calls that take them by reference
+const EventTypeID ToggleCameraEvt::TypeID;
+const EventTypeID DisplaySettingsChangedEvt::TypeID;
+const EventTypeID ActorCreatedEvt::TypeID;
+const EventTypeID ActorDestroyedEvt::TypeID;
+const EventTypeID StartTurnRightEvt::TypeID;
+const EventTypeID StartTurnLeftEvt::TypeID;
+const EventTypeID EndTurnRightEvt::TypeID;
+const EventTypeID EndTurnLeftEvt::TypeID;
+const EventTypeID StartForwardThrustEvt::TypeID;
+const EventTypeID StartBackwardThrustEvt::TypeID;
+const EventTypeID EndForwardThrustEvt::TypeID;
+const EventTypeID EndBackwardThrustEvt::TypeID;
+const EventTypeID StartFireWeaponEvt::TypeID;
+const EventTypeID EndFireWeaponEvt::TypeID;
+const EventTypeID ChangeWeaponEvt::TypeID;
+const EventTypeID ActorCollisionEvt::TypeID;
+const EventTypeID ActorEnteredVolumeEvt::TypeID;
+const EventTypeID ActorExitedVolumeEvt::TypeID;
+
 
 EventManager* EventManager::Inst()
 {
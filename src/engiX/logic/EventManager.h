@@ -30,6 +30,6 @@ namespace engiX
 #define g_EventMgr EventManager::Inst()
 
 #define REGISTER_EVT(CALLEE, EVT) \
-    g_EventMgr->Register(MakeDelegateP1<EventPtr>(this, &##CALLEE##::##On##EVT), EVT##::TypeID);
+    g_EventMgr->Register(MakeDelegateP1<EventPtr>(this, &CALLEE::On##EVT), EVT::TypeID);
 
 }
@@ -206,4 +206,46 @@ namespace engiX
         ActorID m_actorA;
         ActorID m_actorB;
     };
+
+    // The actor particle entered a trigger volume, see ParticleVolumes
+    class ActorEnteredVolumeEvt : public Event
+    {
+    public:
+        static const EventTypeID TypeID = 0xA3B48C4A;
+
+        ActorEnteredVolumeEvt(real timestamp, ActorID actorId, unsigned volumeId) :
+            Event(timestamp),
+            m_actorId(actorId),
+            m_volumeId(volumeId)
+        {}
+        EventTypeID TypeId() const { return TypeID; }
+        const wchar_t* Typename() const { return L"ActorEnteredVolumeEvt"; }
+        ActorID ActorId() const { return m_actorId; }
+        unsigned VolumeId() const { return m_volumeId; }
+
+    private:
+        ActorID m_actorId;
+        unsigned m_volumeId;
+    };
+
+    // The actor particle exited a trigger volume, see ParticleVolumes
+    class ActorExitedVolumeEvt : public Event
+    {
+    public:
+        static const EventTypeID TypeID = 0x6BCEFAB3;
+
+        ActorExitedVolumeEvt(real timestamp, ActorID actorId, unsigned volumeId) :
+            Event(timestamp),
+            m_actorId(actorId),
+            m_volumeId(volumeId)
+        {}
+        EventTypeID TypeId() const { return TypeID; }
+        const wchar_t* Typename() const { return L"ActorExitedVolumeEvt"; }
+        ActorID ActorId() const { return m_actorId; }
+        unsigned VolumeId() const { return m_volumeId; }
+
+    private:
+        ActorID m_actorId;
+        unsigned m_volumeId;
+    };
 }
\ No newline at end of file
@@ -8,9 +8,28 @@
 using namespace engiX;
 using namespace std;
 
+const real GameLogic::DefaultFixedTimeStep = 1.0f / 60.0f;
+const real GameLogic::DefaultMaxFrameTime = 0.25f;
+
+GameLogic::GameLogic() :
+    m_pView(nullptr),
+    m_fixedTimeStep(DefaultFixedTimeStep),
+    m_maxSubsteps(DefaultMaxSubsteps),
+    m_maxFrameTime(DefaultMaxFrameTime),
+    m_physicsAccumulator(0.0f),
+    m_interpolationAlpha(0.0f),
+    m_simulationTime(0.0f),
+    m_lastFrameSubsteps(0)
+{
+
+}
+
 GameLogic::~GameLogic()
 {
     SAFE_DELETE(m_pView);
+
+    // Destroy the actors while the systems their components reference are still alive
+    m_actors.clear();
 }
 
 void GameLogic::OnUpdate(_In_ const Timer& time)
@@ -31,9 +50,199 @@ void GameLogic::OnUpdate(_In_ const Timer& time)
     for (auto deadActor : m_deadActors)
         RemoveActor(deadActor);
 
+    UpdatePhysics(time);
+
+    m_animator.OnUpdate(time);
+
     m_taskMgr.OnUpdate(time);
 
-    m_pView->OnUpdate(time);
+    // Rebuild in one batch the matrices rotated during the update before the view reads them
+    m_transformBatch.Update();
+
+    // A headless logic, e.g. a dedicated server, runs without a view
+    if (m_pView)
+        m_pView->OnUpdate(time);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Advances the physics simulation by the frame time in fixed steps, the time left in the accumulator is less than a
+// step and carries over to the next frame, see InterpolationAlpha().
+//---------------------------------------------------------------------------------------------------------------------
+void GameLogic::UpdatePhysics(_In_ const Timer& time)
+{
+    m_physicsAccumulator += min(time.DeltaTime(), m_maxFrameTime);
+
+    m_contacts.clear();
+    m_contactPairs.clear();
+
+    m_lastFrameSubsteps = 0;
+    while (m_physicsAccumulator >= m_fixedTimeStep && m_lastFrameSubsteps < m_maxSubsteps)
+    {
+        StepPhysics(m_fixedTimeStep);
+        m_physicsAccumulator -= m_fixedTimeStep;
+        ++m_lastFrameSubsteps;
+    }
+
+    // Out of substeps, drop the whole steps we could not simulate in this frame
+    if (m_physicsAccumulator >= m_fixedTimeStep)
+    {
+        LogVerbose("Physics fell behind by %f seconds, dropping it", m_physicsAccumulator);
+        m_physicsAccumulator = real_fmod(m_physicsAccumulator, m_fixedTimeStep);
+    }
+
+    m_interpolationAlpha = m_physicsAccumulator / m_fixedTimeStep;
+
+    stable_sort(m_contacts.begin(), m_contacts.end(),
+        [](const ActorContact& x, const ActorContact& y) { return x.Time < y.Time; });
+
+    // Transforms only change when the simulation stepped
+    if (m_lastFrameSubsteps > 0)
+    {
+        m_integrator.WriteTransforms();
+        UpdateQueryTree();
+    }
+
+    RemoveKilledActors();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Destroys in one batch the actors whose particle was found inside a kill volume during the frame steps, a particle
+// that stays inside for several steps is reported once per step.
+//---------------------------------------------------------------------------------------------------------------------
+void GameLogic::RemoveKilledActors()
+{
+    if (m_killedActors.empty())
+        return;
+
+    sort(m_killedActors.begin(), m_killedActors.end());
+    m_killedActors.erase(unique(m_killedActors.begin(), m_killedActors.end()), m_killedActors.end());
+
+    for (auto actorId : m_killedActors)
+    {
+        if (m_actors.count(actorId) > 0)
+            RemoveActor(actorId);
+    }
+
+    m_killedActors.clear();
+}
+
+void GameLogic::StepPhysics(_In_ real dt)
+{
+    m_forceRegistry.ApplyForces(m_integrator, dt);
+    m_integrator.Integrate(dt);
+    m_constraintSolver.Solve(m_integrator, m_workers, dt);
+    m_volumes.Update(m_integrator);
+
+    for (auto slot : m_volumes.KilledSlots())
+        m_killedActors.push_back(m_integrator.SlotActor(slot));
+
+    for (auto& volumeEvt : m_volumes.Events())
+    {
+        if (volumeEvt.IsEnter)
+            g_EventMgr->Queue(EventPtr(eNEW ActorEnteredVolumeEvt(m_simulationTime + dt, volumeEvt.ActorId, volumeEvt.VolumeId)));
+        else
+            g_EventMgr->Queue(EventPtr(eNEW ActorExitedVolumeEvt(m_simulationTime + dt, volumeEvt.ActorId, volumeEvt.VolumeId)));
+    }
+
+    DetectCollisions(dt);
+
+    // The broadphase pairs were found on the swept spheres and are a superset of the overlapping particles
+    m_contactResolver.GenerateContacts(m_integrator, m_broadphase.Pairs());
+    m_contactResolver.Resolve(m_integrator, m_workers);
+    m_islands.Update(m_integrator, m_contactResolver.Contacts(), m_constraintSolver.Links(), dt);
+
+    m_simulationTime += dt;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// The broadphase is fed the spheres bounding each particle motion over the step, the candidate pairs are then swept
+// against each other to find their time of impact. Steps run in time order so the first contact recorded for a pair
+// in a frame is its earliest.
+//---------------------------------------------------------------------------------------------------------------------
+void GameLogic::DetectCollisions(_In_ real dt)
+{
+    m_integrator.SweptSpheres(m_sweptX, m_sweptY, m_sweptZ, m_sweptRadius);
+
+    m_broadphase.Update(
+        m_sweptX.data(),
+        m_sweptY.data(),
+        m_sweptZ.data(),
+        m_sweptRadius.data(),
+        m_integrator.Capacity(),
+        m_integrator.LayerBits(),
+        m_integrator.CollisionFilter());
+
+    for (auto& pair : m_broadphase.Pairs())
+    {
+        ActorID actorA = m_integrator.SlotActor(pair.A);
+        ActorID actorB = m_integrator.SlotActor(pair.B);
+
+        if (actorA == NullActorID || actorB == NullActorID)
+            continue;
+
+        if (actorA > actorB)
+            swap(actorA, actorB);
+
+        unsigned long long pairKey = ((unsigned long long)actorA << 32) | actorB;
+
+        if (m_contactPairs.count(pairKey) > 0)
+            continue;
+
+        Vec3 startA = m_integrator.PreviousPosition(pair.A);
+        Vec3 startB = m_integrator.PreviousPosition(pair.B);
+        Vec3 endA = m_integrator.Position(pair.A);
+        Vec3 endB = m_integrator.Position(pair.B);
+
+        BoundingSphere sphereA(m_integrator.Radius(pair.A), startA);
+        BoundingSphere sphereB(m_integrator.Radius(pair.B), startB);
+        real toi;
+
+        if (sphereA.Sweep(
+            Vec3(endA.x - startA.x, endA.y - startA.y, endA.z - startA.z),
+            sphereB,
+            Vec3(endB.x - startB.x, endB.y - startB.y, endB.z - startB.z),
+            toi))
+        {
+            m_contactPairs.insert(pairKey);
+            m_contacts.push_back(ActorContact(actorA, actorB, m_simulationTime + toi * dt));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Keeps one proxy per live integrator slot, the whole batch of moves is refit at once. Proxies carry their slot
+// for the raycaster exact sphere tests.
+//---------------------------------------------------------------------------------------------------------------------
+void GameLogic::UpdateQueryTree()
+{
+    m_slotProxies.resize(m_integrator.Capacity(), NullAabbProxy);
+
+    for (ParticleSlot slot = 0; slot < m_integrator.Capacity(); ++slot)
+    {
+        ActorID actorId = m_integrator.SlotActor(slot);
+        real radius = m_integrator.Radius(slot);
+        AabbProxy& proxy = m_slotProxies[slot];
+        bool isQueryable = (actorId != NullActorID && radius > 0.0f);
+
+        // The slot was freed or recycled by another actor since the last step
+        if (proxy != NullAabbProxy && (!isQueryable || m_queryTree.ProxyActor(proxy) != actorId))
+        {
+            m_queryTree.DestroyProxy(proxy);
+            proxy = NullAabbProxy;
+        }
+
+        if (!isQueryable)
+            continue;
+
+        AxisAlignedBox box = AxisAlignedBox::FromSphere(m_integrator.Position(slot), radius);
+
+        if (proxy == NullAabbProxy)
+            proxy = m_queryTree.CreateProxy(box, actorId, slot);
+        else
+            m_queryTree.RefitProxy(proxy, box);
+    }
+
+    m_queryTree.Refit();
 }
 
 Actor& GameLogic::GetActor(_In_ ActorID id)
@@ -60,6 +269,8 @@ Actor& GameLogic::GetActor(_In_ const wchar_t* pName)
 bool GameLogic::RemoveActor(_In_ ActorID id)
 {
     CBRB(m_actors.erase(id) > 0);
+    m_animator.RemoveTrack(id);
+    m_forceRegistry.UnregisterActor(id);
     g_EventMgr->Queue(EventPtr(eNEW ActorDestroyedEvt(id, 0)));
 
     return true;
@@ -71,6 +282,8 @@ bool GameLogic::AddInitActor(_In_ ActorUniquePtr pActor)
     {
         LogError("Actor %s[%d] initialization failed", pActor->Typename(), pActor->Id());
         m_actors.erase(pActor->Id());
+        m_animator.RemoveTrack(pActor->Id());
+        m_forceRegistry.UnregisterActor(pActor->Id());
         return false;
     }
 
@@ -85,7 +298,9 @@ bool GameLogic::AddInitActor(_In_ ActorUniquePtr pActor)
 bool GameLogic::Init()
 {
     CBRB(LoadLevel());
-    CBRB(m_pView->Init());
+
+    if (m_pView)
+        CBRB(m_pView->Init());
 
     return true;
 }
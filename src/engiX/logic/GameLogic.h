@@ -1,21 +1,46 @@
 #pragma once
 
 #include <set>
+#include <unordered_set>
 #include "Timer.h"
 #include "Actor.h"
 #include "ViewInterfaces.h"
 #include "CollisionDetection.h"
 #include "TaskManager.h"
 #include "ParticleForceGen.h"
+#include "TransformAnimator.h"
+#include "TransformBatch.h"
+#include "ParticleIntegrator.h"
+#include "SpatialHashBroadphase.h"
+#include "AabbTree.h"
+#include "ParticleContactResolver.h"
+#include "ParticleConstraintSolver.h"
+#include "ParticleIslands.h"
+#include "ParticleVolumes.h"
+#include "ParticleRaycaster.h"
+#include "WorkerPool.h"
 
 namespace engiX
 {
+    // First contact between the particles of 2 actors, A < B
+    struct ActorContact
+    {
+        ActorContact(_In_ ActorID a, _In_ ActorID b, _In_ real time) : A(a), B(b), Time(time) {}
+        ActorID A;
+        ActorID B;
+        real Time; // simulation time of impact, see GameLogic::SimulationTime
+    };
+
     class GameLogic
     {
     public:
         typedef std::unordered_map<ActorID, ActorUniquePtr> ActorRegistry;
 
-        GameLogic() : m_pView(nullptr) {}
+        static const real DefaultFixedTimeStep;
+        static const unsigned DefaultMaxSubsteps = 5;
+        static const real DefaultMaxFrameTime;
+
+        GameLogic();
         virtual ~GameLogic();
         virtual void OnUpdate(_In_ const Timer& time);
         virtual bool Init();
@@ -25,18 +50,89 @@ namespace engiX
         Actor& GetActor(_In_ ActorID id);
         Actor& GetActor(_In_ const wchar_t* pName);
         ParticleForceRegistry& ForceRegistry() { return m_forceRegistry; }
+        TransformAnimator& Animator() { return m_animator; }
+        // Transforms whose matrix needs to be rebuilt, flushed at the end of each update
+        TransformBatch& Transforms() { return m_transformBatch; }
+        ParticleIntegrator& Integrator() { return m_integrator; }
+        SpatialHashBroadphase& Broadphase() { return m_broadphase; }
+        // Contacts found during the steps simulated in the last frame sorted by time of impact, at most one
+        // per actors pair. Particles are swept over each step so fast movers do not tunnel through thin targets
+        const std::vector<ActorContact>& Contacts() const { return m_contacts; }
+        // Ray and volume queries over the particles bounding spheres as of the last simulated step
+        const AabbTree& QueryTree() const { return m_queryTree; }
+        // Hitscan rays against the particles, see ParticleRaycaster. Only call them between the frame updates
+        bool Raycast(_In_ const RaycastRay& ray, _Out_ RaycastHit& hit) const { return ParticleRaycaster::Raycast(m_queryTree, m_integrator, ray, hit); }
+        size_t RaycastAll(_In_ const RaycastRay& ray, _Out_ std::vector<RaycastHit>& hits) const { return ParticleRaycaster::RaycastAll(m_queryTree, m_integrator, ray, hits); }
+        size_t RaycastBatch(_In_ const RaycastRay* pRays, _In_ size_t count, _Out_ RaycastHit* pHits) { return ParticleRaycaster::RaycastBatch(m_queryTree, m_integrator, m_workers, pRays, count, pHits); }
+        ParticleContactResolver& ContactResolver() { return m_contactResolver; }
+        // Ropes, chains and cloth, solved right after the particles are integrated
+        ParticleConstraintSolver& ConstraintSolver() { return m_constraintSolver; }
+        WorkerPool& Workers() { return m_workers; }
+        // Resting particles are put to sleep and skipped by the simulation until something wakes them up
+        ParticleIslands& Islands() { return m_islands; }
+        // Particles inside a kill volume are destroyed at the end of the frame physics update, particles
+        // entering and exiting trigger volumes are reported through ActorEnteredVolumeEvt and ActorExitedVolumeEvt
+        ParticleVolumes& Volumes() { return m_volumes; }
+
+        // Fixed step simulation clock
+        // Physics advances in steps of FixedTimeStep seconds regardless of the frame rate, the frame time is
+        // accumulated and consumed by up to MaxSubsteps steps per frame. Frames longer than MaxFrameTime are
+        // clamped and the time the simulation could not catch up with is dropped, this avoids the spiral of death
+        // where each frame takes longer to simulate than the last one.
+        real FixedTimeStep() const { return m_fixedTimeStep; }
+        void FixedTimeStep(_In_ real seconds) { m_fixedTimeStep = seconds; }
+        unsigned MaxSubsteps() const { return m_maxSubsteps; }
+        void MaxSubsteps(_In_ unsigned count) { m_maxSubsteps = count; }
+        real MaxFrameTime() const { return m_maxFrameTime; }
+        void MaxFrameTime(_In_ real seconds) { m_maxFrameTime = seconds; }
+        unsigned LastFrameSubsteps() const { return m_lastFrameSubsteps; }
+        // Fraction of a step the accumulator is ahead of the last simulated state, in [0, 1), used to
+        // interpolate between the last 2 simulated states, see TransformCmpt::InterpolatedTransform
+        real InterpolationAlpha() const { return m_interpolationAlpha; }
+        // Total simulated time in seconds
+        real SimulationTime() const { return m_simulationTime; }
 
     protected:
         virtual bool LoadLevel() = 0;
         bool AddInitActor(_In_ ActorUniquePtr pActor);
         bool RemoveActor(_In_ ActorID);
+        void UpdatePhysics(_In_ const Timer& time);
+        void StepPhysics(_In_ real dt);
+        void DetectCollisions(_In_ real dt);
+        void UpdateQueryTree();
+        void RemoveKilledActors();
 
         TaskManager m_taskMgr;
 
     private:
+        WorkerPool m_workers;
         ActorRegistry m_actors;
         IGameView* m_pView;
         std::set<ActorID> m_deadActors;
         ParticleForceRegistry m_forceRegistry;
+        TransformAnimator m_animator;
+        TransformBatch m_transformBatch;
+        ParticleIntegrator m_integrator;
+        SpatialHashBroadphase m_broadphase;
+        RealArray m_sweptX;
+        RealArray m_sweptY;
+        RealArray m_sweptZ;
+        RealArray m_sweptRadius;
+        std::vector<ActorContact> m_contacts;
+        std::unordered_set<unsigned long long> m_contactPairs;
+        ParticleContactResolver m_contactResolver;
+        ParticleConstraintSolver m_constraintSolver;
+        ParticleIslands m_islands;
+        ParticleVolumes m_volumes;
+        std::vector<ActorID> m_killedActors;
+        AabbTree m_queryTree;
+        std::vector<AabbProxy> m_slotProxies;
+        real m_fixedTimeStep;
+        unsigned m_maxSubsteps;
+        real m_maxFrameTime;
+        real m_physicsAccumulator;
+        real m_interpolationAlpha;
+        real m_simulationTime;
+        unsigned m_lastFrameSubsteps;
     };
 }
\ No newline at end of file
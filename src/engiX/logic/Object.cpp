@@ -2,30 +2,90 @@
 #include "Logger.h"
 #include "engiXDefs.h"
 #include <unordered_set>
+#if defined(_WIN32)
 #define VC_EXTRALEAN
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <cstdlib>
+#endif
 
 using namespace engiX;
 using namespace std;
 
-HANDLE g_hHeap = NULL;
 unordered_set<Object*>* g_pAliveObjects = nullptr;
 size_t g_AliveObjectsUsedMem = 0;
 
+#if defined(_WIN32)
+HANDLE g_hHeap = NULL;
+
+static bool IsPoolCreated() { return NULL != g_hHeap; }
+
+static void CreatePool()
+{
+    g_hHeap = HeapCreate(HEAP_NO_SERIALIZE | HEAP_GENERATE_EXCEPTIONS, 0 , 0);
+    _ASSERTE(NULL != g_hHeap);
+}
+
+static void DestroyPool()
+{
+    (void)HeapDestroy(g_hHeap);
+    g_hHeap = NULL;
+}
+
+static void* PoolAlloc(_In_ size_t sz, _Out_ size_t& blockSize)
+{
+    void* pMem = HeapAlloc(g_hHeap, 0, sz);
+    blockSize = HeapSize(g_hHeap, 0, pMem);
+    return pMem;
+}
+
+static size_t PoolFree(_In_ void* pMem)
+{
+    size_t blockSize = HeapSize(g_hHeap, 0, pMem);
+    (void)HeapFree(g_hHeap, 0, pMem);
+    return blockSize;
+}
+#else
+// There is no private heap off Windows, the blocks come from the CRT heap with their size stored in front of them
+static const size_t BlockHeaderSize = sizeof(max_align_t);
+bool g_isPoolCreated = false;
+
+static bool IsPoolCreated() { return g_isPoolCreated; }
+static void CreatePool() { g_isPoolCreated = true; }
+static void DestroyPool() { g_isPoolCreated = false; }
+
+static void* PoolAlloc(_In_ size_t sz, _Out_ size_t& blockSize)
+{
+    blockSize = BlockHeaderSize + sz;
+    char* pBlock = (char*)malloc(blockSize);
+    _ASSERTE(pBlock);
+    *(size_t*)pBlock = blockSize;
+    return pBlock + BlockHeaderSize;
+}
+
+static size_t PoolFree(_In_ void* pMem)
+{
+    char* pBlock = (char*)pMem - BlockHeaderSize;
+    size_t blockSize = *(size_t*)pBlock;
+    free(pBlock);
+    return blockSize;
+}
+#endif
+//////////////////////////////////////////////////////////////////////////
 void* Object::Alloc(std::size_t sz)
 {
-    if (NULL == g_hHeap)
+    if (!IsPoolCreated())
     {
-        g_hHeap = HeapCreate(HEAP_NO_SERIALIZE | HEAP_GENERATE_EXCEPTIONS, 0 , 0);
-        _ASSERTE(NULL != g_hHeap);
+        CreatePool();
 
 		if (nullptr == g_pAliveObjects)
 			g_pAliveObjects = new unordered_set<Object*>;
     }
 
-    void* pMem = HeapAlloc(g_hHeap, 0, sz);
-    g_AliveObjectsUsedMem += HeapSize(g_hHeap, 0, pMem);
+    size_t blockSize;
+    void* pMem = PoolAlloc(sz, blockSize);
+    g_AliveObjectsUsedMem += blockSize;
 	g_pAliveObjects->insert((Object*)pMem);
 
     return pMem;
@@ -34,13 +94,12 @@ void* Object::Alloc(std::size_t sz)
 void Object::Free(void* pMem)
 {
 	g_pAliveObjects->erase((Object*)pMem);
-    g_AliveObjectsUsedMem -= HeapSize(g_hHeap, 0, pMem);
-    (void)HeapFree(g_hHeap, 0, pMem);
+    g_AliveObjectsUsedMem -= PoolFree(pMem);
 }
 //////////////////////////////////////////////////////////////////////////
 void Object::FreeMemoryPool()
 {
-    if (g_hHeap)
+    if (IsPoolCreated())
     {
         LogInfo("Freeing EngineObject memory pool");
 
@@ -60,8 +119,7 @@ void Object::FreeMemoryPool()
             _ASSERTE(g_pAliveObjects->empty());
         }
 
-        (void)HeapDestroy(g_hHeap);
-        g_hHeap = NULL;
+        DestroyPool();
 
         SAFE_DELETE(g_pAliveObjects);
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <crtdefs.h>
+#include <cstddef>
 
 namespace engiX
 {
@@ -0,0 +1,503 @@
+#include <algorithm>
+#include "ParticleConstraintSolver.h"
+#include "ParticlePhysicsCmpt.h"
+#include "TransformCmpt.h"
+#include "Logger.h"
+
+using namespace engiX;
+using namespace std;
+
+const real ParticleConstraintSolver::DefaultJacobiRelaxation = 1.5f;
+
+// Constraints and particles per worker task in the Jacobi passes
+static const size_t MinConstraintsPerTask = 256;
+static const size_t MinParticlesPerTask = 256;
+
+// Gradient of each constraint with respect to its particles, as a scale of the constraint direction
+static const real Gradients[3][3] =
+{
+    { 1.0f, -1.0f, 0.0f },                      // Distance
+    { 1.0f, 0.0f, 0.0f },                       // Anchor
+    { -1.0f / 3.0f, 2.0f / 3.0f, -1.0f / 3.0f } // Bending
+};
+
+ParticleConstraintSolver::ParticleConstraintSolver() :
+    m_solver(SOLVER_GaussSeidel),
+    m_iterations(DefaultIterations),
+    m_jacobiRelaxation(DefaultJacobiRelaxation),
+    m_lastId(NullParticleConstraintID),
+    m_isTopologyDirty(false)
+{
+}
+
+ParticleConstraintID ParticleConstraintSolver::AddDistance(_In_ Actor& actorA, _In_ Actor& actorB, _In_ real restLength, _In_ real compliance)
+{
+    Actor* actors[] = { &actorA, &actorB };
+    return AddConstraint(CONSTRAINT_Distance, actors, 2, Vec3(0.0f, 0.0f, 0.0f), restLength, compliance);
+}
+
+ParticleConstraintID ParticleConstraintSolver::AddAnchor(_In_ Actor& actor, _In_ const Vec3& anchor, _In_ real restLength, _In_ real compliance)
+{
+    Actor* actors[] = { &actor };
+    return AddConstraint(CONSTRAINT_Anchor, actors, 1, anchor, restLength, compliance);
+}
+
+ParticleConstraintID ParticleConstraintSolver::AddBending(_In_ Actor& actorA, _In_ Actor& actorB, _In_ Actor& actorC, _In_ real compliance)
+{
+    Actor* actors[] = { &actorA, &actorB, &actorC };
+
+    // The particles may not be bound to the integrator yet, their transform holds their position either way
+    Vec3 posA = actorA.Get<TransformCmpt>().Position();
+    Vec3 posB = actorB.Get<TransformCmpt>().Position();
+    Vec3 posC = actorC.Get<TransformCmpt>().Position();
+    real dx = posB.x - (posA.x + posB.x + posC.x) / 3.0f;
+    real dy = posB.y - (posA.y + posB.y + posC.y) / 3.0f;
+    real dz = posB.z - (posA.z + posB.z + posC.z) / 3.0f;
+
+    return AddConstraint(CONSTRAINT_Bending, actors, 3, Vec3(0.0f, 0.0f, 0.0f), real_sqrt(dx * dx + dy * dy + dz * dz), compliance);
+}
+
+ParticleConstraintID ParticleConstraintSolver::AddConstraint(_In_ ConstraintType type, _In_ Actor** ppActors, _In_ unsigned actorCount,
+    _In_ const Vec3& anchor, _In_ real restLength, _In_ real compliance)
+{
+    _ASSERTE(actorCount <= MaxConstraintParticles);
+
+    Constraint constraint;
+    constraint.Type = type;
+    constraint.ParticleCount = actorCount;
+    constraint.Anchor = anchor;
+    constraint.RestLength = restLength;
+    constraint.Compliance = compliance;
+    constraint.Lambda = 0.0f;
+    constraint.IsWakeRequested = true;
+
+    for (unsigned i = 0; i < actorCount; ++i)
+    {
+        Actor& actor = *ppActors[i];
+
+        if (!actor.HasA<ParticlePhysicsCmpt>())
+        {
+            LogError("Actor %s[%d] has no particle, constraint ignored", actor.Typename(), actor.Id());
+            return NullParticleConstraintID;
+        }
+
+        constraint.Slots[i] = actor.Get<ParticlePhysicsCmpt>().Slot();
+        constraint.Actors[i] = actor.Id();
+    }
+
+    constraint.Id = ++m_lastId;
+    m_constraints.push_back(constraint);
+    m_isTopologyDirty = true;
+
+    return constraint.Id;
+}
+
+bool ParticleConstraintSolver::RemoveConstraint(_In_ ParticleConstraintID constraintId)
+{
+    for (auto where = m_constraints.begin(); where != m_constraints.end(); ++where)
+    {
+        if (where->Id == constraintId)
+        {
+            m_constraints.erase(where);
+            m_isTopologyDirty = true;
+            return true;
+        }
+    }
+
+    LogWarning("Constraint[%d] does not exist, call has no effect", constraintId);
+    return false;
+}
+
+bool ParticleConstraintSolver::MoveAnchor(_In_ ParticleConstraintID constraintId, _In_ const Vec3& anchor)
+{
+    for (auto& constraint : m_constraints)
+    {
+        if (constraint.Id == constraintId && constraint.Type == CONSTRAINT_Anchor)
+        {
+            constraint.Anchor = anchor;
+            constraint.IsWakeRequested = true;
+            return true;
+        }
+    }
+
+    LogWarning("Anchor constraint[%d] does not exist, call has no effect", constraintId);
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// A constraint dies with any of its particles: the slot is freed, or recycled by another actor. A slot allocated to
+// an actor that is not initialized yet has no actor bound and is kept.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleConstraintSolver::RemoveDeadConstraints(_In_ const ParticleIntegrator& integrator)
+{
+    auto isDead = [&](const Constraint& constraint) {
+        for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+        {
+            ParticleSlot slot = constraint.Slots[i];
+            ActorID actorId = integrator.SlotActor(slot);
+
+            if (integrator.Owner(slot) == nullptr || (actorId != NullActorID && actorId != constraint.Actors[i]))
+                return true;
+        }
+
+        return false;
+    };
+
+    auto newEnd = remove_if(m_constraints.begin(), m_constraints.end(), isDead);
+
+    if (newEnd != m_constraints.end())
+    {
+        LogVerbose("Removing %d constraints of destroyed particles", (int)(m_constraints.end() - newEnd));
+        m_constraints.erase(newEnd, m_constraints.end());
+        m_isTopologyDirty = true;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// A constraint is active when one of its particles is movable and awake, its sleeping particles are then woken up.
+// Passes repeat until no particle is woken up so that particles bound together wake up as a whole.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleConstraintSolver::WakeBoundParticles(_In_ ParticleIntegrator& integrator)
+{
+    const real* pInvMass = integrator.InverseMass();
+    bool isAnyWoken;
+
+    m_isActive.assign(m_constraints.size(), 0);
+
+    do
+    {
+        isAnyWoken = false;
+
+        for (size_t c = 0; c < m_constraints.size(); ++c)
+        {
+            Constraint& constraint = m_constraints[c];
+
+            if (m_isActive[c])
+                continue;
+
+            bool isActive = false;
+
+            for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+            {
+                ParticleSlot slot = constraint.Slots[i];
+
+                if (pInvMass[slot] > 0.0f && (integrator.IsAwake(slot) || constraint.IsWakeRequested))
+                    isActive = true;
+            }
+
+            if (!isActive)
+                continue;
+
+            m_isActive[c] = 1;
+            constraint.IsWakeRequested = false;
+
+            // Like contacts, binding keeps the sleep time, see ParticleIslands
+            for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+            {
+                ParticleSlot slot = constraint.Slots[i];
+
+                if (pInvMass[slot] > 0.0f && !integrator.IsAwake(slot))
+                {
+                    integrator.Wake(slot, false);
+                    isAnyWoken = true;
+                }
+            }
+        }
+    } while (isAnyWoken);
+}
+
+void ParticleConstraintSolver::BuildTopology()
+{
+    m_particles.clear();
+    m_links.clear();
+
+    for (auto& constraint : m_constraints)
+    {
+        for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+        {
+            m_particles.push_back(constraint.Slots[i]);
+
+            if (i > 0)
+                m_links.push_back(ParticleLink(constraint.Slots[i - 1], constraint.Slots[i]));
+        }
+    }
+
+    sort(m_particles.begin(), m_particles.end());
+    m_particles.erase(unique(m_particles.begin(), m_particles.end()), m_particles.end());
+
+    // Counting sort of the constraints terms by particle
+    m_particleStart.assign(m_particles.size() + 1, 0);
+
+    for (auto& constraint : m_constraints)
+    {
+        for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+            ++m_particleStart[lower_bound(m_particles.begin(), m_particles.end(), constraint.Slots[i]) - m_particles.begin() + 1];
+    }
+
+    for (size_t p = 1; p < m_particleStart.size(); ++p)
+        m_particleStart[p] += m_particleStart[p - 1];
+
+    vector<size_t> nextIdx(m_particleStart.begin(), m_particleStart.end() - 1);
+    m_terms.resize(m_particleStart.back());
+
+    for (size_t c = 0; c < m_constraints.size(); ++c)
+    {
+        const Constraint& constraint = m_constraints[c];
+
+        for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+        {
+            size_t p = lower_bound(m_particles.begin(), m_particles.end(), constraint.Slots[i]) - m_particles.begin();
+            ParticleTerm& term = m_terms[nextIdx[p]++];
+            term.ConstraintIdx = unsigned(c);
+            term.Gradient = Gradients[constraint.Type][i];
+        }
+    }
+
+    m_corrections.resize(m_constraints.size());
+    m_isTopologyDirty = false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Error and unit direction of the constraint, the gradient with respect to particle i is Gradients[type][i] times
+// the direction. Returns false for a degenerate direction, e.g 2 particles on top of each other.
+//---------------------------------------------------------------------------------------------------------------------
+bool ParticleConstraintSolver::Evaluate(_In_ const ParticleIntegrator& integrator, _In_ const Constraint& constraint, _Out_ real& error, _Out_ Vec3& direction) const
+{
+    const real* pPosX = integrator.PositionX();
+    const real* pPosY = integrator.PositionY();
+    const real* pPosZ = integrator.PositionZ();
+    const ParticleSlot* pSlots = constraint.Slots;
+    real dx, dy, dz;
+
+    switch (constraint.Type)
+    {
+    case CONSTRAINT_Distance:
+        dx = pPosX[pSlots[0]] - pPosX[pSlots[1]];
+        dy = pPosY[pSlots[0]] - pPosY[pSlots[1]];
+        dz = pPosZ[pSlots[0]] - pPosZ[pSlots[1]];
+        break;
+    case CONSTRAINT_Anchor:
+        dx = pPosX[pSlots[0]] - constraint.Anchor.x;
+        dy = pPosY[pSlots[0]] - constraint.Anchor.y;
+        dz = pPosZ[pSlots[0]] - constraint.Anchor.z;
+        break;
+    default:
+        // Middle particle relative to the centroid
+        dx = pPosX[pSlots[1]] - (pPosX[pSlots[0]] + pPosX[pSlots[1]] + pPosX[pSlots[2]]) / 3.0f;
+        dy = pPosY[pSlots[1]] - (pPosY[pSlots[0]] + pPosY[pSlots[1]] + pPosY[pSlots[2]]) / 3.0f;
+        dz = pPosZ[pSlots[1]] - (pPosZ[pSlots[0]] + pPosZ[pSlots[1]] + pPosZ[pSlots[2]]) / 3.0f;
+        break;
+    }
+
+    real length = real_sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (length <= real_epsilon)
+        return false;
+
+    error = length - constraint.RestLength;
+    direction = Vec3(dx / length, dy / length, dz / length);
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// XPBD multiplier update: dLambda = (-C - alpha * lambda) / (sum(w * |grad|^2) + alpha), where alpha is the
+// compliance over dt^2. Particle i then moves by w * grad_i * dLambda.
+//---------------------------------------------------------------------------------------------------------------------
+real ParticleConstraintSolver::SolveMultiplier(_In_ const ParticleIntegrator& integrator, _In_ Constraint& constraint, _In_ real error, _In_ real invDtSq) const
+{
+    const real* pInvMass = integrator.InverseMass();
+    const real* pGradients = Gradients[constraint.Type];
+    real weight = 0.0f;
+
+    for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+        weight += pInvMass[constraint.Slots[i]] * pGradients[i] * pGradients[i];
+
+    real alpha = constraint.Compliance * invDtSq;
+
+    if (weight + alpha <= 0.0f)
+        return 0.0f;
+
+    real deltaLambda = (-error - alpha * constraint.Lambda) / (weight + alpha);
+    constraint.Lambda += deltaLambda;
+
+    return deltaLambda;
+}
+
+void ParticleConstraintSolver::SolveGaussSeidel(_In_ ParticleIntegrator& integrator, _In_ real invDtSq)
+{
+    real* pPosX = integrator.PositionX();
+    real* pPosY = integrator.PositionY();
+    real* pPosZ = integrator.PositionZ();
+    const real* pInvMass = integrator.InverseMass();
+
+    for (unsigned iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        for (size_t c = 0; c < m_constraints.size(); ++c)
+        {
+            Constraint& constraint = m_constraints[c];
+            real error;
+            Vec3 n;
+
+            if (!m_isActive[c] || !Evaluate(integrator, constraint, error, n))
+                continue;
+
+            real deltaLambda = SolveMultiplier(integrator, constraint, error, invDtSq);
+            const real* pGradients = Gradients[constraint.Type];
+
+            for (unsigned i = 0; i < constraint.ParticleCount; ++i)
+            {
+                ParticleSlot slot = constraint.Slots[i];
+                real scale = pInvMass[slot] * pGradients[i] * deltaLambda;
+
+                pPosX[slot] += n.x * scale;
+                pPosY[slot] += n.y * scale;
+                pPosZ[slot] += n.z * scale;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// The first pass writes the correction of each constraint and the second one sums the corrections per particle, so
+// neither writes what another task reads or writes.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleConstraintSolver::SolveJacobi(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers, _In_ real invDtSq)
+{
+    real* pPosX = integrator.PositionX();
+    real* pPosY = integrator.PositionY();
+    real* pPosZ = integrator.PositionZ();
+    const real* pInvMass = integrator.InverseMass();
+
+    for (unsigned iteration = 0; iteration < m_iterations; ++iteration)
+    {
+        workers.ParallelFor(m_constraints.size(), MinConstraintsPerTask, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c)
+            {
+                Constraint& constraint = m_constraints[c];
+                real error;
+                Vec3 n;
+
+                if (!m_isActive[c] || !Evaluate(integrator, constraint, error, n))
+                {
+                    m_corrections[c] = Vec3(0.0f, 0.0f, 0.0f);
+                    continue;
+                }
+
+                real deltaLambda = SolveMultiplier(integrator, constraint, error, invDtSq);
+                m_corrections[c] = Vec3(n.x * deltaLambda, n.y * deltaLambda, n.z * deltaLambda);
+            }
+        });
+
+        workers.ParallelFor(m_particles.size(), MinParticlesPerTask, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p)
+            {
+                ParticleSlot slot = m_particles[p];
+
+                if (pInvMass[slot] <= 0.0f)
+                    continue;
+
+                size_t first = m_particleStart[p];
+                size_t last = m_particleStart[p + 1];
+                real sumX = 0.0f;
+                real sumY = 0.0f;
+                real sumZ = 0.0f;
+
+                for (size_t t = first; t < last; ++t)
+                {
+                    const ParticleTerm& term = m_terms[t];
+                    const Vec3& correction = m_corrections[term.ConstraintIdx];
+
+                    sumX += correction.x * term.Gradient;
+                    sumY += correction.y * term.Gradient;
+                    sumZ += correction.z * term.Gradient;
+                }
+
+                real scale = pInvMass[slot] * m_jacobiRelaxation / real(last - first);
+
+                pPosX[slot] += sumX * scale;
+                pPosY[slot] += sumY * scale;
+                pPosZ[slot] += sumZ * scale;
+            }
+        });
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// The integrator moves the particles with the velocity at the beginning of the step and only then adds the
+// acceleration to it. Rebuilding the velocity from that motion would throw the step acceleration away, gravity
+// included, so the constrained particles are moved again with their integrated velocity: p = p0 + v dt.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleConstraintSolver::PredictPositions(_In_ ParticleIntegrator& integrator, _In_ real dt)
+{
+    real* pPosX = integrator.PositionX();
+    real* pPosY = integrator.PositionY();
+    real* pPosZ = integrator.PositionZ();
+    const real* pVelX = integrator.VelocityX();
+    const real* pVelY = integrator.VelocityY();
+    const real* pVelZ = integrator.VelocityZ();
+    const real* pInvMass = integrator.InverseMass();
+
+    for (auto slot : m_particles)
+    {
+        if (pInvMass[slot] <= 0.0f || !integrator.IsAwake(slot))
+            continue;
+
+        Vec3 prevPos = integrator.PreviousPosition(slot);
+
+        pPosX[slot] = prevPos.x + pVelX[slot] * dt;
+        pPosY[slot] = prevPos.y + pVelY[slot] * dt;
+        pPosZ[slot] = prevPos.z + pVelZ[slot] * dt;
+    }
+}
+
+void ParticleConstraintSolver::UpdateVelocities(_In_ ParticleIntegrator& integrator, _In_ real dt)
+{
+    const real* pPosX = integrator.PositionX();
+    const real* pPosY = integrator.PositionY();
+    const real* pPosZ = integrator.PositionZ();
+    real* pVelX = integrator.VelocityX();
+    real* pVelY = integrator.VelocityY();
+    real* pVelZ = integrator.VelocityZ();
+    const real* pInvMass = integrator.InverseMass();
+    const real invDt = 1.0f / dt;
+
+    for (auto slot : m_particles)
+    {
+        if (pInvMass[slot] <= 0.0f || !integrator.IsAwake(slot))
+            continue;
+
+        Vec3 prevPos = integrator.PreviousPosition(slot);
+
+        pVelX[slot] = (pPosX[slot] - prevPos.x) * invDt;
+        pVelY[slot] = (pPosY[slot] - prevPos.y) * invDt;
+        pVelZ[slot] = (pPosZ[slot] - prevPos.z) * invDt;
+    }
+}
+
+void ParticleConstraintSolver::Solve(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers, _In_ real dt)
+{
+    RemoveDeadConstraints(integrator);
+
+    if (m_isTopologyDirty)
+        BuildTopology();
+
+    if (m_constraints.empty() || dt <= 0.0f)
+        return;
+
+    WakeBoundParticles(integrator);
+
+    for (auto& constraint : m_constraints)
+        constraint.Lambda = 0.0f;
+
+    const real invDtSq = 1.0f / (dt * dt);
+
+    PredictPositions(integrator, dt);
+
+    if (m_solver == SOLVER_Jacobi)
+        SolveJacobi(integrator, workers, invDtSq);
+    else
+        SolveGaussSeidel(integrator, invDtSq);
+
+    UpdateVelocities(integrator, dt);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "Actor.h"
+#include "ParticleIntegrator.h"
+#include "WorkerPool.h"
+
+namespace engiX
+{
+    typedef unsigned ParticleConstraintID;
+    const ParticleConstraintID NullParticleConstraintID = 0;
+
+    // Two particles bound together by a constraint, see ParticleIslands
+    struct ParticleLink
+    {
+        ParticleLink(_In_ ParticleSlot a, _In_ ParticleSlot b) :
+            A(a),
+            B(b)
+        {}
+
+        ParticleSlot A;
+        ParticleSlot B;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleConstraintSolver class
+    //
+    // Position based dynamics constraints between particles, for ropes, chains and cloth. The solver runs right after
+    // the integrator step: the constrained particles are predicted at their start position moved by their integrated
+    // velocity, every iteration projects them back on the constraints, then their velocity is rebuilt from their
+    // motion over the step. A projection never overshoots, so unlike stiff springs the solver stays stable at the
+    // frame dt without substeps.
+    //
+    //  - Distance keeps 2 particles at a rest length
+    //  - Anchor keeps a particle at a rest length from a point in the world, a 0 rest length pins it
+    //  - Bending keeps the middle particle of 3 at its rest distance from their centroid, which resists folding the
+    //    rope or cloth row around it
+    //
+    // Each constraint has a compliance, the inverse of its stiffness: 0 is rigid. Compliance goes through the XPBD
+    // multipliers so that a soft constraint keeps the same stiffness whatever the iteration count and dt.
+    //
+    // Gauss-Seidel projects the constraints one after the other on the calling thread and converges fastest. Jacobi
+    // computes the corrections of all the constraints from the same positions and applies their average to each
+    // particle, both passes run in parallel on the WorkerPool. It needs more iterations and pays off on large cloths.
+    //
+    // Constraints hold their particles by slot and are dropped once one of them is destroyed. Constraints whose
+    // particles all sleep or are immovable are skipped, an awake particle wakes up the particles it is bound to.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleConstraintSolver
+    {
+    public:
+        enum SolverType
+        {
+            SOLVER_GaussSeidel,
+            SOLVER_Jacobi
+        };
+
+        static const unsigned DefaultIterations = 8;
+        static const real DefaultJacobiRelaxation;
+
+        ParticleConstraintSolver();
+
+        ParticleConstraintID AddDistance(_In_ Actor& actorA, _In_ Actor& actorB, _In_ real restLength, _In_ real compliance = 0.0f);
+        ParticleConstraintID AddAnchor(_In_ Actor& actor, _In_ const Vec3& anchor, _In_ real restLength = 0.0f, _In_ real compliance = 0.0f);
+        // The rest shape is the one the particles have when the constraint is added, actorB is the middle particle
+        ParticleConstraintID AddBending(_In_ Actor& actorA, _In_ Actor& actorB, _In_ Actor& actorC, _In_ real compliance = 0.0f);
+        bool RemoveConstraint(_In_ ParticleConstraintID constraintId);
+        bool MoveAnchor(_In_ ParticleConstraintID constraintId, _In_ const Vec3& anchor);
+        size_t ConstraintCount() const { return m_constraints.size(); }
+
+        void Solve(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers, _In_ real dt);
+        // Pairs of particles bound by the constraints, updated by Solve
+        const std::vector<ParticleLink>& Links() const { return m_links; }
+
+        SolverType Solver() const { return m_solver; }
+        void Solver(_In_ SolverType solver) { m_solver = solver; }
+        unsigned Iterations() const { return m_iterations; }
+        void Iterations(_In_ unsigned count) { m_iterations = count; }
+        // Scale of the averaged Jacobi corrections, in [1, 2)
+        real JacobiRelaxation() const { return m_jacobiRelaxation; }
+        void JacobiRelaxation(_In_ real relaxation) { m_jacobiRelaxation = relaxation; }
+
+    protected:
+        static const unsigned MaxConstraintParticles = 3;
+
+        enum ConstraintType
+        {
+            CONSTRAINT_Distance,
+            CONSTRAINT_Anchor,
+            CONSTRAINT_Bending
+        };
+
+        struct Constraint
+        {
+            ParticleConstraintID Id;
+            ConstraintType Type;
+            unsigned ParticleCount;
+            ParticleSlot Slots[MaxConstraintParticles];
+            ActorID Actors[MaxConstraintParticles];
+            Vec3 Anchor;
+            real RestLength;
+            real Compliance;
+            real Lambda; // XPBD multiplier accumulated over the step iterations
+            bool IsWakeRequested;
+        };
+
+        // One constraint acting on a particle, with the particle gradient scale
+        struct ParticleTerm
+        {
+            unsigned ConstraintIdx;
+            real Gradient;
+        };
+
+        ParticleConstraintID AddConstraint(_In_ ConstraintType type, _In_ Actor** ppActors, _In_ unsigned actorCount,
+            _In_ const Vec3& anchor, _In_ real restLength, _In_ real compliance);
+        void RemoveDeadConstraints(_In_ const ParticleIntegrator& integrator);
+        void WakeBoundParticles(_In_ ParticleIntegrator& integrator);
+        void BuildTopology();
+        bool Evaluate(_In_ const ParticleIntegrator& integrator, _In_ const Constraint& constraint, _Out_ real& error, _Out_ Vec3& direction) const;
+        real SolveMultiplier(_In_ const ParticleIntegrator& integrator, _In_ Constraint& constraint, _In_ real error, _In_ real invDtSq) const;
+        void SolveGaussSeidel(_In_ ParticleIntegrator& integrator, _In_ real invDtSq);
+        void SolveJacobi(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers, _In_ real invDtSq);
+        void PredictPositions(_In_ ParticleIntegrator& integrator, _In_ real dt);
+        void UpdateVelocities(_In_ ParticleIntegrator& integrator, _In_ real dt);
+
+    private:
+        SolverType m_solver;
+        unsigned m_iterations;
+        real m_jacobiRelaxation;
+        ParticleConstraintID m_lastId;
+        std::vector<Constraint> m_constraints;
+        std::vector<unsigned char> m_isActive;
+        bool m_isTopologyDirty;
+
+        // Constrained particles by increasing slot, particle i terms are
+        // m_terms[m_particleStart[i], m_particleStart[i + 1])
+        std::vector<ParticleSlot> m_particles;
+        std::vector<size_t> m_particleStart;
+        std::vector<ParticleTerm> m_terms;
+        std::vector<ParticleLink> m_links;
+
+        // Jacobi only, correction of each constraint along its gradient direction
+        std::vector<Vec3> m_corrections;
+    };
+}
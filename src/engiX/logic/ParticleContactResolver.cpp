@@ -0,0 +1,271 @@
+#include "ParticleContactResolver.h"
+
+using namespace engiX;
+using namespace std;
+
+const real ParticleContactResolver::RestitutionThreshold = 1.0f;
+const real ParticleContactResolver::PenetrationSlop = 0.01f;
+const real ParticleContactResolver::PositionCorrection = 0.8f;
+
+// Contacts per worker task, smaller colors are solved on the calling thread
+static const size_t MinContactsPerTask = 256;
+
+ParticleContactResolver::ParticleContactResolver() :
+    m_velocityIterations(DefaultVelocityIterations),
+    m_positionIterations(DefaultPositionIterations)
+{
+}
+
+void ParticleContactResolver::GenerateContacts(_In_ ParticleIntegrator& integrator, _In_ const std::vector<BroadphasePair>& pairs)
+{
+    const real* pPosX = integrator.PositionX();
+    const real* pPosY = integrator.PositionY();
+    const real* pPosZ = integrator.PositionZ();
+    const real* pVelX = integrator.VelocityX();
+    const real* pVelY = integrator.VelocityY();
+    const real* pVelZ = integrator.VelocityZ();
+    const real* pRadius = integrator.Radius();
+    const real* pInvMass = integrator.InverseMass();
+
+    m_uncolored.clear();
+
+    for (auto& pair : pairs)
+    {
+        ParticleSlot a = pair.A;
+        ParticleSlot b = pair.B;
+
+        if (!integrator.ContactResponse(a) || !integrator.ContactResponse(b) ||
+            pInvMass[a] + pInvMass[b] <= 0.0f)
+            continue;
+
+        // Sleeping particles at rest against each other or against immovable ones stay that way
+        bool isActiveA = pInvMass[a] > 0.0f && integrator.IsAwake(a);
+        bool isActiveB = pInvMass[b] > 0.0f && integrator.IsAwake(b);
+
+        if (!isActiveA && !isActiveB)
+            continue;
+
+        real dx = pPosX[a] - pPosX[b];
+        real dy = pPosY[a] - pPosY[b];
+        real dz = pPosZ[a] - pPosZ[b];
+        real radiusSum = pRadius[a] + pRadius[b];
+        real distSq = dx * dx + dy * dy + dz * dz;
+
+        if (distSq >= radiusSum * radiusSum)
+            continue;
+
+        ParticleContact contact;
+        contact.A = a;
+        contact.B = b;
+        contact.Impulse = 0.0f;
+
+        // Particles exactly on top of each other get pushed apart along an arbitrary axis
+        real dist = real_sqrt(distSq);
+        contact.Normal = (dist > real_epsilon) ? Vec3(dx / dist, dy / dist, dz / dist) : Vec3(0.0f, 1.0f, 0.0f);
+
+        real approachVelocity =
+            (pVelX[a] - pVelX[b]) * contact.Normal.x +
+            (pVelY[a] - pVelY[b]) * contact.Normal.y +
+            (pVelZ[a] - pVelZ[b]) * contact.Normal.z;
+
+        // Slow contacts do not bounce, otherwise resting particles would jitter
+        real restitution = max(integrator.Restitution(a), integrator.Restitution(b));
+        contact.TargetVelocity = (approachVelocity < -RestitutionThreshold) ? -restitution * approachVelocity : 0.0f;
+
+        m_uncolored.push_back(contact);
+
+        // A particle woken up by a contact keeps its sleep time, see ParticleIslands
+        if (!integrator.IsAwake(a))
+            integrator.Wake(a, false);
+        if (!integrator.IsAwake(b))
+            integrator.Wake(b, false);
+    }
+
+    ColorContacts(integrator);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Each contact takes the lowest color none of its movable particles has used yet. Immovable particles are never
+// written by the solver so they can be shared by any number of contacts of the same color.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleContactResolver::ColorContacts(_In_ const ParticleIntegrator& integrator)
+{
+    const real* pInvMass = integrator.InverseMass();
+
+    m_slotColors.assign(integrator.Capacity(), 0);
+    m_contactColor.resize(m_uncolored.size());
+
+    // One extra color for the sequential batch
+    vector<size_t> colorCount(MaxColors + 1, 0);
+
+    for (size_t i = 0; i < m_uncolored.size(); ++i)
+    {
+        const ParticleContact& contact = m_uncolored[i];
+        bool isMovableA = pInvMass[contact.A] > 0.0f;
+        bool isMovableB = pInvMass[contact.B] > 0.0f;
+        unsigned usedColors = (isMovableA ? m_slotColors[contact.A] : 0) | (isMovableB ? m_slotColors[contact.B] : 0);
+        unsigned color = 0;
+
+        while (color < MaxColors && (usedColors & (1u << color)))
+            ++color;
+
+        if (color < MaxColors)
+        {
+            if (isMovableA)
+                m_slotColors[contact.A] |= (1u << color);
+            if (isMovableB)
+                m_slotColors[contact.B] |= (1u << color);
+        }
+
+        m_contactColor[i] = (unsigned char)color;
+        ++colorCount[color];
+    }
+
+    // Drop the unused colors at the end, keeping the sequential batch last
+    unsigned usedColorCount = MaxColors;
+    while (usedColorCount > 0 && colorCount[usedColorCount - 1] == 0)
+        --usedColorCount;
+
+    m_colorStart.assign(usedColorCount + 2, 0);
+
+    for (unsigned color = 0; color < usedColorCount; ++color)
+        m_colorStart[color + 1] = m_colorStart[color] + colorCount[color];
+
+    m_colorStart[usedColorCount + 1] = m_colorStart[usedColorCount] + colorCount[MaxColors];
+
+    // Stable counting sort by color
+    vector<size_t> nextIdx(m_colorStart.begin(), m_colorStart.end() - 1);
+    m_contacts.resize(m_uncolored.size());
+
+    for (size_t i = 0; i < m_uncolored.size(); ++i)
+    {
+        unsigned color = m_contactColor[i] < MaxColors ? m_contactColor[i] : usedColorCount;
+        m_contacts[nextIdx[color]++] = m_uncolored[i];
+    }
+}
+
+void ParticleContactResolver::Resolve(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers)
+{
+    if (m_contacts.empty())
+        return;
+
+    const size_t sequentialColor = ColorCount() - 1;
+
+    for (unsigned iteration = 0; iteration < m_velocityIterations; ++iteration)
+    {
+        for (size_t color = 0; color < sequentialColor; ++color)
+        {
+            size_t first = m_colorStart[color];
+
+            workers.ParallelFor(m_colorStart[color + 1] - first, MinContactsPerTask, [&](size_t begin, size_t end) {
+                SolveVelocities(integrator, first + begin, first + end);
+            });
+        }
+
+        SolveVelocities(integrator, m_colorStart[sequentialColor], m_colorStart[sequentialColor + 1]);
+    }
+
+    for (unsigned iteration = 0; iteration < m_positionIterations; ++iteration)
+    {
+        for (size_t color = 0; color < sequentialColor; ++color)
+        {
+            size_t first = m_colorStart[color];
+
+            workers.ParallelFor(m_colorStart[color + 1] - first, MinContactsPerTask, [&](size_t begin, size_t end) {
+                SolvePositions(integrator, first + begin, first + end);
+            });
+        }
+
+        SolvePositions(integrator, m_colorStart[sequentialColor], m_colorStart[sequentialColor + 1]);
+    }
+}
+
+void ParticleContactResolver::SolveVelocities(_In_ ParticleIntegrator& integrator, _In_ size_t begin, _In_ size_t end)
+{
+    real* pVelX = integrator.VelocityX();
+    real* pVelY = integrator.VelocityY();
+    real* pVelZ = integrator.VelocityZ();
+    const real* pInvMass = integrator.InverseMass();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        ParticleContact& contact = m_contacts[i];
+        ParticleSlot a = contact.A;
+        ParticleSlot b = contact.B;
+        const Vec3& n = contact.Normal;
+        real invMassA = pInvMass[a];
+        real invMassB = pInvMass[b];
+
+        real separatingVelocity =
+            (pVelX[a] - pVelX[b]) * n.x +
+            (pVelY[a] - pVelY[b]) * n.y +
+            (pVelZ[a] - pVelZ[b]) * n.z;
+
+        real impulse = (contact.TargetVelocity - separatingVelocity) / (invMassA + invMassB);
+
+        // The accumulated impulse can only push, a later iteration can take back what an earlier one gave
+        real accumulated = max(contact.Impulse + impulse, 0.0f);
+        impulse = accumulated - contact.Impulse;
+        contact.Impulse = accumulated;
+
+        // Immovable particles are shared between the contacts of a color, see ColorContacts
+        if (invMassA > 0.0f)
+        {
+            pVelX[a] += n.x * impulse * invMassA;
+            pVelY[a] += n.y * impulse * invMassA;
+            pVelZ[a] += n.z * impulse * invMassA;
+        }
+
+        if (invMassB > 0.0f)
+        {
+            pVelX[b] -= n.x * impulse * invMassB;
+            pVelY[b] -= n.y * impulse * invMassB;
+            pVelZ[b] -= n.z * impulse * invMassB;
+        }
+    }
+}
+
+void ParticleContactResolver::SolvePositions(_In_ ParticleIntegrator& integrator, _In_ size_t begin, _In_ size_t end)
+{
+    real* pPosX = integrator.PositionX();
+    real* pPosY = integrator.PositionY();
+    real* pPosZ = integrator.PositionZ();
+    const real* pInvMass = integrator.InverseMass();
+    const real* pRadius = integrator.Radius();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const ParticleContact& contact = m_contacts[i];
+        ParticleSlot a = contact.A;
+        ParticleSlot b = contact.B;
+
+        // Penetration along the contact normal as of the current positions
+        real dx = pPosX[a] - pPosX[b];
+        real dy = pPosY[a] - pPosY[b];
+        real dz = pPosZ[a] - pPosZ[b];
+        const Vec3& n = contact.Normal;
+        real penetration = pRadius[a] + pRadius[b] - (dx * n.x + dy * n.y + dz * n.z);
+
+        if (penetration <= PenetrationSlop)
+            continue;
+
+        real invMassA = pInvMass[a];
+        real invMassB = pInvMass[b];
+        real correction = PositionCorrection * (penetration - PenetrationSlop) / (invMassA + invMassB);
+
+        // Immovable particles are shared between the contacts of a color, see ColorContacts
+        if (invMassA > 0.0f)
+        {
+            pPosX[a] += n.x * correction * invMassA;
+            pPosY[a] += n.y * correction * invMassA;
+            pPosZ[a] += n.z * correction * invMassA;
+        }
+
+        if (invMassB > 0.0f)
+        {
+            pPosX[b] -= n.x * correction * invMassB;
+            pPosY[b] -= n.y * correction * invMassB;
+            pPosZ[b] -= n.z * correction * invMassB;
+        }
+    }
+}
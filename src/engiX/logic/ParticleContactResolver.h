@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "ParticleIntegrator.h"
+#include "SpatialHashBroadphase.h"
+#include "WorkerPool.h"
+
+namespace engiX
+{
+    struct ParticleContact
+    {
+        ParticleSlot A;
+        ParticleSlot B;
+        Vec3 Normal;         // from B to A
+        real TargetVelocity; // separating velocity along the normal the impulses aim for
+        real Impulse;        // accumulated over the velocity iterations
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleContactResolver class
+    //
+    // Generates the contacts between overlapping particles that both have contact response enabled and resolves them
+    // with sequential impulses: every velocity iteration applies to each contact the impulse that brings its
+    // separating velocity to the target (restitution times the approach velocity), clamped so that the accumulated
+    // impulse only ever pushes. Position iterations then push the remaining penetration apart.
+    //
+    // Contacts are partitioned by greedy graph coloring: no 2 contacts of the same color share a movable particle, so
+    // each color is solved in parallel on the WorkerPool without locks. Colors are solved one after the other in a
+    // fixed order and the coloring only depends on the broadphase pairs order, which makes the result independent of
+    // the thread count and scheduling. Contacts that find no free color among MaxColors go to a last batch solved on
+    // the calling thread.
+    //
+    // No contact is generated for a sleeping particle resting on another sleeping or an immovable particle, a sleeping
+    // particle that touches an awake movable one is woken up.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleContactResolver
+    {
+    public:
+        static const unsigned DefaultVelocityIterations = 8;
+        static const unsigned DefaultPositionIterations = 3;
+        static const unsigned MaxColors = 32;
+        static const real RestitutionThreshold;
+        static const real PenetrationSlop;
+        static const real PositionCorrection;
+
+        ParticleContactResolver();
+
+        void GenerateContacts(_In_ ParticleIntegrator& integrator, _In_ const std::vector<BroadphasePair>& pairs);
+        void Resolve(_In_ ParticleIntegrator& integrator, _In_ WorkerPool& workers);
+
+        const std::vector<ParticleContact>& Contacts() const { return m_contacts; }
+        size_t ColorCount() const { return m_colorStart.empty() ? 0 : m_colorStart.size() - 1; }
+        unsigned VelocityIterations() const { return m_velocityIterations; }
+        void VelocityIterations(_In_ unsigned count) { m_velocityIterations = count; }
+        unsigned PositionIterations() const { return m_positionIterations; }
+        void PositionIterations(_In_ unsigned count) { m_positionIterations = count; }
+
+    protected:
+        void ColorContacts(_In_ const ParticleIntegrator& integrator);
+        void SolveVelocities(_In_ ParticleIntegrator& integrator, _In_ size_t begin, _In_ size_t end);
+        void SolvePositions(_In_ ParticleIntegrator& integrator, _In_ size_t begin, _In_ size_t end);
+
+    private:
+        unsigned m_velocityIterations;
+        unsigned m_positionIterations;
+
+        // Contacts sorted by color, color c spans [m_colorStart[c], m_colorStart[c + 1]),
+        // the last color is the sequential batch
+        std::vector<ParticleContact> m_contacts;
+        std::vector<size_t> m_colorStart;
+        std::vector<ParticleContact> m_uncolored;
+        std::vector<unsigned char> m_contactColor;
+        std::vector<unsigned> m_slotColors;
+    };
+}
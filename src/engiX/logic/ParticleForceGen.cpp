@@ -1,15 +1,53 @@
 #include <algorithm>
 #include "ParticleForceGen.h"
 #include "Logger.h"
-#include "TransformCmpt.h"
 #include "ParticlePhysicsCmpt.h"
 
 using namespace std;
 using namespace engiX;
+#if !defined(ENGIX_SIMD_SCALAR)
 using namespace DirectX;
+#endif
 
 ParticleForceGenID ParticleForceGen::m_lastId = 0;
 
+bool ParticleForceGen::AddParticle(_In_ ActorID actorId, _In_ ParticleSlot slot)
+{
+    if (HasParticle(actorId))
+        return false;
+
+    m_particleIndex[actorId] = m_slots.size();
+    m_slots.push_back(slot);
+    m_actorIds.push_back(actorId);
+
+    return true;
+}
+
+bool ParticleForceGen::RemoveParticle(_In_ ActorID actorId)
+{
+    auto where = m_particleIndex.find(actorId);
+
+    if (where == m_particleIndex.end())
+        return false;
+
+    // Swap the last particle into the removed particle place to keep the list dense
+    size_t idx = where->second;
+    size_t last = m_slots.size() - 1;
+
+    if (idx != last)
+    {
+        m_slots[idx] = m_slots[last];
+        m_actorIds[idx] = m_actorIds[last];
+        m_particleIndex[m_actorIds[idx]] = idx;
+    }
+
+    m_slots.pop_back();
+    m_actorIds.pop_back();
+    m_particleIndex.erase(where);
+
+    return true;
+}
+
 ParticleForceGenID ParticleForceRegistry::RegisterGenerator(_In_ std::shared_ptr<ParticleForceGen> pFGen)
 {
     LogVerbose("Registering force generator %s[%d]", pFGen->Typename(), pFGen->Id());
@@ -18,42 +56,124 @@ ParticleForceGenID ParticleForceRegistry::RegisterGenerator(_In_ std::shared_ptr
     return pFGen->Id();
 }
 
-void ParticleForceRegistry::RegisterActorForce(_In_ ActorID actorId, _In_ ParticleForceGenID pfgenId)
+void ParticleForceRegistry::RegisterActorForce(_In_ Actor& actor, _In_ ParticleForceGenID pfgenId)
 {
     _ASSERTE(m_forceRegistry.count(pfgenId) > 0);
-    LogVerbose("Adding actor-force registration {%d, %s[%d]}", actorId, m_forceRegistry.at(pfgenId)->Typename(), pfgenId);
-    m_actorRegistry[actorId].insert(pfgenId);
+    CBR(actor.HasA<ParticlePhysicsCmpt>());
+
+    LogVerbose("Adding actor-force registration {%d, %s[%d]}", actor.Id(), m_forceRegistry.at(pfgenId)->Typename(), pfgenId);
+
+    if (!m_forceRegistry.at(pfgenId)->AddParticle(actor.Id(), actor.Get<ParticlePhysicsCmpt>().Slot()))
+    {
+        LogWarning("Actor[%d] is already registered to force %s[%d]", actor.Id(), m_forceRegistry.at(pfgenId)->Typename(), pfgenId);
+        return;
+    }
+
+    m_actorRegistry[actor.Id()].insert(pfgenId);
+    actor.Get<ParticlePhysicsCmpt>().Wake();
 }
 
 void ParticleForceRegistry::UnregisterActorForce(_In_ ActorID actorId, _In_ ParticleForceGenID fgenId)
 {
-    if (m_actorRegistry.count(actorId) == 0)
+    auto where = m_actorRegistry.find(actorId);
+
+    if (where == m_actorRegistry.end())
     {
         LogError("Actor[%d] does not exist, call has no effect", actorId);
         return;
     }
 
-    auto forces = m_actorRegistry[actorId];
     LogVerbose("Removing actor-force registration {%d, %s[%d]}", actorId, m_forceRegistry.at(fgenId)->Typename(), fgenId);
-    forces.erase(fgenId);
+    m_forceRegistry.at(fgenId)->RemoveParticle(actorId);
+    where->second.erase(fgenId);
+
+    if (where->second.empty())
+        m_actorRegistry.erase(where);
 }
 
-void ParticleAnchoredSpring::ApplyForce(_In_ Actor* pActor, _In_ const Timer& time) const
+//---------------------------------------------------------------------------------------------------------------------
+// Removes all the force registrations of the actor, called by the GameLogic when the actor is destroyed so that no
+// generator keeps applying force on a freed particle slot.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleForceRegistry::UnregisterActor(_In_ ActorID actorId)
+{
+    auto where = m_actorRegistry.find(actorId);
+
+    if (where == m_actorRegistry.end())
+        return;
+
+    for (auto pfgenId : where->second)
+        m_forceRegistry.at(pfgenId)->RemoveParticle(actorId);
+
+    m_actorRegistry.erase(where);
+}
+
+void ParticleForceRegistry::ApplyForces(_In_ ParticleIntegrator& integrator, _In_ real dt) const
+{
+    for (auto& forceGen : m_forceRegistry)
+    {
+        if (forceGen.second->ParticleCount() > 0)
+            forceGen.second->ApplyForce(integrator, dt);
+    }
+}
+
+void ParticleAnchoredSpring::ApplyForce(_In_ ParticleIntegrator& integrator, _In_ real dt) const
 {
     // d = xa - xb; xa is particle end of spring, xb is the anchor end of spring
     // f = -k(|d| - l0)d; l0 is rest length, k is spring constant
-    Vec3 particlePos = pActor->Get<TransformCmpt>().Position();
-    XMVECTOR xa = XMLoadFloat3(&particlePos);
-    XMVECTOR xb = XMLoadFloat3(&m_anchor);
-    XMVECTOR d = XMVectorSubtract(xa, xb);
-    XMVECTOR dLen = XMVector3Length(d);
+    const size_t count = m_slots.size();
+    const ParticleSlot* pSlots = m_slots.data();
+    const real* pPosX = integrator.PositionX();
+    const real* pPosY = integrator.PositionY();
+    const real* pPosZ = integrator.PositionZ();
+    real* pForceX = integrator.ForceX();
+    real* pForceY = integrator.ForceY();
+    real* pForceZ = integrator.ForceZ();
+    const unsigned* pAwake = integrator.Awake();
+    size_t i = 0;
+
+#if !defined(ENGIX_SIMD_SCALAR)
+    // 4 springs at a time, particle slots are scattered in the integrator
+    // arrays so their state is gathered and their force scattered back.
+    // The force scattered to sleeping particles is dropped by the integration
+    const size_t simdCount = count & ~size_t(3);
+    XMVECTOR xbX = XMVectorReplicate(m_anchor.x);
+    XMVECTOR xbY = XMVectorReplicate(m_anchor.y);
+    XMVECTOR xbZ = XMVectorReplicate(m_anchor.z);
     XMVECTOR k = XMVectorReplicate(-m_sprintConst);
     XMVECTOR l0 = XMVectorReplicate(m_restLength);
 
-    Vec3 f;
-    XMStoreFloat3(&f, XMVectorMultiply(d,
-        XMVectorMultiply(k,
-        XMVectorSubtract(dLen, l0))));
+    for (; i < simdCount; i += 4)
+    {
+        if ((pAwake[pSlots[i]] | pAwake[pSlots[i + 1]] | pAwake[pSlots[i + 2]] | pAwake[pSlots[i + 3]]) == 0)
+            continue;
+
+        XMVECTOR dX = XMVectorSubtract(Simd::Gather4(pPosX, pSlots + i), xbX);
+        XMVECTOR dY = XMVectorSubtract(Simd::Gather4(pPosY, pSlots + i), xbY);
+        XMVECTOR dZ = XMVectorSubtract(Simd::Gather4(pPosZ, pSlots + i), xbZ);
+        XMVECTOR dLen = XMVectorSqrt(XMVectorMultiplyAdd(dZ, dZ, XMVectorMultiplyAdd(dY, dY, XMVectorMultiply(dX, dX))));
+        XMVECTOR scale = XMVectorMultiply(k, XMVectorSubtract(dLen, l0));
+
+        Simd::ScatterAdd4(pForceX, pSlots + i, XMVectorMultiply(dX, scale));
+        Simd::ScatterAdd4(pForceY, pSlots + i, XMVectorMultiply(dY, scale));
+        Simd::ScatterAdd4(pForceZ, pSlots + i, XMVectorMultiply(dZ, scale));
+    }
+#endif
 
-    pActor->Get<ParticlePhysicsCmpt>().AddForce(f);
+    for (; i < count; ++i)
+    {
+        ParticleSlot slot = pSlots[i];
+
+        if (pAwake[slot] == 0)
+            continue;
+
+        real dX = pPosX[slot] - m_anchor.x;
+        real dY = pPosY[slot] - m_anchor.y;
+        real dZ = pPosZ[slot] - m_anchor.z;
+        real scale = -m_sprintConst * (real_sqrt(dX * dX + dY * dY + dZ * dZ) - m_restLength);
+
+        pForceX[slot] += dX * scale;
+        pForceY[slot] += dY * scale;
+        pForceZ[slot] += dZ * scale;
+    }
 }
@@ -1,15 +1,24 @@
 #pragma once
 
 #include <set>
+#include <vector>
 #include <unordered_map>
 #include <memory>
 #include "Actor.h"
+#include "ParticleIntegrator.h"
 
 namespace engiX
 {
     typedef unsigned ParticleForceGenID;
     typedef unsigned ParticleForceGenTypeID;
 
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleForceGen class
+    //
+    // A force generator owns the dense list of particles it affects and applies its force to all of them in one batch
+    // per simulation step, directly on the ParticleIntegrator SoA state. Particles are added and removed through the
+    // ParticleForceRegistry, registering a particle to a force wakes it up. Generators skip sleeping particles.
+    //---------------------------------------------------------------------------------------------------------------------
     class ParticleForceGen
     {
     public:
@@ -18,7 +27,18 @@ namespace engiX
         virtual ParticleForceGenID Id() const { return m_id; }
         virtual ParticleForceGenTypeID TypeId() const = 0;
         virtual const wchar_t* Typename() const = 0;
-        virtual void ApplyForce(_In_ Actor* pActor, _In_ const Timer& time) const = 0;
+        virtual void ApplyForce(_In_ ParticleIntegrator& integrator, _In_ real dt) const = 0;
+
+        bool AddParticle(_In_ ActorID actorId, _In_ ParticleSlot slot);
+        bool RemoveParticle(_In_ ActorID actorId);
+        bool HasParticle(_In_ ActorID actorId) const { return m_particleIndex.count(actorId) > 0; }
+        size_t ParticleCount() const { return m_slots.size(); }
+
+    protected:
+        // Dense list of the affected particles integrator slots
+        std::vector<ParticleSlot> m_slots;
+        std::vector<ActorID> m_actorIds;
+        std::unordered_map<ActorID, size_t> m_particleIndex;
 
     private:
         static ParticleForceGenID m_lastId;
@@ -31,16 +51,18 @@ namespace engiX
         typedef std::set<ParticleForceGenID> ForceGenSet;
 
         ParticleForceGenID RegisterGenerator(_In_ std::shared_ptr<ParticleForceGen> pFGen);
-        void RegisterActorForce(_In_ ActorID actorId, _In_ ParticleForceGenID pfgenId);
+        void RegisterActorForce(_In_ Actor& actor, _In_ ParticleForceGenID pfgenId);
         void UnregisterActorForce(_In_ ActorID actorId, _In_ ParticleForceGenID fgenId);
+        void UnregisterActor(_In_ ActorID actorId);
+        void ApplyForces(_In_ ParticleIntegrator& integrator, _In_ real dt) const;
         bool ActorHasForces(_In_ ActorID actorId) const { return m_actorRegistry.count(actorId) > 0; }
         const ForceGenSet& GetActorForces(_In_ ActorID actorId) const { return m_actorRegistry.at(actorId); }
         std::shared_ptr<const ParticleForceGen> GetForceGen(_In_ ParticleForceGenID pfgenId) const { return m_forceRegistry.at(pfgenId); }
 
     protected:
-        typedef std::pair<ParticleForceGenID, ActorID> ForceRegistration;
         typedef std::unordered_map<ParticleForceGenID, std::shared_ptr<ParticleForceGen>> ForceGenRegistry;
         typedef std::unordered_map<ActorID, ForceGenSet> ActorRegistry;
+        // Reverse actor to generators lookup, only used to clean up registrations
         ActorRegistry m_actorRegistry;
         ForceGenRegistry m_forceRegistry;
     };
@@ -57,11 +79,11 @@ namespace engiX
 
         ParticleForceGenTypeID TypeId() const { return TypeID; }
         const wchar_t* Typename() const { return L"ParticleAnchoredSpring"; }
-        void ApplyForce(_In_ Actor* pActor, _In_ const Timer& time) const;
+        void ApplyForce(_In_ ParticleIntegrator& integrator, _In_ real dt) const;
 
     private:
         Vec3 m_anchor;
         real m_restLength;
         real m_sprintConst;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,527 @@
+#include "ParticleIntegrator.h"
+#include "TransformCmpt.h"
+#include "SimdMath.h"
+#include "Logger.h"
+
+using namespace engiX;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+ParticleIntegrator::ParticleIntegrator()
+{
+    // Entry 0 is the no-damping entry, it is never released so that
+    // free slots always reference a valid damping value
+    m_dampingValues.push_back(1.0f);
+    m_dampingRefs.push_back(0);
+
+    for (unsigned layer = 0; layer < MaxCollisionLayers; ++layer)
+        m_layersMatrix[layer] = AllCollisionLayers;
+}
+
+ParticleSlot ParticleIntegrator::Allocate(_In_ ParticlePhysicsCmpt* pOwner)
+{
+    if (m_freeSlots.empty())
+        Grow();
+
+    ParticleSlot slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    m_owners[slot] = pOwner;
+    m_layer[slot] = 0;
+    m_layerMask[slot] = AllCollisionLayers;
+    UpdateCollisionFilter(slot);
+    Wake(slot);
+
+    return slot;
+}
+
+void ParticleIntegrator::Free(_In_ ParticleSlot slot)
+{
+    _ASSERTE(slot < Capacity());
+    _ASSERTE(m_owners[slot] != nullptr);
+
+    ReleaseDamping(m_dampingIdx[slot]);
+
+    // Reset the slot to an immovable particle at rest so that the kernels
+    // mask it out until it gets allocated again
+    m_posX[slot] = m_posY[slot] = m_posZ[slot] = 0.0f;
+    m_prevPosX[slot] = m_prevPosY[slot] = m_prevPosZ[slot] = 0.0f;
+    m_velX[slot] = m_velY[slot] = m_velZ[slot] = 0.0f;
+    m_prevVelX[slot] = m_prevVelY[slot] = m_prevVelZ[slot] = 0.0f;
+    m_accX[slot] = m_accY[slot] = m_accZ[slot] = 0.0f;
+    m_forceX[slot] = m_forceY[slot] = m_forceZ[slot] = 0.0f;
+    m_invMass[slot] = 0.0f;
+    m_radius[slot] = 0.0f;
+    m_dampingIdx[slot] = 0;
+    m_owners[slot] = nullptr;
+    m_transforms[slot] = nullptr;
+    m_actorIds[slot] = NullActorID;
+    m_layer[slot] = 0;
+    m_layerMask[slot] = 0;
+    m_layerBits[slot] = 0;
+    m_collisionFilter[slot] = 0;
+    m_contactResponse[slot] = 0;
+    m_restitution[slot] = 0.0f;
+    m_awake[slot] = 0;
+    m_sleepTime[slot] = 0.0f;
+
+    m_freeSlots.push_back(slot);
+}
+
+void ParticleIntegrator::Bind(_In_ ParticleSlot slot, _In_ ActorID actorId, _In_ TransformCmpt* pTsfm)
+{
+    _ASSERTE(pTsfm);
+
+    m_actorIds[slot] = actorId;
+    m_transforms[slot] = pTsfm;
+    Position(slot, pTsfm->Position());
+}
+
+void ParticleIntegrator::Layer(_In_ ParticleSlot slot, _In_ CollisionLayer layer)
+{
+    _ASSERTE(layer < MaxCollisionLayers);
+
+    m_layer[slot] = layer;
+    UpdateCollisionFilter(slot);
+}
+
+void ParticleIntegrator::LayerMask(_In_ ParticleSlot slot, _In_ unsigned mask)
+{
+    m_layerMask[slot] = mask;
+    UpdateCollisionFilter(slot);
+}
+
+void ParticleIntegrator::LayersCollide(_In_ CollisionLayer layerA, _In_ CollisionLayer layerB, _In_ bool collide)
+{
+    _ASSERTE(layerA < MaxCollisionLayers && layerB < MaxCollisionLayers);
+
+    if (collide)
+    {
+        m_layersMatrix[layerA] |= (1u << layerB);
+        m_layersMatrix[layerB] |= (1u << layerA);
+    }
+    else
+    {
+        m_layersMatrix[layerA] &= ~(1u << layerB);
+        m_layersMatrix[layerB] &= ~(1u << layerA);
+    }
+
+    for (size_t i = 0; i < Capacity(); ++i)
+    {
+        if (m_owners[i] != nullptr)
+            UpdateCollisionFilter(ParticleSlot(i));
+    }
+}
+
+void ParticleIntegrator::UpdateCollisionFilter(_In_ ParticleSlot slot)
+{
+    m_layerBits[slot] = 1u << m_layer[slot];
+    m_collisionFilter[slot] = m_layerMask[slot] & m_layersMatrix[m_layer[slot]];
+}
+
+void ParticleIntegrator::Grow()
+{
+    // Grow by a whole batch so that the capacity stays a multiple of the widest SIMD width
+    size_t oldCapacity = Capacity();
+    size_t newCapacity = oldCapacity + Simd::BatchPadding;
+
+    m_posX.resize(newCapacity, 0.0f);
+    m_posY.resize(newCapacity, 0.0f);
+    m_posZ.resize(newCapacity, 0.0f);
+    m_prevPosX.resize(newCapacity, 0.0f);
+    m_prevPosY.resize(newCapacity, 0.0f);
+    m_prevPosZ.resize(newCapacity, 0.0f);
+    m_velX.resize(newCapacity, 0.0f);
+    m_velY.resize(newCapacity, 0.0f);
+    m_velZ.resize(newCapacity, 0.0f);
+    m_prevVelX.resize(newCapacity, 0.0f);
+    m_prevVelY.resize(newCapacity, 0.0f);
+    m_prevVelZ.resize(newCapacity, 0.0f);
+    m_accX.resize(newCapacity, 0.0f);
+    m_accY.resize(newCapacity, 0.0f);
+    m_accZ.resize(newCapacity, 0.0f);
+    m_forceX.resize(newCapacity, 0.0f);
+    m_forceY.resize(newCapacity, 0.0f);
+    m_forceZ.resize(newCapacity, 0.0f);
+    m_invMass.resize(newCapacity, 0.0f);
+    m_radius.resize(newCapacity, 0.0f);
+    m_dampingIdx.resize(newCapacity, 0);
+    m_owners.resize(newCapacity, nullptr);
+    m_transforms.resize(newCapacity, nullptr);
+    m_actorIds.resize(newCapacity, NullActorID);
+    m_layer.resize(newCapacity, 0);
+    m_layerMask.resize(newCapacity, 0);
+    m_layerBits.resize(newCapacity, 0);
+    m_collisionFilter.resize(newCapacity, 0);
+    m_contactResponse.resize(newCapacity, 0);
+    m_restitution.resize(newCapacity, 0.0f);
+    m_awake.resize(newCapacity, 0);
+    m_sleepTime.resize(newCapacity, 0.0f);
+
+    // Push the new slots in reverse so that the lowest slot is allocated first,
+    // this keeps the live particles packed at the beginning of the arrays
+    for (size_t slot = newCapacity; slot > oldCapacity; --slot)
+        m_freeSlots.push_back(ParticleSlot(slot - 1));
+}
+
+void ParticleIntegrator::Position(_In_ ParticleSlot slot, _In_ const Vec3& pos)
+{
+    m_posX[slot] = m_prevPosX[slot] = pos.x;
+    m_posY[slot] = m_prevPosY[slot] = pos.y;
+    m_posZ[slot] = m_prevPosZ[slot] = pos.z;
+    Wake(slot);
+}
+
+void ParticleIntegrator::Velocity(_In_ ParticleSlot slot, _In_ const Vec3& vel)
+{
+    m_velX[slot] = vel.x;
+    m_velY[slot] = vel.y;
+    m_velZ[slot] = vel.z;
+    Wake(slot);
+}
+
+void ParticleIntegrator::BaseAcceleration(_In_ ParticleSlot slot, _In_ const Vec3& acc)
+{
+    m_accX[slot] = acc.x;
+    m_accY[slot] = acc.y;
+    m_accZ[slot] = acc.z;
+    Wake(slot);
+}
+
+void ParticleIntegrator::AddForce(_In_ ParticleSlot slot, _In_ const Vec3& force)
+{
+    m_forceX[slot] += force.x;
+    m_forceY[slot] += force.y;
+    m_forceZ[slot] += force.z;
+    Wake(slot);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Stops the particle where it is, it stays masked out of the integration until something wakes it up.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIntegrator::Sleep(_In_ ParticleSlot slot)
+{
+    if (!IsAwake(slot))
+        return;
+
+    m_prevPosX[slot] = m_posX[slot];
+    m_prevPosY[slot] = m_posY[slot];
+    m_prevPosZ[slot] = m_posZ[slot];
+    m_velX[slot] = m_velY[slot] = m_velZ[slot] = 0.0f;
+    m_prevVelX[slot] = m_prevVelY[slot] = m_prevVelZ[slot] = 0.0f;
+    m_forceX[slot] = m_forceY[slot] = m_forceZ[slot] = 0.0f;
+    m_awake[slot] = 0;
+
+    m_fellAsleep.push_back(slot);
+}
+
+void ParticleIntegrator::Damping(_In_ ParticleSlot slot, _In_ real damping)
+{
+    unsigned newIdx = AcquireDamping(damping);
+    ReleaseDamping(m_dampingIdx[slot]);
+    m_dampingIdx[slot] = newIdx;
+}
+
+unsigned ParticleIntegrator::AcquireDamping(_In_ real damping)
+{
+    if (damping == 1.0f)
+        return 0;
+
+    // Games use a handful of damping values, a linear search beats hashing floats
+    unsigned freeIdx = 0;
+    for (unsigned i = 1; i < m_dampingValues.size(); ++i)
+    {
+        if (m_dampingRefs[i] > 0 && m_dampingValues[i] == damping)
+        {
+            ++m_dampingRefs[i];
+            return i;
+        }
+        else if (m_dampingRefs[i] == 0 && freeIdx == 0)
+        {
+            freeIdx = i;
+        }
+    }
+
+    if (freeIdx == 0)
+    {
+        freeIdx = m_dampingValues.size();
+        m_dampingValues.push_back(damping);
+        m_dampingRefs.push_back(1);
+    }
+    else
+    {
+        m_dampingValues[freeIdx] = damping;
+        m_dampingRefs[freeIdx] = 1;
+    }
+
+    return freeIdx;
+}
+
+void ParticleIntegrator::ReleaseDamping(_In_ unsigned dampingIdx)
+{
+    if (dampingIdx == 0)
+        return;
+
+    _ASSERTE(m_dampingRefs[dampingIdx] > 0);
+    --m_dampingRefs[dampingIdx];
+}
+
+void ParticleIntegrator::CalcDampingPowers(_In_ real dt)
+{
+    const size_t count = m_dampingValues.size();
+
+    m_dampingPow.resize(count);
+    Simd::Pow(&m_dampingValues[0], dt, &m_dampingPow[0], count);
+
+    // Slot 0 is the default no damping and the free slots are not read, both stay at 1
+    m_dampingPow[0] = 1.0f;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        if (m_dampingRefs[i] == 0)
+            m_dampingPow[i] = 1.0f;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Integrates all the particles one step forward using the same scheme as the per-actor integration it replaced:
+//  1. p = p0 + v0 t
+//  2. a = a0 + f / m
+//  3. v = (v0 + a t) * damping^t
+//  4. Clear the accumulated force
+// The positions before the step are kept for interpolation, see WriteTransforms(), and the velocities to measure the
+// particles acceleration, see ParticleIslands. Sleeping particles are masked out like immovable ones.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIntegrator::Integrate(_In_ real dt)
+{
+    if (ParticleCount() == 0)
+        return;
+
+    m_prevPosX.assign(m_posX.begin(), m_posX.end());
+    m_prevPosY.assign(m_posY.begin(), m_posY.end());
+    m_prevPosZ.assign(m_posZ.begin(), m_posZ.end());
+    m_prevVelX.assign(m_velX.begin(), m_velX.end());
+    m_prevVelY.assign(m_velY.begin(), m_velY.end());
+    m_prevVelZ.assign(m_velZ.begin(), m_velZ.end());
+
+    CalcDampingPowers(dt);
+
+#if defined(ENGIX_SIMD_AVX)
+    IntegrateAvx(dt);
+#elif defined(ENGIX_SIMD_SCALAR)
+    IntegrateScalar(dt);
+#else
+    IntegrateSse(dt);
+#endif
+}
+
+void ParticleIntegrator::IntegrateScalar(_In_ real dt)
+{
+    const size_t capacity = Capacity();
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        real invMass = m_invMass[i];
+
+        if (invMass <= 0.0f || m_awake[i] == 0)
+        {
+            m_forceX[i] = m_forceY[i] = m_forceZ[i] = 0.0f;
+            continue;
+        }
+
+        real damping = m_dampingPow[m_dampingIdx[i]];
+
+        m_posX[i] += m_velX[i] * dt;
+        m_posY[i] += m_velY[i] * dt;
+        m_posZ[i] += m_velZ[i] * dt;
+
+        m_velX[i] = (m_velX[i] + (m_accX[i] + m_forceX[i] * invMass) * dt) * damping;
+        m_velY[i] = (m_velY[i] + (m_accY[i] + m_forceY[i] * invMass) * dt) * damping;
+        m_velZ[i] = (m_velZ[i] + (m_accZ[i] + m_forceZ[i] * invMass) * dt) * damping;
+
+        m_forceX[i] = m_forceY[i] = m_forceZ[i] = 0.0f;
+    }
+}
+
+#if !defined(ENGIX_SIMD_SCALAR)
+// Integrates one axis of 4 particles
+static inline void XM_CALLCONV IntegrateAxis4(_Inout_ real* pPos, _Inout_ real* pVel, _In_ const real* pAcc, _Inout_ real* pForce,
+    _In_ FXMVECTOR invMass, _In_ FXMVECTOR damping, _In_ FXMVECTOR movable, _In_ GXMVECTOR dt)
+{
+    XMVECTOR p = Simd::Load4(pPos);
+    XMVECTOR v = Simd::Load4(pVel);
+    XMVECTOR a = XMVectorMultiplyAdd(Simd::Load4(pForce), invMass, Simd::Load4(pAcc));
+
+    p = XMVectorSelect(p, XMVectorMultiplyAdd(v, dt, p), movable);
+    v = XMVectorSelect(v, XMVectorMultiply(XMVectorMultiplyAdd(a, dt, v), damping), movable);
+
+    Simd::Store4(pPos, p);
+    Simd::Store4(pVel, v);
+    Simd::Store4(pForce, XMVectorZero());
+}
+
+void ParticleIntegrator::IntegrateSse(_In_ real dt)
+{
+    const size_t capacity = Capacity();
+    const real* pDampingPow = m_dampingPow.data();
+    const unsigned* pDampingIdx = m_dampingIdx.data();
+    XMVECTOR vDt = XMVectorReplicate(dt);
+    XMVECTOR vZero = XMVectorZero();
+
+    for (size_t i = 0; i < capacity; i += 4)
+    {
+        XMVECTOR invMass = Simd::Load4(&m_invMass[i]);
+        XMVECTOR movable = XMVectorAndInt(XMVectorGreater(invMass, vZero), Simd::LoadMask4(&m_awake[i]));
+
+        // Whole batch is free, immovable or sleeping, only the accumulated force needs clearing
+        if (Simd::MoveMask4(movable) == 0)
+        {
+            Simd::Store4(&m_forceX[i], vZero);
+            Simd::Store4(&m_forceY[i], vZero);
+            Simd::Store4(&m_forceZ[i], vZero);
+            continue;
+        }
+
+        XMVECTOR damping = XMVectorSet(
+            pDampingPow[pDampingIdx[i]],
+            pDampingPow[pDampingIdx[i + 1]],
+            pDampingPow[pDampingIdx[i + 2]],
+            pDampingPow[pDampingIdx[i + 3]]);
+
+        IntegrateAxis4(&m_posX[i], &m_velX[i], &m_accX[i], &m_forceX[i], invMass, damping, movable, vDt);
+        IntegrateAxis4(&m_posY[i], &m_velY[i], &m_accY[i], &m_forceY[i], invMass, damping, movable, vDt);
+        IntegrateAxis4(&m_posZ[i], &m_velZ[i], &m_accZ[i], &m_forceZ[i], invMass, damping, movable, vDt);
+    }
+}
+#endif
+
+#if defined(ENGIX_SIMD_AVX)
+// Integrates one axis of 8 particles
+static inline void IntegrateAxis8(_Inout_ real* pPos, _Inout_ real* pVel, _In_ const real* pAcc, _Inout_ real* pForce,
+    _In_ __m256 invMass, _In_ __m256 damping, _In_ __m256 movable, _In_ __m256 dt)
+{
+    __m256 p = _mm256_load_ps(pPos);
+    __m256 v = _mm256_load_ps(pVel);
+    __m256 a = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(pForce), invMass), _mm256_load_ps(pAcc));
+
+    p = _mm256_blendv_ps(p, _mm256_add_ps(_mm256_mul_ps(v, dt), p), movable);
+    v = _mm256_blendv_ps(v, _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(a, dt), v), damping), movable);
+
+    _mm256_store_ps(pPos, p);
+    _mm256_store_ps(pVel, v);
+    _mm256_store_ps(pForce, _mm256_setzero_ps());
+}
+
+void ParticleIntegrator::IntegrateAvx(_In_ real dt)
+{
+    const size_t capacity = Capacity();
+    const real* pDampingPow = m_dampingPow.data();
+    const unsigned* pDampingIdx = m_dampingIdx.data();
+    __m256 vDt = _mm256_set1_ps(dt);
+    __m256 vZero = _mm256_setzero_ps();
+
+    for (size_t i = 0; i < capacity; i += 8)
+    {
+        __m256 invMass = _mm256_load_ps(&m_invMass[i]);
+        __m256 movable = _mm256_and_ps(
+            _mm256_cmp_ps(invMass, vZero, _CMP_GT_OQ),
+            _mm256_load_ps((const float*)&m_awake[i]));
+
+        // Whole batch is free, immovable or sleeping, only the accumulated force needs clearing
+        if (_mm256_movemask_ps(movable) == 0)
+        {
+            _mm256_store_ps(&m_forceX[i], vZero);
+            _mm256_store_ps(&m_forceY[i], vZero);
+            _mm256_store_ps(&m_forceZ[i], vZero);
+            continue;
+        }
+
+        __m256 damping = _mm256_setr_ps(
+            pDampingPow[pDampingIdx[i]],
+            pDampingPow[pDampingIdx[i + 1]],
+            pDampingPow[pDampingIdx[i + 2]],
+            pDampingPow[pDampingIdx[i + 3]],
+            pDampingPow[pDampingIdx[i + 4]],
+            pDampingPow[pDampingIdx[i + 5]],
+            pDampingPow[pDampingIdx[i + 6]],
+            pDampingPow[pDampingIdx[i + 7]]);
+
+        IntegrateAxis8(&m_posX[i], &m_velX[i], &m_accX[i], &m_forceX[i], invMass, damping, movable, vDt);
+        IntegrateAxis8(&m_posY[i], &m_velY[i], &m_accY[i], &m_forceY[i], invMass, damping, movable, vDt);
+        IntegrateAxis8(&m_posZ[i], &m_velZ[i], &m_accZ[i], &m_forceZ[i], invMass, damping, movable, vDt);
+    }
+}
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------
+// Synchronizes the particles with their TransformCmpt, movable particles push their integrated and previous step
+// positions to the transform while immovable ones pull the transform position so that game code can still move
+// them around. Sleeping particles do not move, their transform is written one last time when they fall asleep.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIntegrator::WriteTransforms()
+{
+    const size_t capacity = Capacity();
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        TransformCmpt* pTsfm = m_transforms[i];
+
+        if (pTsfm == nullptr)
+            continue;
+
+        if (m_invMass[i] > 0.0f)
+        {
+            if (m_awake[i] == 0)
+                continue;
+
+            pTsfm->SimulatedPosition(
+                Vec3(m_prevPosX[i], m_prevPosY[i], m_prevPosZ[i]),
+                Vec3(m_posX[i], m_posY[i], m_posZ[i]));
+        }
+        else
+        {
+            Position(ParticleSlot(i), pTsfm->Position());
+        }
+    }
+
+    for (auto slot : m_fellAsleep)
+    {
+        // Slots woken up since then were written above, freed ones have no transform
+        if (m_awake[slot] == 0 && m_transforms[slot] != nullptr)
+            m_transforms[slot]->SimulatedPosition(Position(slot), Position(slot));
+    }
+
+    m_fellAsleep.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Spheres bounding the particles motion over the last step, centered halfway between the previous and the current
+// position. Particles with 0 radius, free slots included, get a 0 radius swept sphere.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIntegrator::SweptSpheres(_Out_ RealArray& centerX, _Out_ RealArray& centerY, _Out_ RealArray& centerZ, _Out_ RealArray& radius) const
+{
+    const size_t capacity = Capacity();
+
+    centerX.resize(capacity);
+    centerY.resize(capacity);
+    centerZ.resize(capacity);
+    radius.resize(capacity);
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        real dx = m_posX[i] - m_prevPosX[i];
+        real dy = m_posY[i] - m_prevPosY[i];
+        real dz = m_posZ[i] - m_prevPosZ[i];
+
+        centerX[i] = m_prevPosX[i] + 0.5f * dx;
+        centerY[i] = m_prevPosY[i] + 0.5f * dy;
+        centerZ[i] = m_prevPosZ[i] + 0.5f * dz;
+
+        if (m_radius[i] > 0.0f)
+            radius[i] = m_radius[i] + 0.5f * real_sqrt(dx * dx + dy * dy + dz * dz);
+        else
+            radius[i] = 0.0f;
+    }
+}
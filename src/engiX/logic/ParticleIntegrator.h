@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "AlignedAllocator.h"
+#include "Simd.h"
+#include "CollisionDetection.h"
+#include "Actor.h"
+
+namespace engiX
+{
+    class TransformCmpt;
+    class ParticlePhysicsCmpt;
+
+    typedef unsigned ParticleSlot;
+    const ParticleSlot NullParticleSlot = unsigned(-1);
+
+    // Collision layers are indices in [0, MaxCollisionLayers), masks have one bit per layer
+    typedef unsigned CollisionLayer;
+    const unsigned MaxCollisionLayers = 32;
+    const unsigned AllCollisionLayers = ~0u;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleIntegrator class
+    //
+    // Batched integrator for all the particles in the game. Particle state (position, velocity, base acceleration,
+    // accumulated force, inverse mass and damping) lives in 32-byte aligned structure-of-arrays (SoA) and is
+    // integrated in one SIMD pass, 8 particles per instruction with AVX, 4 with SSE or one at a time with the scalar
+    // fallback, see Simd.h. Per-frame constants are shared: the damping power damping^dt is computed once per unique
+    // damping value instead of once per particle.
+    //
+    // Every ParticlePhysicsCmpt owns a slot in the integrator for its whole lifetime. Slots are stable, a freed slot
+    // is recycled but never moved, so batched systems (e.g force generators) can hold on to slot indices. Free slots
+    // have 0 inverse mass and are skipped by the integration masks, which lets the kernels run over the whole
+    // capacity without branches or a scalar tail.
+    //
+    // The integrator is authoritative over the position of movable particles (inverse mass > 0) and writes it back
+    // to their TransformCmpt once per frame along with the position at the previous step, so that the view can
+    // interpolate between both when the simulation runs at a fixed step. Immovable particles follow their
+    // TransformCmpt instead.
+    //
+    // Each particle belongs to a collision layer and has a mask of the layers it collides with, all particles are on
+    // layer 0 and collide with everything by default. On top of that the game decides which layers collide at all
+    // through the symmetric layers matrix. Both are folded in a single filter mask per particle which is fed to the
+    // broadphase along with the layer bits, see SpatialHashBroadphase.
+    //
+    // Particles that come to rest are put to sleep by ParticleIslands: a sleeping particle is masked out of the
+    // integration like an immovable one and force generators skip it. Any change made to the particle state through
+    // the setters below wakes it up.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleIntegrator
+    {
+    public:
+        ParticleIntegrator();
+
+        void Integrate(_In_ real dt);
+        void WriteTransforms();
+        void SweptSpheres(_Out_ RealArray& centerX, _Out_ RealArray& centerY, _Out_ RealArray& centerZ, _Out_ RealArray& radius) const;
+
+        ParticleSlot Allocate(_In_ ParticlePhysicsCmpt* pOwner);
+        void Free(_In_ ParticleSlot slot);
+        void Bind(_In_ ParticleSlot slot, _In_ ActorID actorId, _In_ TransformCmpt* pTsfm);
+
+        Vec3 Position(_In_ ParticleSlot slot) const { return Vec3(m_posX[slot], m_posY[slot], m_posZ[slot]); }
+        void Position(_In_ ParticleSlot slot, _In_ const Vec3& pos);
+        // Position and velocity at the beginning of the last step
+        Vec3 PreviousPosition(_In_ ParticleSlot slot) const { return Vec3(m_prevPosX[slot], m_prevPosY[slot], m_prevPosZ[slot]); }
+        Vec3 PreviousVelocity(_In_ ParticleSlot slot) const { return Vec3(m_prevVelX[slot], m_prevVelY[slot], m_prevVelZ[slot]); }
+        Vec3 Velocity(_In_ ParticleSlot slot) const { return Vec3(m_velX[slot], m_velY[slot], m_velZ[slot]); }
+        void Velocity(_In_ ParticleSlot slot, _In_ const Vec3& vel);
+        Vec3 BaseAcceleration(_In_ ParticleSlot slot) const { return Vec3(m_accX[slot], m_accY[slot], m_accZ[slot]); }
+        void BaseAcceleration(_In_ ParticleSlot slot, _In_ const Vec3& acc);
+        real InverseMass(_In_ ParticleSlot slot) const { return m_invMass[slot]; }
+        void InverseMass(_In_ ParticleSlot slot, _In_ real invMass) { m_invMass[slot] = invMass; Wake(slot); }
+        real Damping(_In_ ParticleSlot slot) const { return m_dampingValues[m_dampingIdx[slot]]; }
+        void Damping(_In_ ParticleSlot slot, _In_ real damping);
+        real Radius(_In_ ParticleSlot slot) const { return m_radius[slot]; }
+        void Radius(_In_ ParticleSlot slot, _In_ real radius) { m_radius[slot] = radius; }
+        void AddForce(_In_ ParticleSlot slot, _In_ const Vec3& force);
+        CollisionLayer Layer(_In_ ParticleSlot slot) const { return m_layer[slot]; }
+        void Layer(_In_ ParticleSlot slot, _In_ CollisionLayer layer);
+        unsigned LayerMask(_In_ ParticleSlot slot) const { return m_layerMask[slot]; }
+        void LayerMask(_In_ ParticleSlot slot, _In_ unsigned mask);
+        bool LayersCollide(_In_ CollisionLayer layerA, _In_ CollisionLayer layerB) const { return (m_layersMatrix[layerA] & (1u << layerB)) != 0; }
+        void LayersCollide(_In_ CollisionLayer layerA, _In_ CollisionLayer layerB, _In_ bool collide);
+        // Particles only bounce off each other when both have contact response, see ParticleContactResolver
+        bool ContactResponse(_In_ ParticleSlot slot) const { return m_contactResponse[slot] != 0; }
+        void ContactResponse(_In_ ParticleSlot slot, _In_ bool enable) { m_contactResponse[slot] = enable ? 1 : 0; }
+        real Restitution(_In_ ParticleSlot slot) const { return m_restitution[slot]; }
+        void Restitution(_In_ ParticleSlot slot, _In_ real restitution) { m_restitution[slot] = restitution; }
+        bool IsAwake(_In_ ParticleSlot slot) const { return m_awake[slot] != 0; }
+        void Wake(_In_ ParticleSlot slot, _In_ bool resetSleepTime = true) { m_awake[slot] = AwakeMask; if (resetSleepTime) m_sleepTime[slot] = 0.0f; }
+        void Sleep(_In_ ParticleSlot slot);
+        // Time the particle has spent under the sleep thresholds, see ParticleIslands
+        real SleepTime(_In_ ParticleSlot slot) const { return m_sleepTime[slot]; }
+        void SleepTime(_In_ ParticleSlot slot, _In_ real time) { m_sleepTime[slot] = time; }
+
+        ParticlePhysicsCmpt* Owner(_In_ ParticleSlot slot) const { return m_owners[slot]; }
+        ActorID SlotActor(_In_ ParticleSlot slot) const { return m_actorIds[slot]; }
+
+        // Capacity is always a multiple of Simd::BatchPadding, the raw arrays below are
+        // valid for [0, Capacity()) and can be fed directly to batched SIMD code
+        size_t Capacity() const { return m_invMass.size(); }
+        size_t ParticleCount() const { return m_invMass.size() - m_freeSlots.size(); }
+        const real* PositionX() const { return m_posX.data(); }
+        const real* PositionY() const { return m_posY.data(); }
+        const real* PositionZ() const { return m_posZ.data(); }
+        real* PositionX() { return m_posX.data(); }
+        real* PositionY() { return m_posY.data(); }
+        real* PositionZ() { return m_posZ.data(); }
+        real* VelocityX() { return m_velX.data(); }
+        real* VelocityY() { return m_velY.data(); }
+        real* VelocityZ() { return m_velZ.data(); }
+        const real* InverseMass() const { return m_invMass.data(); }
+        const real* Radius() const { return m_radius.data(); }
+        const unsigned* LayerBits() const { return m_layerBits.data(); }
+        const unsigned* CollisionFilter() const { return m_collisionFilter.data(); }
+        // 0 for sleeping particles and free slots, ~0 otherwise
+        const unsigned* Awake() const { return m_awake.data(); }
+        real* ForceX() { return m_forceX.data(); }
+        real* ForceY() { return m_forceY.data(); }
+        real* ForceZ() { return m_forceZ.data(); }
+
+    protected:
+        static const unsigned AwakeMask = ~0u;
+
+        void Grow();
+        void CalcDampingPowers(_In_ real dt);
+        unsigned AcquireDamping(_In_ real damping);
+        void ReleaseDamping(_In_ unsigned dampingIdx);
+        void IntegrateScalar(_In_ real dt);
+#if !defined(ENGIX_SIMD_SCALAR)
+        void IntegrateSse(_In_ real dt);
+#endif
+#if defined(ENGIX_SIMD_AVX)
+        void IntegrateAvx(_In_ real dt);
+#endif
+        void UpdateCollisionFilter(_In_ ParticleSlot slot);
+
+    private:
+        // Particle state
+        RealArray m_posX;
+        RealArray m_posY;
+        RealArray m_posZ;
+        RealArray m_prevPosX;
+        RealArray m_prevPosY;
+        RealArray m_prevPosZ;
+        RealArray m_velX;
+        RealArray m_velY;
+        RealArray m_velZ;
+        RealArray m_prevVelX;
+        RealArray m_prevVelY;
+        RealArray m_prevVelZ;
+        RealArray m_accX;
+        RealArray m_accY;
+        RealArray m_accZ;
+        RealArray m_forceX;
+        RealArray m_forceY;
+        RealArray m_forceZ;
+        RealArray m_invMass;
+        RealArray m_radius;
+        UIntArray m_dampingIdx;
+
+        // Collision filtering, free slots have no layer bits and a 0 filter
+        std::vector<CollisionLayer> m_layer;
+        UIntArray m_layerMask;
+        UIntArray m_layerBits;
+        UIntArray m_collisionFilter;
+        unsigned m_layersMatrix[MaxCollisionLayers];
+
+        // Contact response
+        std::vector<unsigned char> m_contactResponse;
+        RealArray m_restitution;
+
+        // Sleeping, m_fellAsleep holds the particles put to sleep since the last WriteTransforms
+        UIntArray m_awake;
+        RealArray m_sleepTime;
+        std::vector<ParticleSlot> m_fellAsleep;
+
+        // Unique damping values shared between particles, along with their power
+        // for the current frame delta time. Entry 0 is the no-damping entry used by free slots
+        std::vector<real> m_dampingValues;
+        std::vector<unsigned> m_dampingRefs;
+        RealArray m_dampingPow;
+
+        std::vector<ParticlePhysicsCmpt*> m_owners;
+        std::vector<TransformCmpt*> m_transforms;
+        std::vector<ActorID> m_actorIds;
+        std::vector<ParticleSlot> m_freeSlots;
+    };
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include "ParticleIslands.h"
+
+using namespace engiX;
+using namespace std;
+
+const real ParticleIslands::DefaultSleepVelocity = 0.1f;
+const real ParticleIslands::DefaultSleepAcceleration = 0.5f;
+const real ParticleIslands::DefaultTimeToSleep = 0.5f;
+
+static const unsigned NullIsland = unsigned(-1);
+
+ParticleIslands::ParticleIslands() :
+    m_sleepVelocity(DefaultSleepVelocity),
+    m_sleepAcceleration(DefaultSleepAcceleration),
+    m_timeToSleep(DefaultTimeToSleep),
+    m_sleepingCount(0)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Called once per simulation step after the contacts were resolved. The speed is measured on the distance travelled
+// over the step rather than on the velocity: in a stack the position correction holds resting particles in place even
+// when the velocity iterations leave some velocity behind.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIslands::Update(_In_ ParticleIntegrator& integrator, _In_ const std::vector<ParticleContact>& contacts, _In_ const std::vector<ParticleLink>& links, _In_ real dt)
+{
+    UpdateSleepTimes(integrator, dt);
+    BuildIslands(integrator, contacts, links);
+
+    for (size_t island = 0; island < IslandCount(); ++island)
+    {
+        size_t begin = m_islandStart[island];
+        size_t end = m_islandStart[island + 1];
+
+        if (m_islandSleepTime[island] < m_timeToSleep)
+            continue;
+
+        for (size_t i = begin; i < end; ++i)
+            integrator.Sleep(m_islandSlots[i]);
+
+        m_sleepingCount += end - begin;
+    }
+}
+
+void ParticleIslands::UpdateSleepTimes(_In_ ParticleIntegrator& integrator, _In_ real dt)
+{
+    const size_t capacity = integrator.Capacity();
+    const real* pInvMass = integrator.InverseMass();
+    const unsigned* pAwake = integrator.Awake();
+    const real sleepDistanceSq = m_sleepVelocity * m_sleepVelocity * dt * dt;
+    const real sleepVelocityChangeSq = m_sleepAcceleration * m_sleepAcceleration * dt * dt;
+
+    m_sleepingCount = 0;
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (pInvMass[i] <= 0.0f)
+            continue;
+
+        ParticleSlot slot = ParticleSlot(i);
+
+        if (pAwake[i] == 0)
+        {
+            ++m_sleepingCount;
+            continue;
+        }
+
+        Vec3 pos = integrator.Position(slot);
+        Vec3 prevPos = integrator.PreviousPosition(slot);
+        real dx = pos.x - prevPos.x;
+        real dy = pos.y - prevPos.y;
+        real dz = pos.z - prevPos.z;
+
+        Vec3 vel = integrator.Velocity(slot);
+        Vec3 prevVel = integrator.PreviousVelocity(slot);
+        real dvx = vel.x - prevVel.x;
+        real dvy = vel.y - prevVel.y;
+        real dvz = vel.z - prevVel.z;
+
+        if (dx * dx + dy * dy + dz * dz < sleepDistanceSq &&
+            dvx * dvx + dvy * dvy + dvz * dvz < sleepVelocityChangeSq)
+        {
+            integrator.SleepTime(slot, integrator.SleepTime(slot) + dt);
+        }
+        else
+        {
+            integrator.SleepTime(slot, 0.0f);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Groups the awake movable particles by island, islands are numbered in the order of their lowest slot and list
+// their particles by increasing slot so that the result only depends on the contacts and links.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleIslands::BuildIslands(_In_ const ParticleIntegrator& integrator, _In_ const std::vector<ParticleContact>& contacts, _In_ const std::vector<ParticleLink>& links)
+{
+    const size_t capacity = integrator.Capacity();
+    const real* pInvMass = integrator.InverseMass();
+    const unsigned* pAwake = integrator.Awake();
+
+    m_parent.resize(capacity);
+    for (size_t i = 0; i < capacity; ++i)
+        m_parent[i] = unsigned(i);
+
+    for (auto& contact : contacts)
+    {
+        if (pInvMass[contact.A] > 0.0f && pInvMass[contact.B] > 0.0f)
+            Merge(contact.A, contact.B);
+    }
+
+    for (auto& link : links)
+    {
+        if (pInvMass[link.A] > 0.0f && pInvMass[link.B] > 0.0f)
+            Merge(link.A, link.B);
+    }
+
+    m_islandIdx.assign(capacity, NullIsland);
+    m_islandSleepTime.clear();
+    m_islandStart.assign(1, 0);
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (pInvMass[i] <= 0.0f || pAwake[i] == 0)
+            continue;
+
+        unsigned root = FindRoot(unsigned(i));
+
+        if (m_islandIdx[root] == NullIsland)
+        {
+            m_islandIdx[root] = unsigned(m_islandSleepTime.size());
+            m_islandSleepTime.push_back(REAL_MAX);
+            m_islandStart.push_back(0);
+        }
+
+        unsigned island = m_islandIdx[root];
+        m_islandSleepTime[island] = min(m_islandSleepTime[island], integrator.SleepTime(ParticleSlot(i)));
+        ++m_islandStart[island + 1];
+    }
+
+    for (size_t island = 1; island < m_islandStart.size(); ++island)
+        m_islandStart[island] += m_islandStart[island - 1];
+
+    // Stable counting sort by island
+    vector<size_t> nextIdx(m_islandStart.begin(), m_islandStart.end() - 1);
+    m_islandSlots.resize(m_islandStart.back());
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        if (pInvMass[i] <= 0.0f || pAwake[i] == 0)
+            continue;
+
+        unsigned island = m_islandIdx[FindRoot(unsigned(i))];
+        m_islandSlots[nextIdx[island]++] = ParticleSlot(i);
+    }
+}
+
+unsigned ParticleIslands::FindRoot(_In_ unsigned slot)
+{
+    // Path halving, every visited node skips to its grandparent
+    while (m_parent[slot] != slot)
+    {
+        m_parent[slot] = m_parent[m_parent[slot]];
+        slot = m_parent[slot];
+    }
+
+    return slot;
+}
+
+void ParticleIslands::Merge(_In_ unsigned slotA, _In_ unsigned slotB)
+{
+    unsigned rootA = FindRoot(slotA);
+    unsigned rootB = FindRoot(slotB);
+
+    if (rootA < rootB)
+        m_parent[rootB] = rootA;
+    else if (rootB < rootA)
+        m_parent[rootA] = rootB;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "ParticleIntegrator.h"
+#include "ParticleContactResolver.h"
+#include "ParticleConstraintSolver.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleIslands class
+    //
+    // Puts the particles that came to rest to sleep. A movable particle is resting while both its speed and its
+    // acceleration over the last step stay under the sleep thresholds, both being measured on what the particle did
+    // over the step, contacts included, so that a particle held still by contacts against gravity counts as resting.
+    //
+    // Movable particles connected through contacts or constraints form an island, immovable particles do not connect
+    // islands. An island falls asleep as a whole once all its particles have been resting for TimeToSleep. Sleeping
+    // particles are woken up by the contacts they get with awake particles, see ParticleContactResolver, by the
+    // particles they are bound to, see ParticleConstraintSolver, and by any change game code makes to their state
+    // (velocity, forces, force registration, ...), see ParticleIntegrator. A particle woken up by a contact keeps its
+    // sleep time so that touching a resting pile does not keep the whole pile awake.
+    //
+    // Contacts of a sleeping particle with sleeping or immovable ones are not generated: an island woken up at one end
+    // wakes the particles it rests on one contact further every step.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleIslands
+    {
+    public:
+        static const real DefaultSleepVelocity;
+        static const real DefaultSleepAcceleration;
+        static const real DefaultTimeToSleep;
+
+        ParticleIslands();
+
+        void Update(_In_ ParticleIntegrator& integrator, _In_ const std::vector<ParticleContact>& contacts, _In_ const std::vector<ParticleLink>& links, _In_ real dt);
+
+        real SleepVelocity() const { return m_sleepVelocity; }
+        void SleepVelocity(_In_ real velocity) { m_sleepVelocity = velocity; }
+        real SleepAcceleration() const { return m_sleepAcceleration; }
+        void SleepAcceleration(_In_ real acceleration) { m_sleepAcceleration = acceleration; }
+        real TimeToSleep() const { return m_timeToSleep; }
+        void TimeToSleep(_In_ real time) { m_timeToSleep = time; }
+
+        // Islands of awake particles found by the last Update, island i particles
+        // are IslandSlots()[IslandStart(i), IslandStart(i + 1))
+        size_t IslandCount() const { return m_islandStart.empty() ? 0 : m_islandStart.size() - 1; }
+        size_t IslandStart(_In_ size_t island) const { return m_islandStart[island]; }
+        const std::vector<ParticleSlot>& IslandSlots() const { return m_islandSlots; }
+        size_t SleepingCount() const { return m_sleepingCount; }
+
+    protected:
+        unsigned FindRoot(_In_ unsigned slot);
+        void Merge(_In_ unsigned slotA, _In_ unsigned slotB);
+        void UpdateSleepTimes(_In_ ParticleIntegrator& integrator, _In_ real dt);
+        void BuildIslands(_In_ const ParticleIntegrator& integrator, _In_ const std::vector<ParticleContact>& contacts, _In_ const std::vector<ParticleLink>& links);
+
+    private:
+        real m_sleepVelocity;
+        real m_sleepAcceleration;
+        real m_timeToSleep;
+        size_t m_sleepingCount;
+
+        // Union-find forest over the integrator slots, movable particles only
+        std::vector<unsigned> m_parent;
+        std::vector<unsigned> m_islandIdx;
+        std::vector<real> m_islandSleepTime;
+
+        std::vector<ParticleSlot> m_islandSlots;
+        std::vector<size_t> m_islandStart;
+    };
+}
@@ -5,9 +5,17 @@
 #include "TransformCmpt.h"
 #include "CollisionDetection.h"
 #include "MathHelper.h"
+#include "ParticleIntegrator.h"
 
 namespace engiX
 {
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticlePhysicsCmpt class
+    //
+    // Handle to a particle slot in the GameLogic ParticleIntegrator, the particle state lives in the integrator and
+    // is integrated in batch with all the other particles once per frame, see ParticleIntegrator. The particle
+    // position is picked from the owner TransformCmpt on Init.
+    //---------------------------------------------------------------------------------------------------------------------
     class ParticlePhysicsCmpt : public ActorComponent
     {
     public:
@@ -16,34 +24,38 @@ namespace engiX
         static const real DefaultDamping;
 
         ParticlePhysicsCmpt();
-        void OnUpdate(_In_ const Timer& time) { ApplyForces(time); Integrate(time); }
-        Vec3 Velocity() const { return m_velocity; }
-        void Velocity(_In_ Vec3 val) { m_velocity = val; }
-        Vec3 BaseAcceleraiton() const { return m_baseAcceleraiton; }
-        void BaseAcceleraiton(_In_ Vec3 val) { m_baseAcceleraiton = val; }
-        real Mass() const { return real((m_inverseMass > 0.0) ? 1.0 / m_inverseMass : REAL_MAX); }
-        void Mass(_In_ real val) { m_inverseMass = 1.0f / val; }
-        void InverseMass(_In_ real val) { m_inverseMass = val; }
-        real Damping() const { return m_damping; }
-        void Damping(_In_ real val) { m_damping = val; }
+        ~ParticlePhysicsCmpt();
+        bool Init();
+        void OnUpdate(_In_ const Timer& time) {}
+        Vec3 Position() const { return m_pIntegrator->Position(m_slot); }
+        Vec3 Velocity() const { return m_pIntegrator->Velocity(m_slot); }
+        void Velocity(_In_ Vec3 val) { m_pIntegrator->Velocity(m_slot, val); }
+        Vec3 BaseAcceleraiton() const { return m_pIntegrator->BaseAcceleration(m_slot); }
+        void BaseAcceleraiton(_In_ Vec3 val) { m_pIntegrator->BaseAcceleration(m_slot, val); }
+        real Mass() const { real inverseMass = m_pIntegrator->InverseMass(m_slot); return real((inverseMass > 0.0) ? 1.0 / inverseMass : REAL_MAX); }
+        void Mass(_In_ real val) { m_pIntegrator->InverseMass(m_slot, 1.0f / val); }
+        void InverseMass(_In_ real val) { m_pIntegrator->InverseMass(m_slot, val); }
+        real Damping() const { return m_pIntegrator->Damping(m_slot); }
+        void Damping(_In_ real val) { m_pIntegrator->Damping(m_slot, val); }
         void ScaleVelocity(_In_ real scale);
-        void LifetimeBound(_In_ const BoundingSphere& lifetimeBound) { m_lifetimeBound = lifetimeBound; }
         BoundingSphere BoundingMesh() const;
-        void Radius(_In_ real radius) { m_radius = radius; }
-        void AddForce(_In_ const Vec3& force) { Math::Vec3Accumulate(m_accumulatedForce, force); }
+        void Radius(_In_ real radius) { m_pIntegrator->Radius(m_slot, radius); }
+        void AddForce(_In_ const Vec3& force) { m_pIntegrator->AddForce(m_slot, force); }
+        ParticleSlot Slot() const { return m_slot; }
+        CollisionLayer Layer() const { return m_pIntegrator->Layer(m_slot); }
+        void Layer(_In_ CollisionLayer layer) { m_pIntegrator->Layer(m_slot, layer); }
+        // Layers this particle collides with, on top of the game layers matrix
+        unsigned LayerMask() const { return m_pIntegrator->LayerMask(m_slot); }
+        void LayerMask(_In_ unsigned mask) { m_pIntegrator->LayerMask(m_slot, mask); }
+        bool ContactResponse() const { return m_pIntegrator->ContactResponse(m_slot); }
+        void ContactResponse(_In_ bool enable) { m_pIntegrator->ContactResponse(m_slot, enable); }
+        real Restitution() const { return m_pIntegrator->Restitution(m_slot); }
+        void Restitution(_In_ real restitution) { m_pIntegrator->Restitution(m_slot, restitution); }
+        bool IsAwake() const { return m_pIntegrator->IsAwake(m_slot); }
+        void Wake() { m_pIntegrator->Wake(m_slot); }
 
     protected:
-        void ApplyForces(_In_ const Timer& time);
-        void Integrate(_In_ const Timer& time);
-        void ClearForceAccum() { m_accumulatedForce.x = m_accumulatedForce.y = m_accumulatedForce.z = 0.0; }
-
-        Vec3 m_velocity;
-        Vec3 m_baseAcceleraiton;
-        real m_inverseMass;
-        real m_damping;
-        real m_radius;
-
-        Vec3 m_accumulatedForce;
-        BoundingSphere m_lifetimeBound;
+        ParticleIntegrator* m_pIntegrator;
+        ParticleSlot m_slot;
     };
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include "ParticleRaycaster.h"
+#include "CollisionDetection.h"
+
+using namespace engiX;
+using namespace std;
+
+// Below this many rays per chunk the threads hand off cost more than the casts
+static const size_t MinRaysPerTask = 32;
+
+namespace
+{
+    // Exact test of the particle held by a proxy, fills the hit if the ray enters its sphere within maxDistance
+    bool HitProxy(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray,
+        _In_ AabbProxy proxy, _In_ real maxDistance, _Out_ RaycastHit& hit)
+    {
+        ParticleSlot slot = ParticleSlot(tree.ProxyUserData(proxy));
+
+        // The slot may have been freed or recycled since the tree was updated
+        if (integrator.SlotActor(slot) != tree.ProxyActor(proxy) || (integrator.LayerBits()[slot] & ray.LayerMask) == 0)
+            return false;
+
+        Vec3 center = integrator.Position(slot);
+        BoundingSphere sphere(integrator.Radius(slot), center);
+        real distance;
+
+        if (!sphere.IntersectRay(ray.Origin, ray.Direction, maxDistance, distance))
+            return false;
+
+        hit.Actor = integrator.SlotActor(slot);
+        hit.Slot = slot;
+        hit.Distance = distance;
+        hit.Point = Vec3(
+            ray.Origin.x + ray.Direction.x * distance,
+            ray.Origin.y + ray.Direction.y * distance,
+            ray.Origin.z + ray.Direction.z * distance);
+
+        // A ray starting inside the sphere gets the normal facing back along the ray
+        Vec3 n(hit.Point.x - center.x, hit.Point.y - center.y, hit.Point.z - center.z);
+        real length = real_sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+        if (distance > 0.0f && length > 0.0f)
+        {
+            hit.Normal = Vec3(n.x / length, n.y / length, n.z / length);
+        }
+        else
+        {
+            length = real_sqrt(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z);
+            hit.Normal = length > 0.0f ?
+                Vec3(-ray.Direction.x / length, -ray.Direction.y / length, -ray.Direction.z / length) :
+                Vec3(0.0f, 0.0f, 0.0f);
+        }
+
+        return true;
+    }
+
+    class ClosestHitCallback : public IAabbRayCallback
+    {
+    public:
+        ClosestHitCallback(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ RaycastHit& hit) :
+            m_tree(tree),
+            m_integrator(integrator),
+            m_ray(ray),
+            m_hit(hit),
+            m_isHit(false)
+        {
+            m_hit = RaycastHit();
+        }
+
+        real ReportProxy(_In_ AabbProxy proxy, _In_ real maxDistance)
+        {
+            RaycastHit hit;
+
+            if (!HitProxy(m_tree, m_integrator, m_ray, proxy, maxDistance, hit))
+                return maxDistance;
+
+            m_hit = hit;
+            m_isHit = true;
+
+            return hit.Distance;
+        }
+
+        bool IsHit() const { return m_isHit; }
+
+    private:
+        const AabbTree& m_tree;
+        const ParticleIntegrator& m_integrator;
+        const RaycastRay& m_ray;
+        RaycastHit& m_hit;
+        bool m_isHit;
+    };
+
+    class AllHitsCallback : public IAabbRayCallback
+    {
+    public:
+        AllHitsCallback(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ vector<RaycastHit>& hits) :
+            m_tree(tree),
+            m_integrator(integrator),
+            m_ray(ray),
+            m_hits(hits)
+        {}
+
+        real ReportProxy(_In_ AabbProxy proxy, _In_ real maxDistance)
+        {
+            RaycastHit hit;
+
+            if (HitProxy(m_tree, m_integrator, m_ray, proxy, maxDistance, hit))
+                m_hits.push_back(hit);
+
+            return maxDistance;
+        }
+
+    private:
+        const AabbTree& m_tree;
+        const ParticleIntegrator& m_integrator;
+        const RaycastRay& m_ray;
+        vector<RaycastHit>& m_hits;
+    };
+}
+
+bool ParticleRaycaster::Raycast(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ RaycastHit& hit)
+{
+    ClosestHitCallback callback(tree, integrator, ray, hit);
+    tree.Raycast(ray.Origin, ray.Direction, ray.MaxDistance, callback);
+
+    return callback.IsHit();
+}
+
+size_t ParticleRaycaster::RaycastAll(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ std::vector<RaycastHit>& hits)
+{
+    hits.clear();
+
+    AllHitsCallback callback(tree, integrator, ray, hits);
+    tree.Raycast(ray.Origin, ray.Direction, ray.MaxDistance, callback);
+
+    // Ties are broken by slot so that the order does not depend on the tree shape
+    sort(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+        return a.Distance < b.Distance || (a.Distance == b.Distance && a.Slot < b.Slot);
+    });
+
+    return hits.size();
+}
+
+size_t ParticleRaycaster::RaycastBatch(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ WorkerPool& workers,
+    _In_ const RaycastRay* pRays, _In_ size_t count, _Out_ RaycastHit* pHits)
+{
+    // Every ray writes its own hit, the tree and the integrator are only read
+    workers.ParallelFor(count, MinRaysPerTask, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            Raycast(tree, integrator, pRays[i], pHits[i]);
+    });
+
+    size_t hitCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pHits[i].Actor != NullActorID)
+            ++hitCount;
+    }
+
+    return hitCount;
+}
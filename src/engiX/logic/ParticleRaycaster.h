@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "AabbTree.h"
+#include "ParticleIntegrator.h"
+#include "WorkerPool.h"
+
+namespace engiX
+{
+    struct RaycastRay
+    {
+        RaycastRay() :
+            Origin(0.0f, 0.0f, 0.0f),
+            Direction(0.0f, 0.0f, 1.0f),
+            MaxDistance(REAL_MAX),
+            LayerMask(AllCollisionLayers)
+        {}
+
+        RaycastRay(_In_ const Vec3& origin, _In_ const Vec3& direction, _In_ real maxDistance, _In_ unsigned layerMask = AllCollisionLayers) :
+            Origin(origin),
+            Direction(direction),
+            MaxDistance(maxDistance),
+            LayerMask(layerMask)
+        {}
+
+        Vec3 Origin;
+        Vec3 Direction;   // does not need to be normalized, distances are in direction length units
+        real MaxDistance;
+        unsigned LayerMask; // layers of the particles the ray hits
+    };
+
+    struct RaycastHit
+    {
+        RaycastHit() :
+            Actor(NullActorID),
+            Slot(NullParticleSlot),
+            Distance(0.0f),
+            Point(0.0f, 0.0f, 0.0f),
+            Normal(0.0f, 0.0f, 0.0f)
+        {}
+
+        ActorID Actor;    // NullActorID when the ray hit nothing
+        ParticleSlot Slot;
+        real Distance;
+        Vec3 Point;
+        Vec3 Normal;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleRaycaster class
+    //
+    // Casts rays against the particles bounding spheres, e.g for hitscan weapons that need no actor per shot. The
+    // AabbTree narrows the candidates down to the particles whose box the ray hits, each candidate is then tested
+    // exactly against its sphere at the current integrator position. Proxies must carry their integrator slot as user
+    // data, see GameLogic::UpdateQueryTree.
+    //
+    // Raycast only keeps the closest hit and clips the ray to it as the tree is walked. Batches of rays are split
+    // between the WorkerPool threads, the tree and the integrator must not change while they are cast.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleRaycaster
+    {
+    public:
+        static bool Raycast(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ RaycastHit& hit);
+        // All the hits sorted by distance, returns the hit count
+        static size_t RaycastAll(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ const RaycastRay& ray, _Out_ std::vector<RaycastHit>& hits);
+        // Closest hit of each ray, pHits holds count hits. Returns the number of rays that hit
+        static size_t RaycastBatch(_In_ const AabbTree& tree, _In_ const ParticleIntegrator& integrator, _In_ WorkerPool& workers,
+            _In_ const RaycastRay* pRays, _In_ size_t count, _Out_ RaycastHit* pHits);
+    };
+}
@@ -0,0 +1,239 @@
+#include "ParticleVolumes.h"
+#include "Simd.h"
+#include "Logger.h"
+
+using namespace engiX;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+ParticleVolumes::ParticleVolumes() :
+    m_lastId(NullParticleVolumeID)
+{
+}
+
+ParticleVolumeID ParticleVolumes::AddSphere(_In_ VolumeType type, _In_ const BoundingSphere& sphere, _In_ unsigned layerMask, _In_ bool isInverted)
+{
+    return AddVolume(type, SHAPE_Sphere, sphere.Position(), Vec3(0.0f, 0.0f, 0.0f), sphere.Radius() * sphere.Radius(), layerMask, isInverted);
+}
+
+ParticleVolumeID ParticleVolumes::AddBox(_In_ VolumeType type, _In_ const AxisAlignedBox& box, _In_ unsigned layerMask, _In_ bool isInverted)
+{
+    return AddVolume(type, SHAPE_Box, box.Min(), box.Max(), 0.0f, layerMask, isInverted);
+}
+
+ParticleVolumeID ParticleVolumes::AddHalfSpace(_In_ VolumeType type, _In_ const Vec3& normal, _In_ real offset, _In_ unsigned layerMask, _In_ bool isInverted)
+{
+    return AddVolume(type, SHAPE_HalfSpace, normal, Vec3(0.0f, 0.0f, 0.0f), offset, layerMask, isInverted);
+}
+
+ParticleVolumeID ParticleVolumes::AddVolume(_In_ VolumeType type, _In_ VolumeShape shape, _In_ const Vec3& a, _In_ const Vec3& b, _In_ real w,
+    _In_ unsigned layerMask, _In_ bool isInverted)
+{
+    Volume volume;
+    volume.Id = ++m_lastId;
+    volume.Type = type;
+    volume.Shape = shape;
+    volume.A = a;
+    volume.B = b;
+    volume.W = w;
+    volume.LayerMask = layerMask;
+    volume.IsInverted = isInverted;
+
+    // Particles already inside a new trigger get their enter event on the next Update
+    if (type == VOLUME_Trigger)
+        volume.Inside.resize(m_slotActors.size() / 4, 0);
+
+    m_volumes.push_back(volume);
+
+    return volume.Id;
+}
+
+bool ParticleVolumes::RemoveVolume(_In_ ParticleVolumeID volumeId)
+{
+    for (auto where = m_volumes.begin(); where != m_volumes.end(); ++where)
+    {
+        if (where->Id == volumeId)
+        {
+            m_volumes.erase(where);
+            return true;
+        }
+    }
+
+    LogWarning("Volume[%d] does not exist, call has no effect", volumeId);
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// A slot freed and allocated again since the last Update belongs to another particle, it starts outside all the
+// triggers.
+//---------------------------------------------------------------------------------------------------------------------
+void ParticleVolumes::ForgetRecycledSlots(_In_ const ParticleIntegrator& integrator)
+{
+    const size_t capacity = integrator.Capacity();
+
+    m_slotActors.resize(capacity, NullActorID);
+
+    for (auto& volume : m_volumes)
+    {
+        if (volume.Type == VOLUME_Trigger)
+            volume.Inside.resize(capacity / 4, 0);
+    }
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        ActorID actorId = integrator.SlotActor(ParticleSlot(i));
+
+        if (actorId == m_slotActors[i])
+            continue;
+
+        m_slotActors[i] = actorId;
+
+        for (auto& volume : m_volumes)
+        {
+            if (volume.Type == VOLUME_Trigger)
+                volume.Inside[i >> 2] &= ~(1u << (i & 3));
+        }
+    }
+}
+
+void ParticleVolumes::AddEvents(_In_ const ParticleIntegrator& integrator, _In_ ParticleVolumeID volumeId, _In_ size_t first, _In_ unsigned laneMask, _In_ bool isEnter)
+{
+    for (unsigned lane = 0; laneMask != 0; ++lane, laneMask >>= 1)
+    {
+        if (laneMask & 1)
+            m_events.push_back(ParticleVolumeEvent(volumeId, integrator.SlotActor(ParticleSlot(first + lane)), isEnter));
+    }
+}
+
+void ParticleVolumes::Update(_In_ const ParticleIntegrator& integrator)
+{
+    m_killedSlots.clear();
+    m_events.clear();
+
+    if (m_volumes.empty())
+        return;
+
+    ForgetRecycledSlots(integrator);
+
+    const size_t capacity = integrator.Capacity();
+    const real* pPosX = integrator.PositionX();
+    const real* pPosY = integrator.PositionY();
+    const real* pPosZ = integrator.PositionZ();
+    const unsigned* pLayerBits = integrator.LayerBits();
+#if !defined(ENGIX_SIMD_SCALAR)
+    XMVECTOR vZero = XMVectorZero();
+    XMVECTOR vTrue = XMVectorTrueInt();
+#endif
+
+    for (size_t i = 0; i < capacity; i += 4)
+    {
+#if !defined(ENGIX_SIMD_SCALAR)
+        XMVECTOR x = Simd::Load4(pPosX + i);
+        XMVECTOR y = Simd::Load4(pPosY + i);
+        XMVECTOR z = Simd::Load4(pPosZ + i);
+        XMVECTOR layerBits = Simd::LoadMask4(pLayerBits + i);
+#endif
+        unsigned killMask = 0;
+
+        for (auto& volume : m_volumes)
+        {
+#if !defined(ENGIX_SIMD_SCALAR)
+            XMVECTOR inside;
+
+            switch (volume.Shape)
+            {
+            case SHAPE_Sphere:
+            {
+                XMVECTOR dx = XMVectorSubtract(x, XMVectorReplicate(volume.A.x));
+                XMVECTOR dy = XMVectorSubtract(y, XMVectorReplicate(volume.A.y));
+                XMVECTOR dz = XMVectorSubtract(z, XMVectorReplicate(volume.A.z));
+                XMVECTOR distSq = XMVectorMultiplyAdd(dz, dz, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dx, dx)));
+                inside = XMVectorLessOrEqual(distSq, XMVectorReplicate(volume.W));
+                break;
+            }
+            case SHAPE_Box:
+                inside = XMVectorAndInt(
+                    XMVectorAndInt(
+                        XMVectorAndInt(XMVectorGreaterOrEqual(x, XMVectorReplicate(volume.A.x)), XMVectorLessOrEqual(x, XMVectorReplicate(volume.B.x))),
+                        XMVectorAndInt(XMVectorGreaterOrEqual(y, XMVectorReplicate(volume.A.y)), XMVectorLessOrEqual(y, XMVectorReplicate(volume.B.y)))),
+                    XMVectorAndInt(XMVectorGreaterOrEqual(z, XMVectorReplicate(volume.A.z)), XMVectorLessOrEqual(z, XMVectorReplicate(volume.B.z))));
+                break;
+            default:
+            {
+                XMVECTOR dot = XMVectorMultiplyAdd(z, XMVectorReplicate(volume.A.z),
+                    XMVectorMultiplyAdd(y, XMVectorReplicate(volume.A.y), XMVectorMultiply(x, XMVectorReplicate(volume.A.x))));
+                inside = XMVectorLess(dot, XMVectorReplicate(volume.W));
+                break;
+            }
+            }
+
+            if (volume.IsInverted)
+                inside = XMVectorXorInt(inside, vTrue);
+
+            // Drop the lanes whose layer is not in the volume mask
+            XMVECTOR isFiltered = XMVectorEqualInt(XMVectorAndInt(layerBits, XMVectorReplicateInt(volume.LayerMask)), vZero);
+            unsigned laneMask = Simd::MoveMask4(XMVectorAndCInt(inside, isFiltered));
+#else
+            unsigned laneMask = 0;
+
+            for (unsigned lane = 0; lane < 4; ++lane)
+            {
+                size_t j = i + lane;
+                bool isInside;
+
+                switch (volume.Shape)
+                {
+                case SHAPE_Sphere:
+                {
+                    real dx = pPosX[j] - volume.A.x;
+                    real dy = pPosY[j] - volume.A.y;
+                    real dz = pPosZ[j] - volume.A.z;
+                    isInside = (dx * dx + dy * dy + dz * dz <= volume.W);
+                    break;
+                }
+                case SHAPE_Box:
+                    isInside = (pPosX[j] >= volume.A.x && pPosX[j] <= volume.B.x &&
+                        pPosY[j] >= volume.A.y && pPosY[j] <= volume.B.y &&
+                        pPosZ[j] >= volume.A.z && pPosZ[j] <= volume.B.z);
+                    break;
+                default:
+                    isInside = (pPosX[j] * volume.A.x + pPosY[j] * volume.A.y + pPosZ[j] * volume.A.z < volume.W);
+                    break;
+                }
+
+                if (volume.IsInverted)
+                    isInside = !isInside;
+
+                // Drop the lanes whose layer is not in the volume mask
+                if (isInside && (pLayerBits[j] & volume.LayerMask) != 0)
+                    laneMask |= 1u << lane;
+            }
+#endif
+
+            if (volume.Type == VOLUME_Kill)
+            {
+                killMask |= laneMask;
+                continue;
+            }
+
+            unsigned char& wasInside = volume.Inside[i >> 2];
+            unsigned entered = laneMask & ~wasInside;
+            unsigned exited = wasInside & ~laneMask;
+
+            if (entered != 0)
+                AddEvents(integrator, volume.Id, i, entered, true);
+            if (exited != 0)
+                AddEvents(integrator, volume.Id, i, exited, false);
+
+            wasInside = (unsigned char)laneMask;
+        }
+
+        for (unsigned lane = 0; killMask != 0; ++lane, killMask >>= 1)
+        {
+            if (killMask & 1)
+                m_killedSlots.push_back(ParticleSlot(i + lane));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "ParticleIntegrator.h"
+#include "CollisionDetection.h"
+
+namespace engiX
+{
+    typedef unsigned ParticleVolumeID;
+    const ParticleVolumeID NullParticleVolumeID = 0;
+
+    // A particle entered or exited a trigger volume
+    struct ParticleVolumeEvent
+    {
+        ParticleVolumeEvent(_In_ ParticleVolumeID volumeId, _In_ ActorID actorId, _In_ bool isEnter) :
+            VolumeId(volumeId),
+            ActorId(actorId),
+            IsEnter(isEnter)
+        {}
+
+        ParticleVolumeID VolumeId;
+        ActorID ActorId;
+        bool IsEnter;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // ParticleVolumes class
+    //
+    // Kill and trigger volumes tested against the particle centers once per simulation step. Particles inside a kill
+    // volume are reported for despawn in one batch, see KilledSlots(). Trigger volumes remember which particles are
+    // inside and report them when they enter or exit, see Events(). Particles that get destroyed while inside a
+    // trigger are not reported as exiting it.
+    //
+    // A volume is a sphere, an axis aligned box or a half-space, the half-space holds the points p with
+    // dot(normal, p) < offset. An inverted volume holds everything outside its shape instead, e.g. an inverted sphere
+    // kill volume keeps the particles within the world bounds. A volume only affects the particles whose collision
+    // layer is in its layer mask, free slots have no layer and are never inside.
+    //
+    // All the volumes are tested in a single pass over the integrator SoA positions, 4 particles at a time, with
+    // DirectXMath on the SSE and AVX flavors and one lane after the other on the scalar flavor, see Simd.h.
+    //---------------------------------------------------------------------------------------------------------------------
+    class ParticleVolumes
+    {
+    public:
+        enum VolumeType
+        {
+            VOLUME_Kill,
+            VOLUME_Trigger
+        };
+
+        ParticleVolumes();
+
+        ParticleVolumeID AddSphere(_In_ VolumeType type, _In_ const BoundingSphere& sphere, _In_ unsigned layerMask = AllCollisionLayers, _In_ bool isInverted = false);
+        ParticleVolumeID AddBox(_In_ VolumeType type, _In_ const AxisAlignedBox& box, _In_ unsigned layerMask = AllCollisionLayers, _In_ bool isInverted = false);
+        ParticleVolumeID AddHalfSpace(_In_ VolumeType type, _In_ const Vec3& normal, _In_ real offset, _In_ unsigned layerMask = AllCollisionLayers, _In_ bool isInverted = false);
+        bool RemoveVolume(_In_ ParticleVolumeID volumeId);
+        size_t VolumeCount() const { return m_volumes.size(); }
+
+        void Update(_In_ const ParticleIntegrator& integrator);
+        // Slots found inside a kill volume by the last Update
+        const std::vector<ParticleSlot>& KilledSlots() const { return m_killedSlots; }
+        // Trigger enter and exit events found by the last Update
+        const std::vector<ParticleVolumeEvent>& Events() const { return m_events; }
+
+    protected:
+        enum VolumeShape
+        {
+            SHAPE_Sphere,
+            SHAPE_Box,
+            SHAPE_HalfSpace
+        };
+
+        // Sphere: A = center, W = radius squared
+        // Box: A = min corner, B = max corner
+        // HalfSpace: A = normal, W = offset
+        struct Volume
+        {
+            ParticleVolumeID Id;
+            VolumeType Type;
+            VolumeShape Shape;
+            Vec3 A;
+            Vec3 B;
+            real W;
+            unsigned LayerMask;
+            bool IsInverted;
+            // Triggers only, one 4 bits lane mask per batch of 4 slots
+            std::vector<unsigned char> Inside;
+        };
+
+        ParticleVolumeID AddVolume(_In_ VolumeType type, _In_ VolumeShape shape, _In_ const Vec3& a, _In_ const Vec3& b, _In_ real w,
+            _In_ unsigned layerMask, _In_ bool isInverted);
+        void ForgetRecycledSlots(_In_ const ParticleIntegrator& integrator);
+        void AddEvents(_In_ const ParticleIntegrator& integrator, _In_ ParticleVolumeID volumeId, _In_ size_t first, _In_ unsigned laneMask, _In_ bool isEnter);
+
+    private:
+        ParticleVolumeID m_lastId;
+        std::vector<Volume> m_volumes;
+        // Actors that owned the slots at the last Update, to detect recycled slots
+        std::vector<ActorID> m_slotActors;
+        std::vector<ParticleSlot> m_killedSlots;
+        std::vector<ParticleVolumeEvent> m_events;
+    };
+}
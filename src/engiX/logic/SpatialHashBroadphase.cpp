@@ -0,0 +1,413 @@
+#include "SpatialHashBroadphase.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace engiX;
+using namespace std;
+
+const real SpatialHashBroadphase::DefaultCellSize = 4.0f;
+
+// Half of the 26 neighbor cells, a cell pairs with these ones and the other half pairs with it
+static const int HalfNeighborhood[13][3] =
+{
+    { 1, 0, 0 },
+    { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+    { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+    { -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+    { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 }
+};
+
+SpatialHashBroadphase::SpatialHashBroadphase(_In_ real cellSize) :
+    m_cellSize(cellSize),
+    m_invCellSize(1.0f / cellSize),
+    m_usedCellCount(0),
+    m_liveCellCount(0),
+    m_sphereCount(0)
+{
+
+}
+
+void SpatialHashBroadphase::CellSize(_In_ real cellSize)
+{
+    _ASSERTE(cellSize > 0.0f);
+
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+    Clear();
+}
+
+void SpatialHashBroadphase::Clear()
+{
+    m_cells.clear();
+    m_usedCellCount = 0;
+    m_liveCellCount = 0;
+    m_state.assign(m_state.size(), SPHERE_None);
+    m_largeSpheres.clear();
+    m_sphereCount = 0;
+    m_pairs.clear();
+}
+
+SpatialHashBroadphase::CellKey SpatialHashBroadphase::MakeKey(_In_ int x, _In_ int y, _In_ int z)
+{
+    // 21 bits per axis, which covers +/- 1M cells around the origin
+    const CellKey mask = (1 << 21) - 1;
+    const int bias = 1 << 20;
+
+    return (((CellKey)(x + bias) & mask) << 42) |
+        (((CellKey)(y + bias) & mask) << 21) |
+        ((CellKey)(z + bias) & mask);
+}
+
+void SpatialHashBroadphase::DecodeKey(_In_ CellKey key, _Out_ int& x, _Out_ int& y, _Out_ int& z)
+{
+    const CellKey mask = (1 << 21) - 1;
+    const int bias = 1 << 20;
+
+    x = (int)((key >> 42) & mask) - bias;
+    y = (int)((key >> 21) & mask) - bias;
+    z = (int)(key & mask) - bias;
+}
+
+size_t SpatialHashBroadphase::HashCell(_In_ int x, _In_ int y, _In_ int z)
+{
+    // Linear hash, neighbor cells are always at the same distance in the table from each other,
+    // which turns the neighbor lookups of a sequential walk over the table into sequential walks too
+    return (size_t)((unsigned)x + (unsigned)y * 0x9E3779B1u + (unsigned)z * 0x85EBCA77u);
+}
+
+unsigned SpatialHashBroadphase::FindCell(_In_ int x, _In_ int y, _In_ int z) const
+{
+    if (m_cells.empty())
+        return NullIndex;
+
+    const CellKey key = MakeKey(x, y, z);
+    const size_t mask = m_cells.size() - 1;
+
+    for (size_t idx = HashCell(x, y, z) & mask;; idx = (idx + 1) & mask)
+    {
+        if (m_cells[idx].Key == key)
+            return (unsigned)idx;
+        else if (m_cells[idx].Key == EmptyKey)
+            return NullIndex;
+    }
+}
+
+unsigned SpatialHashBroadphase::FindOrAddCell(_In_ int x, _In_ int y, _In_ int z)
+{
+    // Keep the table at most half full, empty cells are dropped on rehash
+    if ((m_usedCellCount + 1) * 2 > m_cells.size())
+    {
+        size_t capacity = 64;
+        while (capacity < (m_liveCellCount + 1) * 4)
+            capacity <<= 1;
+
+        Rehash(capacity);
+    }
+
+    const CellKey key = MakeKey(x, y, z);
+    const size_t mask = m_cells.size() - 1;
+    size_t idx = HashCell(x, y, z) & mask;
+
+    for (; m_cells[idx].Key != EmptyKey; idx = (idx + 1) & mask)
+    {
+        if (m_cells[idx].Key == key)
+            return (unsigned)idx;
+    }
+
+    Cell& cell = m_cells[idx];
+    cell.Key = key;
+    cell.Head = NullIndex;
+    cell.Count = 0;
+    ++m_usedCellCount;
+
+    return (unsigned)idx;
+}
+
+void SpatialHashBroadphase::Rehash(_In_ size_t capacity)
+{
+    vector<Cell> oldCells;
+    oldCells.swap(m_cells);
+
+    Cell emptyCell;
+    emptyCell.Key = EmptyKey;
+    emptyCell.Head = NullIndex;
+    emptyCell.Count = 0;
+    m_cells.assign(capacity, emptyCell);
+
+    const size_t mask = capacity - 1;
+
+    for (const Cell& oldCell : oldCells)
+    {
+        if (oldCell.Key == EmptyKey || oldCell.Count == 0)
+            continue;
+
+        int x, y, z;
+        DecodeKey(oldCell.Key, x, y, z);
+
+        size_t idx = HashCell(x, y, z) & mask;
+        while (m_cells[idx].Key != EmptyKey)
+            idx = (idx + 1) & mask;
+
+        m_cells[idx] = oldCell;
+
+        for (unsigned sphere = oldCell.Head; sphere != NullIndex; sphere = m_next[sphere])
+            m_cellIdx[sphere] = (unsigned)idx;
+    }
+
+    m_usedCellCount = m_liveCellCount;
+}
+
+void SpatialHashBroadphase::AddSphere(_In_ unsigned sphere, _In_ SphereState state, _In_ int x, _In_ int y, _In_ int z)
+{
+    _ASSERTE(m_state[sphere] == SPHERE_None);
+
+    m_state[sphere] = (unsigned char)state;
+
+    if (state == SPHERE_None)
+        return;
+
+    ++m_sphereCount;
+
+    if (state == SPHERE_Large)
+    {
+        m_largeSpheres.push_back(sphere);
+        return;
+    }
+
+    unsigned cellIdx = FindOrAddCell(x, y, z);
+    Cell& cell = m_cells[cellIdx];
+
+    if (cell.Count++ == 0)
+        ++m_liveCellCount;
+
+    m_cellIdx[sphere] = cellIdx;
+    m_cellX[sphere] = x;
+    m_cellY[sphere] = y;
+    m_cellZ[sphere] = z;
+    m_prev[sphere] = NullIndex;
+    m_next[sphere] = cell.Head;
+
+    if (cell.Head != NullIndex)
+        m_prev[cell.Head] = sphere;
+
+    cell.Head = sphere;
+}
+
+void SpatialHashBroadphase::RemoveSphere(_In_ unsigned sphere)
+{
+    SphereState state = (SphereState)m_state[sphere];
+    m_state[sphere] = SPHERE_None;
+
+    if (state == SPHERE_None)
+        return;
+
+    --m_sphereCount;
+
+    if (state == SPHERE_Large)
+    {
+        auto where = find(m_largeSpheres.begin(), m_largeSpheres.end(), sphere);
+        _ASSERTE(where != m_largeSpheres.end());
+        *where = m_largeSpheres.back();
+        m_largeSpheres.pop_back();
+        return;
+    }
+
+    Cell& cell = m_cells[m_cellIdx[sphere]];
+
+    if (m_prev[sphere] != NullIndex)
+        m_next[m_prev[sphere]] = m_next[sphere];
+    else
+        cell.Head = m_next[sphere];
+
+    if (m_next[sphere] != NullIndex)
+        m_prev[m_next[sphere]] = m_prev[sphere];
+
+    if (--cell.Count == 0)
+        --m_liveCellCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Updates the grid with the spheres current state and generates the candidate pairs, see Pairs(). Spheres are given
+// as SoA arrays of count elements, the sphere index in the arrays is its identity across updates.
+//---------------------------------------------------------------------------------------------------------------------
+void SpatialHashBroadphase::Update(_In_ const real* pPosX, _In_ const real* pPosY, _In_ const real* pPosZ, _In_ const real* pRadius, _In_ size_t count,
+    _In_opt_ const unsigned* pLayerBits, _In_opt_ const unsigned* pLayerMasks)
+{
+    if (m_state.size() < count)
+    {
+        m_state.resize(count, SPHERE_None);
+        m_cellIdx.resize(count, unsigned(NullIndex));
+        m_next.resize(count, unsigned(NullIndex));
+        m_prev.resize(count, unsigned(NullIndex));
+        m_cellX.resize(count, 0);
+        m_cellY.resize(count, 0);
+        m_cellZ.resize(count, 0);
+        m_bounds.resize(count);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        unsigned sphere = (unsigned)i;
+        SphereState state = SPHERE_None;
+        int x = 0, y = 0, z = 0;
+
+        SphereBounds& bounds = m_bounds[i];
+        bounds.X = pPosX[i];
+        bounds.Y = pPosY[i];
+        bounds.Z = pPosZ[i];
+        bounds.Radius = pRadius[i];
+        bounds.Id = sphere;
+        bounds.LayerBits = pLayerBits ? pLayerBits[i] : ~0u;
+        bounds.LayerMask = pLayerMasks ? pLayerMasks[i] : ~0u;
+
+        if (pRadius[i] > 0.0f && bounds.LayerBits != 0 && bounds.LayerMask != 0)
+            state = (2.0f * pRadius[i] > m_cellSize) ? SPHERE_Large : SPHERE_Grid;
+
+        if (state == SPHERE_Grid)
+        {
+            x = CellCoord(pPosX[i]);
+            y = CellCoord(pPosY[i]);
+            z = CellCoord(pPosZ[i]);
+        }
+
+        // Most spheres stay in the same cell from one step to the next
+        if (state == m_state[i] &&
+            (state != SPHERE_Grid || (x == m_cellX[i] && y == m_cellY[i] && z == m_cellZ[i])))
+            continue;
+
+        RemoveSphere(sphere);
+        AddSphere(sphere, state, x, y, z);
+    }
+
+    // Spheres past the end of the arrays are gone
+    for (size_t i = count; i < m_state.size(); ++i)
+        RemoveSphere((unsigned)i);
+
+    FindPairs();
+}
+
+void SpatialHashBroadphase::TestPair(_In_ const SphereBounds& a, _In_ const SphereBounds& b)
+{
+    if ((a.LayerMask & b.LayerBits) == 0 || (b.LayerMask & a.LayerBits) == 0)
+        return;
+
+    real radiusSum = a.Radius + b.Radius;
+
+    // Sharing a cell neighborhood does not mean the bounding boxes overlap
+    if (real_abs(a.X - b.X) <= radiusSum &&
+        real_abs(a.Y - b.Y) <= radiusSum &&
+        real_abs(a.Z - b.Z) <= radiusSum)
+    {
+        m_pairs.push_back(BroadphasePair(min(a.Id, b.Id), max(a.Id, b.Id)));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Copies the spheres bounds cell by cell in table order, the cells lists jump all over the spheres arrays, packing
+// them once makes the neighbor cells tests walk memory sequentially since neighbor cells are always at the same
+// distance in the table.
+//---------------------------------------------------------------------------------------------------------------------
+void SpatialHashBroadphase::PackCells()
+{
+    m_packedStart.resize(m_cells.size());
+    m_packedBounds.resize(m_sphereCount);
+
+    unsigned packedCount = 0;
+
+    for (size_t idx = 0; idx < m_cells.size(); ++idx)
+    {
+        const Cell& cell = m_cells[idx];
+        m_packedStart[idx] = packedCount;
+
+        if (cell.Key == EmptyKey)
+            continue;
+
+        for (unsigned sphere = cell.Head; sphere != NullIndex; sphere = m_next[sphere])
+            m_packedBounds[packedCount++] = m_bounds[sphere];
+    }
+}
+
+void SpatialHashBroadphase::FindPairs()
+{
+    m_pairs.clear();
+
+    PackCells();
+
+    for (size_t idx = 0; idx < m_cells.size(); ++idx)
+    {
+        const Cell& cell = m_cells[idx];
+
+        if (cell.Key == EmptyKey || cell.Count == 0)
+            continue;
+
+        const SphereBounds* pCellBegin = &m_packedBounds[m_packedStart[idx]];
+        const SphereBounds* pCellEnd = pCellBegin + cell.Count;
+
+        // Pairs within the cell
+        for (const SphereBounds* pA = pCellBegin; pA != pCellEnd; ++pA)
+        {
+            for (const SphereBounds* pB = pA + 1; pB != pCellEnd; ++pB)
+                TestPair(*pA, *pB);
+        }
+
+        // Pairs with the neighbor cells
+        int x, y, z;
+        DecodeKey(cell.Key, x, y, z);
+
+        for (int n = 0; n < 13; ++n)
+        {
+            unsigned neighborIdx = FindCell(
+                x + HalfNeighborhood[n][0],
+                y + HalfNeighborhood[n][1],
+                z + HalfNeighborhood[n][2]);
+
+            if (neighborIdx == NullIndex || m_cells[neighborIdx].Count == 0)
+                continue;
+
+            const SphereBounds* pNeighborBegin = &m_packedBounds[m_packedStart[neighborIdx]];
+            const SphereBounds* pNeighborEnd = pNeighborBegin + m_cells[neighborIdx].Count;
+
+            for (const SphereBounds* pA = pCellBegin; pA != pCellEnd; ++pA)
+            {
+                for (const SphereBounds* pB = pNeighborBegin; pB != pNeighborEnd; ++pB)
+                    TestPair(*pA, *pB);
+            }
+        }
+    }
+
+    // Large spheres against the grid cells their box can reach, grid spheres stick out of
+    // their cell by at most half a cell, and against each other
+    const real halfCell = 0.5f * m_cellSize;
+
+    for (size_t i = 0; i < m_largeSpheres.size(); ++i)
+    {
+        const SphereBounds& boundsA = m_bounds[m_largeSpheres[i]];
+        real reach = boundsA.Radius + halfCell;
+
+        for (int x = CellCoord(boundsA.X - reach); x <= CellCoord(boundsA.X + reach); ++x)
+        {
+            for (int y = CellCoord(boundsA.Y - reach); y <= CellCoord(boundsA.Y + reach); ++y)
+            {
+                for (int z = CellCoord(boundsA.Z - reach); z <= CellCoord(boundsA.Z + reach); ++z)
+                {
+                    unsigned cellIdx = FindCell(x, y, z);
+
+                    if (cellIdx == NullIndex)
+                        continue;
+
+                    const SphereBounds* pBegin = &m_packedBounds[m_packedStart[cellIdx]];
+                    const SphereBounds* pEnd = pBegin + m_cells[cellIdx].Count;
+
+                    for (const SphereBounds* pB = pBegin; pB != pEnd; ++pB)
+                        TestPair(boundsA, *pB);
+                }
+            }
+        }
+
+        for (size_t j = i + 1; j < m_largeSpheres.size(); ++j)
+            TestPair(boundsA, m_bounds[m_largeSpheres[j]]);
+    }
+
+    sort(m_pairs.begin(), m_pairs.end(),
+        [](const BroadphasePair& x, const BroadphasePair& y) { return x.A < y.A || (x.A == y.A && x.B < y.B); });
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+
+namespace engiX
+{
+    // A pair of potentially colliding spheres, A < B
+    struct BroadphasePair
+    {
+        BroadphasePair(_In_ unsigned a, _In_ unsigned b) : A(a), B(b) {}
+        unsigned A;
+        unsigned B;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // SpatialHashBroadphase class
+    //
+    // Uniform grid broadphase, the grid is infinite and sparse: only occupied cells are stored in an open addressing
+    // hash table keyed by the cell integer coordinates. Spheres are identified by their index in the SoA arrays fed
+    // to Update (e.g the ParticleIntegrator slots), spheres with 0 radius are not part of the grid.
+    //
+    // Spheres can optionally carry collision layer bits and a mask of the layers they collide with, a pair is only
+    // reported when each sphere mask accepts the other sphere layer. The masks are checked before anything else and
+    // spheres that accept no layer at all are kept out of the grid.
+    //
+    // Each sphere lives in the cell that holds its center, linked to the other spheres of the cell through an
+    // intrusive list. Updates are incremental, a sphere is only relinked when its center crosses to another cell.
+    // A sphere with a diameter up to the cell size can only overlap spheres in its own cell or the 26 cells around
+    // it, pairs are generated by visiting each cell and half of its neighbors so that every pair is reported exactly
+    // once. Spheres larger than a cell are kept aside and tested against the cells their bounding box covers.
+    //
+    // Reported pairs have overlapping bounding boxes, the exact narrowphase test is left to the caller. Pairs are
+    // sorted so that the result does not depend on the hash table layout.
+    //---------------------------------------------------------------------------------------------------------------------
+    class SpatialHashBroadphase
+    {
+    public:
+        static const real DefaultCellSize;
+
+        SpatialHashBroadphase(_In_ real cellSize = DefaultCellSize);
+
+        void Update(_In_ const real* pPosX, _In_ const real* pPosY, _In_ const real* pPosZ, _In_ const real* pRadius, _In_ size_t count,
+            _In_opt_ const unsigned* pLayerBits = nullptr, _In_opt_ const unsigned* pLayerMasks = nullptr);
+        const std::vector<BroadphasePair>& Pairs() const { return m_pairs; }
+        void Clear();
+
+        real CellSize() const { return m_cellSize; }
+        void CellSize(_In_ real cellSize); // Clears the grid
+        size_t CellCount() const { return m_liveCellCount; }
+        size_t SphereCount() const { return m_sphereCount; }
+
+    protected:
+        typedef unsigned long long CellKey;
+
+        // Kept at 16 bytes, pair generation streams through the whole table
+        struct Cell
+        {
+            CellKey Key;
+            unsigned Head;  // first sphere in the cell list
+            unsigned Count;
+        };
+
+        struct SphereBounds
+        {
+            real X, Y, Z, Radius;
+            unsigned Id;
+            unsigned LayerBits;
+            unsigned LayerMask;
+        };
+
+        enum SphereState
+        {
+            SPHERE_None,
+            SPHERE_Grid,
+            SPHERE_Large
+        };
+
+        static const unsigned NullIndex = unsigned(-1);
+        static const CellKey EmptyKey = ~0ULL;
+
+        static CellKey MakeKey(_In_ int x, _In_ int y, _In_ int z);
+        static void DecodeKey(_In_ CellKey key, _Out_ int& x, _Out_ int& y, _Out_ int& z);
+        static size_t HashCell(_In_ int x, _In_ int y, _In_ int z);
+        int CellCoord(_In_ real x) const { return (int)floor(x * m_invCellSize); }
+        unsigned FindCell(_In_ int x, _In_ int y, _In_ int z) const;
+        unsigned FindOrAddCell(_In_ int x, _In_ int y, _In_ int z);
+        void Rehash(_In_ size_t capacity);
+        void AddSphere(_In_ unsigned sphere, _In_ SphereState state, _In_ int x, _In_ int y, _In_ int z);
+        void RemoveSphere(_In_ unsigned sphere);
+        void PackCells();
+        void FindPairs();
+        void TestPair(_In_ const SphereBounds& a, _In_ const SphereBounds& b);
+
+    private:
+        real m_cellSize;
+        real m_invCellSize;
+
+        // Cells hash table, the capacity is a power of 2. Cells that get empty are kept
+        // until the next rehash since open addressing does not support plain removal
+        std::vector<Cell> m_cells;
+        size_t m_usedCellCount;
+        size_t m_liveCellCount;
+
+        // Per sphere state
+        std::vector<unsigned char> m_state;
+        std::vector<unsigned> m_cellIdx;
+        std::vector<unsigned> m_next;
+        std::vector<unsigned> m_prev;
+        std::vector<int> m_cellX;
+        std::vector<int> m_cellY;
+        std::vector<int> m_cellZ;
+        std::vector<SphereBounds> m_bounds;
+        std::vector<unsigned> m_largeSpheres;
+        size_t m_sphereCount;
+
+        // Grid spheres bounds packed cell after cell, see PackCells
+        std::vector<SphereBounds> m_packedBounds;
+        std::vector<unsigned> m_packedStart;
+
+        std::vector<BroadphasePair> m_pairs;
+    };
+}
@@ -45,6 +45,7 @@ namespace engiX
         virtual ~Task();
 
         // interface; these functions should be overridden by the subclass as needed
+        virtual const wchar_t* Typename() const = 0;  // used to group the Task manager statistics per Task type
         virtual bool Init() { return true; }  // called during the first update; responsible for setting the initial state (typically RUNNING)
         virtual void OnUpdate(_In_ const Timer& time) = 0;  // called every frame
         virtual void OnSuccess() { }  // called if the Task succeeds (see below)
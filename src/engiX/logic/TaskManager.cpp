@@ -1,6 +1,10 @@
 #include "TaskManager.h"
+#include <vector>
+#include <algorithm>
+#include "Logger.h"
 
 using namespace engiX;
+using namespace std;
 
 TaskManager::~TaskManager()
 {
@@ -8,14 +12,23 @@ TaskManager::~TaskManager()
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-// The task update tick.  Called every logic tick.  This function returns the number of task chains that 
-// succeeded in the upper 32 bits and the number of task chains that failed or were aborted in the lower 32 bits.
+// The task update tick.  Called every logic tick.  The number of tasks that are alive, succeeded, failed or were
+// aborted during this tick in addition to the number of task chains that succeeded and failed are recorded in the
+// last frame statistics, see LastFrameStats().  When instrumented, the time spent updating each task type is
+// recorded as well, see LastFrameTypeStats().
 //---------------------------------------------------------------------------------------------------------------------
 void TaskManager::OnUpdate(_In_ const Timer& time)
 {
-    unsigned short int successCount = 0;
-    unsigned short int failCount = 0;
     StrongTaskPtr pChild;
+    StopWatch updateWatch;
+    StopWatch taskWatch;
+
+    m_frameStats.Reset();
+    for (auto& typeStats : m_frameTypeStats)
+        typeStats.second.Reset();
+
+    if (m_isInstrumented)
+        updateWatch.Start();
 
     TaskList::iterator it = m_taskList.begin();
     while (it != m_taskList.end())
@@ -27,6 +40,8 @@ void TaskManager::OnUpdate(_In_ const Timer& time)
         TaskList::iterator thisIt = it;
         ++it;
 
+        TaskTypeStats& typeStats = FrameTypeStats(*pCurrTask);
+
         // task is uninitialized, so initialize it
         if (pCurrTask->GetState() == Task::STATE_Uninitialized)
         {
@@ -36,7 +51,23 @@ void TaskManager::OnUpdate(_In_ const Timer& time)
 
         // give the task an update tick if it's running
         if (pCurrTask->GetState() == Task::STATE_Running)
-            pCurrTask->OnUpdate(time);
+        {
+            if (m_isInstrumented)
+            {
+                taskWatch.Start();
+                pCurrTask->OnUpdate(time);
+                real elapsed = taskWatch.Stop();
+
+                typeStats.UpdateTime += elapsed;
+                typeStats.MaxUpdateTime = max(typeStats.MaxUpdateTime, elapsed);
+            }
+            else
+            {
+                pCurrTask->OnUpdate(time);
+            }
+
+            ++typeStats.UpdateCount;
+        }
 
         // check to see if the task is dead
         if (pCurrTask->IsDead())
@@ -46,40 +77,167 @@ void TaskManager::OnUpdate(_In_ const Timer& time)
             {
             case Task::STATE_Succeeded:
                 pCurrTask->OnSuccess();
+                ++typeStats.Succeeded;
+                ++m_frameStats.Succeeded;
                 pChild = pCurrTask->RemoveChild();
                 if (pChild)
-                    AttachTask(pChild);
+                    Attach(pChild, true);
                 else
-                    ++successCount;  // only counts if the whole chain completed
+                    ++m_frameStats.ChainsSucceeded;  // only counts if the whole chain completed
                 break;
 
             case Task::STATE_Failed:
                 pCurrTask->OnFail();
-                ++failCount;
+                ++typeStats.Failed;
+                ++m_frameStats.Failed;
+                ++m_frameStats.ChainsFailed;
                 break;
 
             case Task::STATE_Aborted:
                 pCurrTask->OnAbort();
-                ++failCount;
+                ++typeStats.Aborted;
+                ++m_frameStats.Aborted;
+                ++m_frameStats.ChainsFailed;
                 break;
             }
 
             // remove the task and destroy it
             m_taskList.erase(thisIt);
         }
+        else if (pCurrTask->IsAlive())
+        {
+            ++typeStats.Alive;
+            ++m_frameStats.Alive;
+        }
+    }
+
+    if (m_isInstrumented)
+        m_frameStats.UpdateTime = updateWatch.Stop();
+
+    AccumulatePeriodStats();
+
+    if (m_reportInterval > 0.0f)
+    {
+        m_timeSinceLastReport += time.DeltaTime();
+
+        if (m_timeSinceLastReport >= m_reportInterval)
+        {
+            Report();
+
+            m_timeSinceLastReport = 0.0f;
+            m_framesSinceLastReport = 0;
+            m_periodStats.Reset();
+            for (auto& typeStats : m_periodTypeStats)
+                typeStats.second.Reset();
+        }
+    }
+}
+
+TaskManager::TaskTypeStats& TaskManager::FrameTypeStats(_In_ const Task& task)
+{
+    // Task typenames are string literals, so their address identifies the type
+    // without hashing the whole name every update
+    const wchar_t* pTypename = task.Typename();
+    TaskTypeStats& typeStats = m_frameTypeStats[pTypename];
+    typeStats.pTypename = pTypename;
+
+    return typeStats;
+}
+
+void TaskManager::AccumulatePeriodStats()
+{
+    ++m_framesSinceLastReport;
+
+    m_periodStats.UpdateTime += m_frameStats.UpdateTime;
+    m_periodStats.Alive = max(m_periodStats.Alive, m_frameStats.Alive);
+    m_periodStats.Succeeded += m_frameStats.Succeeded;
+    m_periodStats.Failed += m_frameStats.Failed;
+    m_periodStats.Aborted += m_frameStats.Aborted;
+    m_periodStats.ChainsSucceeded += m_frameStats.ChainsSucceeded;
+    m_periodStats.ChainsFailed += m_frameStats.ChainsFailed;
+
+    for (auto& frameTypeStats : m_frameTypeStats)
+    {
+        const TaskTypeStats& frame = frameTypeStats.second;
+        TaskTypeStats& period = m_periodTypeStats[frameTypeStats.first];
+
+        period.pTypename = frame.pTypename;
+        period.UpdateTime += frame.UpdateTime;
+        period.MaxUpdateTime = max(period.MaxUpdateTime, frame.MaxUpdateTime);
+        period.UpdateCount += frame.UpdateCount;
+        period.Alive = max(period.Alive, frame.Alive);
+        period.Succeeded += frame.Succeeded;
+        period.Failed += frame.Failed;
+        period.Aborted += frame.Aborted;
     }
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Logs the statistics accumulated since the last report, task types are sorted by their total update time so that
+// the task types that eat the frame come first.
+//---------------------------------------------------------------------------------------------------------------------
+void TaskManager::Report() const
+{
+    unsigned frames = max(m_framesSinceLastReport, 1u);
+
+    LogInfo("TaskManager report over %d frames: avg update %fms, peak alive %d, succeeded %d, failed %d, aborted %d, chains succeeded %d, chains failed %d",
+        m_framesSinceLastReport, (m_periodStats.UpdateTime * 1000.0f) / (real)frames, m_periodStats.Alive,
+        m_periodStats.Succeeded, m_periodStats.Failed, m_periodStats.Aborted,
+        m_periodStats.ChainsSucceeded, m_periodStats.ChainsFailed);
+
+    vector<const TaskTypeStats*> sortedStats;
+    for (auto& typeStats : m_periodTypeStats)
+        sortedStats.push_back(&typeStats.second);
+
+    sort(sortedStats.begin(), sortedStats.end(),
+        [](const TaskTypeStats* pA, const TaskTypeStats* pB) { return pA->UpdateTime > pB->UpdateTime; });
+
+    for (auto pStats : sortedStats)
+    {
+        LogInfo("  %s: avg update %fms, max update %fms, updates %d, peak alive %d, succeeded %d, failed %d, aborted %d, chains %d, avg chain length %f, max chain length %d",
+            pStats->pTypename,
+            (pStats->UpdateTime * 1000.0f) / (real)frames,
+            pStats->MaxUpdateTime * 1000.0f,
+            pStats->UpdateCount, pStats->Alive,
+            pStats->Succeeded, pStats->Failed, pStats->Aborted,
+            pStats->ChainsStarted,
+            pStats->ChainsStarted > 0 ? (real)pStats->TotalChainLength / (real)pStats->ChainsStarted : 0.0f,
+            pStats->MaxChainLength);
+    }
+}
 
 //---------------------------------------------------------------------------------------------------------------------
 // Attaches the task to the task list so it can be run on the next update.
 //---------------------------------------------------------------------------------------------------------------------
 WeakTaskPtr TaskManager::AttachTask(StrongTaskPtr pTask)
 {
-    m_taskList.push_front(pTask);
+    Attach(pTask, false);
     return WeakTaskPtr(pTask);
 }
 
+void TaskManager::Attach(StrongTaskPtr pTask, bool isChainContinuation)
+{
+    m_taskList.push_front(pTask);
+
+    // Chain length is recorded once per chain, when its root is attached from outside the
+    // manager, children attached after their parent succeeds are part of the same chain
+    if (!isChainContinuation)
+    {
+        unsigned chainLength = 1;
+        for (StrongTaskPtr pChild = pTask->PeekChild(); pChild; pChild = pChild->PeekChild())
+            ++chainLength;
+
+        // Chains are usually attached outside the update tick, so record them directly
+        // in the period statistics instead of the last frame ones that get reset
+        const wchar_t* pTypename = pTask->Typename();
+        TaskTypeStats& typeStats = m_periodTypeStats[pTypename];
+        typeStats.pTypename = pTypename;
+        ++typeStats.ChainsStarted;
+        typeStats.TotalChainLength += chainLength;
+        typeStats.MaxChainLength = max(typeStats.MaxChainLength, chainLength);
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 // Clears all taskes (and DOESN'T run any exit code)
 //---------------------------------------------------------------------------------------------------------------------
@@ -89,7 +247,7 @@ void TaskManager::ClearAllTaskes()
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-// Aborts all taskes.  If immediate == true, it immediately calls each ones OnAbort() function and destroys all 
+// Aborts all taskes.  If immediate == true, it immediately calls each ones OnAbort() function and destroys all
 // the taskes.
 //---------------------------------------------------------------------------------------------------------------------
 void TaskManager::AbortAllTaskes(bool immediate)
@@ -111,4 +269,4 @@ void TaskManager::AbortAllTaskes(bool immediate)
             }
         }
     }
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <unordered_map>
 #include "Task.h"
 
 namespace engiX
@@ -8,6 +9,65 @@ namespace engiX
     class TaskManager
     {
     public:
+        // Statistics of a single Task type, either for the last frame or
+        // accumulated over the current report period
+        struct TaskTypeStats
+        {
+            TaskTypeStats() :
+                pTypename(nullptr)
+            { Reset(); }
+
+            void Reset()
+            {
+                UpdateTime = 0.0f;
+                MaxUpdateTime = 0.0f;
+                UpdateCount = 0;
+                Alive = Succeeded = Failed = Aborted = 0;
+                ChainsStarted = TotalChainLength = MaxChainLength = 0;
+            }
+
+            const wchar_t* pTypename;
+            real UpdateTime;        // total seconds spent in OnUpdate
+            real MaxUpdateTime;     // the most expensive single OnUpdate call in seconds
+            unsigned UpdateCount;   // number of OnUpdate calls
+            unsigned Alive;         // tasks of this type still running at the end of the update
+            unsigned Succeeded;
+            unsigned Failed;
+            unsigned Aborted;
+            // Chain statistics are only tracked over the report period, see PeriodTypeStats()
+            unsigned ChainsStarted;     // chains attached from outside the manager rooted at this type
+            unsigned TotalChainLength;  // sum of the started chains length, divide by ChainsStarted for average
+            unsigned MaxChainLength;
+        };
+
+        struct FrameStats
+        {
+            FrameStats() { Reset(); }
+
+            void Reset()
+            {
+                UpdateTime = 0.0f;
+                Alive = Succeeded = Failed = Aborted = 0;
+                ChainsSucceeded = ChainsFailed = 0;
+            }
+
+            real UpdateTime;
+            unsigned Alive;
+            unsigned Succeeded;
+            unsigned Failed;
+            unsigned Aborted;
+            unsigned ChainsSucceeded;   // whole chains that completed successfully
+            unsigned ChainsFailed;      // chains that failed or were aborted
+        };
+
+        typedef std::unordered_map<const wchar_t*, TaskTypeStats> TaskTypeStatsRegistry;
+
+        TaskManager() :
+            m_isInstrumented(true),
+            m_reportInterval(0.0f),
+            m_timeSinceLastReport(0.0f),
+            m_framesSinceLastReport(0)
+        {}
         virtual ~TaskManager();
 
         // interface
@@ -18,10 +78,32 @@ namespace engiX
         // accessors
         unsigned GetTaskCount(void) const { return m_taskList.size(); }
 
+        // instrumentation
+        void Instrument(_In_ bool enable) { m_isInstrumented = enable; }
+        bool IsInstrumented() const { return m_isInstrumented; }
+        void ReportInterval(_In_ real seconds) { m_reportInterval = seconds; } // 0 disables the periodic report
+        real ReportInterval() const { return m_reportInterval; }
+        const FrameStats& LastFrameStats() const { return m_frameStats; }
+        const TaskTypeStatsRegistry& LastFrameTypeStats() const { return m_frameTypeStats; }
+        const TaskTypeStatsRegistry& PeriodTypeStats() const { return m_periodTypeStats; }
+        void Report() const;
+
     private:
+        void Attach(StrongTaskPtr pTask, bool isChainContinuation);
         void ClearAllTaskes(void);  // should only be called by the destructor
+        TaskTypeStats& FrameTypeStats(_In_ const Task& task);
+        void AccumulatePeriodStats();
 
         typedef std::list<StrongTaskPtr> TaskList;
         TaskList m_taskList;
+
+        bool m_isInstrumented;
+        real m_reportInterval;
+        real m_timeSinceLastReport;
+        unsigned m_framesSinceLastReport;
+        FrameStats m_frameStats;
+        FrameStats m_periodStats;
+        TaskTypeStatsRegistry m_frameTypeStats;
+        TaskTypeStatsRegistry m_periodTypeStats;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,188 @@
+#include "TransformAnimator.h"
+#include "TransformCmpt.h"
+#include "Logger.h"
+#include "Simd.h"
+
+using namespace engiX;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+bool TransformAnimator::AddTrack(_In_ Actor& actor, _In_ const Vec3& angularVelocity, _In_ const Vec3& linearVelocity)
+{
+    CBRB(actor.HasA<TransformCmpt>());
+
+    if (HasTrack(actor.Id()))
+    {
+        LogWarning("Actor %s[%d] already has an animation track, updating its velocities", actor.Typename(), actor.Id());
+        AngularVelocity(actor.Id(), angularVelocity);
+        LinearVelocity(actor.Id(), linearVelocity);
+        return true;
+    }
+
+    TransformCmpt& tsfm = actor.Get<TransformCmpt>();
+    Vec3 rot = tsfm.Rotation();
+    Vec3 pos = tsfm.Position();
+
+    m_trackIndex[actor.Id()] = m_actorIds.size();
+    m_actorIds.push_back(actor.Id());
+    m_transforms.push_back(&tsfm);
+    m_animatesPosition.push_back(linearVelocity.x != 0.0f || linearVelocity.y != 0.0f || linearVelocity.z != 0.0f);
+
+    m_rotX.push_back(rot.x);
+    m_rotY.push_back(rot.y);
+    m_rotZ.push_back(rot.z);
+    m_posX.push_back(pos.x);
+    m_posY.push_back(pos.y);
+    m_posZ.push_back(pos.z);
+
+    m_angVelX.push_back(angularVelocity.x);
+    m_angVelY.push_back(angularVelocity.y);
+    m_angVelZ.push_back(angularVelocity.z);
+    m_linVelX.push_back(linearVelocity.x);
+    m_linVelY.push_back(linearVelocity.y);
+    m_linVelZ.push_back(linearVelocity.z);
+
+    LogVerbose("Animation track added for Actor %s[%d]", actor.Typename(), actor.Id());
+
+    return true;
+}
+
+bool TransformAnimator::RemoveTrack(_In_ ActorID actorId)
+{
+    auto where = m_trackIndex.find(actorId);
+
+    if (where == m_trackIndex.end())
+        return false;
+
+    // Remove by swapping the last track into the removed track slot to keep
+    // the arrays dense
+    size_t idx = where->second;
+    size_t last = m_actorIds.size() - 1;
+
+    if (idx != last)
+    {
+        m_actorIds[idx] = m_actorIds[last];
+        m_transforms[idx] = m_transforms[last];
+        m_animatesPosition[idx] = m_animatesPosition[last];
+        m_rotX[idx] = m_rotX[last];
+        m_rotY[idx] = m_rotY[last];
+        m_rotZ[idx] = m_rotZ[last];
+        m_posX[idx] = m_posX[last];
+        m_posY[idx] = m_posY[last];
+        m_posZ[idx] = m_posZ[last];
+        m_angVelX[idx] = m_angVelX[last];
+        m_angVelY[idx] = m_angVelY[last];
+        m_angVelZ[idx] = m_angVelZ[last];
+        m_linVelX[idx] = m_linVelX[last];
+        m_linVelY[idx] = m_linVelY[last];
+        m_linVelZ[idx] = m_linVelZ[last];
+
+        m_trackIndex[m_actorIds[idx]] = idx;
+    }
+
+    m_actorIds.pop_back();
+    m_transforms.pop_back();
+    m_animatesPosition.pop_back();
+    m_rotX.pop_back();
+    m_rotY.pop_back();
+    m_rotZ.pop_back();
+    m_posX.pop_back();
+    m_posY.pop_back();
+    m_posZ.pop_back();
+    m_angVelX.pop_back();
+    m_angVelY.pop_back();
+    m_angVelZ.pop_back();
+    m_linVelX.pop_back();
+    m_linVelY.pop_back();
+    m_linVelZ.pop_back();
+
+    m_trackIndex.erase(where);
+
+    return true;
+}
+
+void TransformAnimator::AngularVelocity(_In_ ActorID actorId, _In_ const Vec3& angularVelocity)
+{
+    auto where = m_trackIndex.find(actorId);
+    CBR(where != m_trackIndex.end());
+
+    m_angVelX[where->second] = angularVelocity.x;
+    m_angVelY[where->second] = angularVelocity.y;
+    m_angVelZ[where->second] = angularVelocity.z;
+}
+
+void TransformAnimator::LinearVelocity(_In_ ActorID actorId, _In_ const Vec3& linearVelocity)
+{
+    auto where = m_trackIndex.find(actorId);
+    CBR(where != m_trackIndex.end());
+
+    m_linVelX[where->second] = linearVelocity.x;
+    m_linVelY[where->second] = linearVelocity.y;
+    m_linVelZ[where->second] = linearVelocity.z;
+    m_animatesPosition[where->second] = (linearVelocity.x != 0.0f || linearVelocity.y != 0.0f || linearVelocity.z != 0.0f);
+}
+
+void TransformAnimator::OnUpdate(_In_ const Timer& time)
+{
+    if (m_actorIds.empty())
+        return;
+
+    Integrate(time.DeltaTime());
+    WriteTransforms();
+}
+
+void TransformAnimator::Integrate(_In_ real dt)
+{
+    const size_t count = m_actorIds.size();
+#if !defined(ENGIX_SIMD_SCALAR)
+    const size_t simdCount = count & ~size_t(3);
+    XMVECTOR vDt = XMVectorReplicate(dt);
+
+    // x = x0 + v * dt, for 4 tracks at a time
+    // The SoA arrays are 32-byte aligned and we step in multiples of 4
+    // elements so that every XMLoadFloat4A starts on a 16-byte boundary
+    for (size_t i = 0; i < simdCount; i += 4)
+    {
+        XMStoreFloat4A((XMFLOAT4A*)&m_rotX[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_angVelX[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_rotX[i])));
+        XMStoreFloat4A((XMFLOAT4A*)&m_rotY[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_angVelY[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_rotY[i])));
+        XMStoreFloat4A((XMFLOAT4A*)&m_rotZ[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_angVelZ[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_rotZ[i])));
+        XMStoreFloat4A((XMFLOAT4A*)&m_posX[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_linVelX[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_posX[i])));
+        XMStoreFloat4A((XMFLOAT4A*)&m_posY[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_linVelY[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_posY[i])));
+        XMStoreFloat4A((XMFLOAT4A*)&m_posZ[i], XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_linVelZ[i]), vDt, XMLoadFloat4A((const XMFLOAT4A*)&m_posZ[i])));
+    }
+#else
+    // The scalar tail covers all the tracks
+    const size_t simdCount = 0;
+#endif
+
+    // Scalar tail for the remaining tracks
+    for (size_t i = simdCount; i < count; ++i)
+    {
+        m_rotX[i] += m_angVelX[i] * dt;
+        m_rotY[i] += m_angVelY[i] * dt;
+        m_rotZ[i] += m_angVelZ[i] * dt;
+        m_posX[i] += m_linVelX[i] * dt;
+        m_posY[i] += m_linVelY[i] * dt;
+        m_posZ[i] += m_linVelZ[i] * dt;
+    }
+}
+
+void TransformAnimator::WriteTransforms()
+{
+    const size_t count = m_actorIds.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        TransformCmpt* pTsfm = m_transforms[i];
+        _ASSERTE(pTsfm);
+
+        // Leave the position alone when it is not animated so that the actor
+        // keeps whatever interpolation state the physics simulation gave it
+        if (m_animatesPosition[i])
+            pTsfm->Transform(Vec3(m_rotX[i], m_rotY[i], m_rotZ[i]), Vec3(m_posX[i], m_posY[i], m_posZ[i]));
+        else
+            pTsfm->Rotation(Vec3(m_rotX[i], m_rotY[i], m_rotZ[i]));
+    }
+}
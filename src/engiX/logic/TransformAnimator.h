@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "engiXDefs.h"
+#include "AlignedAllocator.h"
+#include "Timer.h"
+#include "Actor.h"
+
+namespace engiX
+{
+    class TransformCmpt;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // TransformAnimator class
+    //
+    // Batched replacement for per-actor animation tasks (e.g ActorTurnTask). Each animated actor owns a track that
+    // holds its angular and linear velocities, tracks are stored as structure-of-arrays (SoA) so that all of them
+    // are integrated in one SIMD pass, 4 tracks per instruction, and the result is written back to each actor
+    // TransformCmpt exactly once per frame.
+    //
+    // The animator is authoritative over the rotation of the animated actors, and over their position only if the
+    // track was given a non-zero linear velocity, this way a physics driven actor can still be spun by the animator.
+    //---------------------------------------------------------------------------------------------------------------------
+    class TransformAnimator
+    {
+    public:
+        void OnUpdate(_In_ const Timer& time);
+        bool AddTrack(_In_ Actor& actor, _In_ const Vec3& angularVelocity, _In_ const Vec3& linearVelocity = Vec3(0.0f, 0.0f, 0.0f));
+        bool RemoveTrack(_In_ ActorID actorId);
+        bool HasTrack(_In_ ActorID actorId) const { return m_trackIndex.count(actorId) > 0; }
+        void AngularVelocity(_In_ ActorID actorId, _In_ const Vec3& angularVelocity);
+        void LinearVelocity(_In_ ActorID actorId, _In_ const Vec3& linearVelocity);
+        size_t TrackCount() const { return m_actorIds.size(); }
+
+    protected:
+        void Integrate(_In_ real dt);
+        void WriteTransforms();
+
+    private:
+        std::vector<ActorID> m_actorIds;
+        std::vector<TransformCmpt*> m_transforms;
+        std::vector<bool> m_animatesPosition;
+        std::unordered_map<ActorID, size_t> m_trackIndex;
+
+        // Animated state
+        RealArray m_rotX;
+        RealArray m_rotY;
+        RealArray m_rotZ;
+        RealArray m_posX;
+        RealArray m_posY;
+        RealArray m_posZ;
+
+        // Tracks
+        RealArray m_angVelX;
+        RealArray m_angVelY;
+        RealArray m_angVelZ;
+        RealArray m_linVelX;
+        RealArray m_linVelY;
+        RealArray m_linVelZ;
+    };
+}
@@ -0,0 +1,192 @@
+#include "TransformBatch.h"
+#include "TransformCmpt.h"
+#include "Simd.h"
+
+using namespace engiX;
+using namespace std;
+#if !defined(ENGIX_SIMD_SCALAR)
+using namespace DirectX;
+#endif
+
+void TransformBatch::Queue(_In_ TransformCmpt* pTsfm)
+{
+    _ASSERTE(pTsfm);
+
+    if (pTsfm->m_queueIdx != NullQueueIdx)
+        return;
+
+    pTsfm->m_queueIdx = m_queue.size();
+    m_queue.push_back(pTsfm);
+}
+
+void TransformBatch::Dequeue(_In_ TransformCmpt* pTsfm)
+{
+    size_t idx = pTsfm->m_queueIdx;
+
+    if (idx == NullQueueIdx)
+        return;
+
+    _ASSERTE(m_queue[idx] == pTsfm);
+
+    // Swap the last transform into the removed one spot
+    m_queue[idx] = m_queue.back();
+    m_queue[idx]->m_queueIdx = idx;
+    m_queue.pop_back();
+
+    pTsfm->m_queueIdx = NullQueueIdx;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Same quaternion and matrix as TransformCmpt::CalcTransform. With p, y, r the half X, Y, Z angles, the Z then X
+// then Y rotation quaternion is:
+//   x = sp*cy*cr + cp*sy*sr
+//   y = cp*sy*cr - sp*cy*sr
+//   z = cp*cy*sr - sp*sy*cr
+//   w = cp*cy*cr + sp*sy*sr
+// and the matrix rows are the quaternion rotation rows times the scale, see QuatTransform::ToMatrix.
+//---------------------------------------------------------------------------------------------------------------------
+void TransformBatch::Update()
+{
+    const size_t count = m_queue.size();
+
+    if (count == 0)
+        return;
+
+    const size_t paddedCount = Simd::PaddedCount(count);
+
+    m_rotX.resize(paddedCount, 0.0f);
+    m_rotY.resize(paddedCount, 0.0f);
+    m_rotZ.resize(paddedCount, 0.0f);
+    m_scale.resize(paddedCount, 1.0f);
+
+    for (int c = 0; c < 4; ++c)
+        m_quat[c].resize(paddedCount);
+
+    for (int c = 0; c < 9; ++c)
+        m_rows[c].resize(paddedCount);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const TransformCmpt* pTsfm = m_queue[i];
+
+        m_rotX[i] = pTsfm->m_rotationXYZ.x;
+        m_rotY[i] = pTsfm->m_rotationXYZ.y;
+        m_rotZ[i] = pTsfm->m_rotationXYZ.z;
+        m_scale[i] = pTsfm->m_scale;
+    }
+
+#if !defined(ENGIX_SIMD_SCALAR)
+    const XMVECTOR half = XMVectorReplicate(0.5f);
+    const XMVECTOR one = XMVectorReplicate(1.0f);
+    const XMVECTOR two = XMVectorReplicate(2.0f);
+
+    for (size_t i = 0; i < paddedCount; i += 4)
+    {
+        XMVECTOR sp, cp, sy, cy, sr, cr;
+
+        XMVectorSinCos(&sp, &cp, XMVectorMultiply(Simd::Load4(m_rotX.data() + i), half));
+        XMVectorSinCos(&sy, &cy, XMVectorMultiply(Simd::Load4(m_rotY.data() + i), half));
+        XMVectorSinCos(&sr, &cr, XMVectorMultiply(Simd::Load4(m_rotZ.data() + i), half));
+
+        XMVECTOR spcy = XMVectorMultiply(sp, cy);
+        XMVECTOR cpsy = XMVectorMultiply(cp, sy);
+        XMVECTOR cpcy = XMVectorMultiply(cp, cy);
+        XMVECTOR spsy = XMVectorMultiply(sp, sy);
+
+        XMVECTOR x = XMVectorMultiplyAdd(spcy, cr, XMVectorMultiply(cpsy, sr));
+        XMVECTOR y = XMVectorNegativeMultiplySubtract(spcy, sr, XMVectorMultiply(cpsy, cr));
+        XMVECTOR z = XMVectorNegativeMultiplySubtract(spsy, cr, XMVectorMultiply(cpcy, sr));
+        XMVECTOR w = XMVectorMultiplyAdd(spsy, sr, XMVectorMultiply(cpcy, cr));
+
+        Simd::Store4(m_quat[0].data() + i, x);
+        Simd::Store4(m_quat[1].data() + i, y);
+        Simd::Store4(m_quat[2].data() + i, z);
+        Simd::Store4(m_quat[3].data() + i, w);
+
+        XMVECTOR xx = XMVectorMultiply(x, x);
+        XMVECTOR yy = XMVectorMultiply(y, y);
+        XMVECTOR zz = XMVectorMultiply(z, z);
+        XMVECTOR xy = XMVectorMultiply(x, y);
+        XMVECTOR xz = XMVectorMultiply(x, z);
+        XMVECTOR yz = XMVectorMultiply(y, z);
+        XMVECTOR xw = XMVectorMultiply(x, w);
+        XMVECTOR yw = XMVectorMultiply(y, w);
+        XMVECTOR zw = XMVectorMultiply(z, w);
+
+        // Twice the scale folds the off diagonal factor 2 and the scale in one multiply
+        XMVECTOR scale = Simd::Load4(m_scale.data() + i);
+        XMVECTOR scale2 = XMVectorMultiply(scale, two);
+
+        Simd::Store4(m_rows[0].data() + i, XMVectorMultiply(scale, XMVectorNegativeMultiplySubtract(two, XMVectorAdd(yy, zz), one)));
+        Simd::Store4(m_rows[1].data() + i, XMVectorMultiply(scale2, XMVectorAdd(xy, zw)));
+        Simd::Store4(m_rows[2].data() + i, XMVectorMultiply(scale2, XMVectorSubtract(xz, yw)));
+        Simd::Store4(m_rows[3].data() + i, XMVectorMultiply(scale2, XMVectorSubtract(xy, zw)));
+        Simd::Store4(m_rows[4].data() + i, XMVectorMultiply(scale, XMVectorNegativeMultiplySubtract(two, XMVectorAdd(xx, zz), one)));
+        Simd::Store4(m_rows[5].data() + i, XMVectorMultiply(scale2, XMVectorAdd(yz, xw)));
+        Simd::Store4(m_rows[6].data() + i, XMVectorMultiply(scale2, XMVectorAdd(xz, yw)));
+        Simd::Store4(m_rows[7].data() + i, XMVectorMultiply(scale2, XMVectorSubtract(yz, xw)));
+        Simd::Store4(m_rows[8].data() + i, XMVectorMultiply(scale, XMVectorNegativeMultiplySubtract(two, XMVectorAdd(xx, yy), one)));
+    }
+#else
+    for (size_t i = 0; i < paddedCount; ++i)
+    {
+        real sp = real_sin(0.5f * m_rotX[i]), cp = real_cos(0.5f * m_rotX[i]);
+        real sy = real_sin(0.5f * m_rotY[i]), cy = real_cos(0.5f * m_rotY[i]);
+        real sr = real_sin(0.5f * m_rotZ[i]), cr = real_cos(0.5f * m_rotZ[i]);
+
+        real x = sp * cy * cr + cp * sy * sr;
+        real y = cp * sy * cr - sp * cy * sr;
+        real z = cp * cy * sr - sp * sy * cr;
+        real w = cp * cy * cr + sp * sy * sr;
+
+        m_quat[0][i] = x;
+        m_quat[1][i] = y;
+        m_quat[2][i] = z;
+        m_quat[3][i] = w;
+
+        real scale = m_scale[i];
+        real scale2 = 2.0f * scale;
+
+        m_rows[0][i] = scale * (1.0f - 2.0f * (y * y + z * z));
+        m_rows[1][i] = scale2 * (x * y + z * w);
+        m_rows[2][i] = scale2 * (x * z - y * w);
+        m_rows[3][i] = scale2 * (x * y - z * w);
+        m_rows[4][i] = scale * (1.0f - 2.0f * (x * x + z * z));
+        m_rows[5][i] = scale2 * (y * z + x * w);
+        m_rows[6][i] = scale2 * (x * z + y * w);
+        m_rows[7][i] = scale2 * (y * z - x * w);
+        m_rows[8][i] = scale * (1.0f - 2.0f * (x * x + y * y));
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        TransformCmpt* pTsfm = m_queue[i];
+        pTsfm->m_queueIdx = NullQueueIdx;
+
+        // The quaternion and matrix were computed on the spot since the transform got queued
+        if (!pTsfm->m_isDirty)
+            continue;
+
+        Vec4& q = pTsfm->m_rotation;
+        Mat4x4& m = pTsfm->m_transform;
+
+        q.x = m_quat[0][i];
+        q.y = m_quat[1][i];
+        q.z = m_quat[2][i];
+        q.w = m_quat[3][i];
+
+        m._11 = m_rows[0][i]; m._12 = m_rows[1][i]; m._13 = m_rows[2][i]; m._14 = 0.0f;
+        m._21 = m_rows[3][i]; m._22 = m_rows[4][i]; m._23 = m_rows[5][i]; m._24 = 0.0f;
+        m._31 = m_rows[6][i]; m._32 = m_rows[7][i]; m._33 = m_rows[8][i]; m._34 = 0.0f;
+        m._41 = pTsfm->m_pos.x;
+        m._42 = pTsfm->m_pos.y;
+        m._43 = pTsfm->m_pos.z;
+        m._44 = 1.0f;
+
+        pTsfm->m_isDirty = false;
+    }
+
+    m_queue.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "AlignedAllocator.h"
+
+namespace engiX
+{
+    class TransformCmpt;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // TransformBatch class
+    //
+    // Queue of the TransformCmpt whose quaternion and world matrix are out of date after a rotation or scale change.
+    // Update rebuilds all of them at once: the Euler angles and scales are gathered in structure-of-arrays (SoA), the
+    // half angle sines and cosines, the quaternions and the matrix terms are computed 4 transforms per instruction,
+    // then each quaternion and matrix is written back once. GameLogic runs it at the end of the logic update, right
+    // before the view reads the transforms.
+    //
+    // A transform read before the batch runs computes its own quaternion and matrix on the spot, see
+    // TransformCmpt::Transform.
+    //---------------------------------------------------------------------------------------------------------------------
+    class TransformBatch
+    {
+    public:
+        static const size_t NullQueueIdx = size_t(-1);
+
+        void Queue(_In_ TransformCmpt* pTsfm);
+        void Dequeue(_In_ TransformCmpt* pTsfm);
+        void Update();
+        size_t QueuedCount() const { return m_queue.size(); }
+
+    private:
+        std::vector<TransformCmpt*> m_queue;
+
+        // Euler angles and scale in, quaternion and matrix rotation rows out
+        RealArray m_rotX;
+        RealArray m_rotY;
+        RealArray m_rotZ;
+        RealArray m_scale;
+        RealArray m_quat[4];
+        RealArray m_rows[9];
+    };
+}
@@ -1,84 +1,149 @@
 #include "TransformCmpt.h"
+#include "TransformBatch.h"
+#include "GameApp.h"
+#include "GameLogic.h"
 
 using namespace engiX;
-using namespace DirectX;
+using namespace engiX::VecMath;
+
+const ComponentID TransformCmpt::TypeID;
 
 TransformCmpt::TransformCmpt() :
-m_rotationXYZ(DirectX::g_XMZero)
+m_rotationXYZ(0.0f, 0.0f, 0.0f),
+m_scale(1.0f),
+m_pos(0.0f, 0.0f, 0.0f),
+m_prevPos(0.0f, 0.0f, 0.0f),
+m_pBatch(&g_pApp->Logic()->Transforms()),
+m_queueIdx(TransformBatch::NullQueueIdx),
+m_isDirty(false),
+m_rotation(0.0f, 0.0f, 0.0f, 1.0f)
+{
+    StoreMatrix(m_transform, MatrixIdentity());
+}
+
+TransformCmpt::~TransformCmpt()
 {
-    XMStoreFloat4x4(&m_transform, XMMatrixIdentity());
+    m_pBatch->Dequeue(this);
 }
 
+// World to local, the inverse rotation is the quaternion conjugate instead of a general 4x4 matrix inverse
 Mat4x4 TransformCmpt::InverseTransform() const
 {
-    Mat4x4 rotMat = CalcRotationMat();
-    Mat4x4 invTsfm;
+    return World().Inverse().ToMatrix();
+}
 
-    XMStoreFloat4x4(&invTsfm,
-        XMMatrixTranspose(XMLoadFloat4x4(&rotMat)));
+Vec3 TransformCmpt::Direction() const
+{
+    return World().Forward();
+}
 
-    invTsfm._41 = -m_pos.x;
-    invTsfm._42 = -m_pos.y;
-    invTsfm._43 = -m_pos.z;
+// Copies the quaternion and matrix along with the rotation instead of rebuilding them
+void TransformCmpt::Transform(_In_ const TransformCmpt& tsfm)
+{
+    m_rotationXYZ = tsfm.m_rotationXYZ;
+    m_scale = tsfm.m_scale;
+    m_pos = m_prevPos = tsfm.m_pos;
+    m_rotation = tsfm.Orientation();
+    m_transform = tsfm.Transform();
+    m_isDirty = false;
+}
 
-    return invTsfm;
+void TransformCmpt::Transform(_In_ const Vec3& rotationXYZ, _In_ const Vec3& pos)
+{
+    m_rotationXYZ = rotationXYZ;
+    m_pos = m_prevPos = pos;
+    InvalidateRotation();
+    WriteTranslation();
 }
 
-Mat4x4 TransformCmpt::CalcRotationMat() const
+void TransformCmpt::RotationY(_In_ real theta)
 {
-    Mat4x4 rotMat;
+    m_rotationXYZ.y = theta;
+    InvalidateRotation();
+}
 
-    XMStoreFloat4x4(&rotMat,
-        XMMatrixMultiply(
-        XMMatrixRotationX(m_rotationXYZ.x),
-        XMMatrixRotationY(m_rotationXYZ.y)));
+void TransformCmpt::RotationX(_In_ real theta)
+{
+    m_rotationXYZ.x = theta;
+    InvalidateRotation();
+}
 
-    return rotMat;
+void TransformCmpt::RotationZ(_In_ real theta)
+{
+    m_rotationXYZ.z = theta;
+    InvalidateRotation();
 }
 
-Vec3 TransformCmpt::Direction() const
+void TransformCmpt::Rotation(_In_ const Vec3& rotationXYZ)
 {
-    Mat4x4 rotMat = Transform();
-    rotMat._41 = rotMat._42 = rotMat._43 = 0.0f;
+    m_rotationXYZ = rotationXYZ;
+    InvalidateRotation();
+}
 
-    Vec3 dir;
+// The Euler angles stay the authored rotation, they are extracted back from the quaternion
+void TransformCmpt::Orientation(_In_ const Vec4& rotation)
+{
+    m_rotationXYZ = QuatTransform::QuaternionToEuler(rotation);
+    InvalidateRotation();
+}
 
-    XMStoreFloat3(&dir,
-        XMVector3Transform(g_XMIdentityR2,
-        XMLoadFloat4x4(&rotMat)));
+void TransformCmpt::Scale(_In_ real scale)
+{
+    _ASSERTE(scale > 0.0f);
 
-    return dir;
+    m_scale = scale;
+    InvalidateRotation();
 }
 
-void TransformCmpt::Transform(_In_ const TransformCmpt& tsfm)
+// Setting the position directly teleports the actor, there is nothing to interpolate from
+void TransformCmpt::Position(_In_ const Vec3& newPos)
 {
-    m_rotationXYZ = tsfm.m_rotationXYZ;
-    m_pos = tsfm.m_pos;
-    CalcTransform();
+    m_pos = m_prevPos = newPos;
+    WriteTranslation();
 }
 
-void TransformCmpt::RotationY(_In_ real theta)
+// Position set by the fixed step physics simulation along with the position at the previous
+// simulation step, the view interpolates between both, see InterpolatedTransform
+void TransformCmpt::SimulatedPosition(_In_ const Vec3& prevPos, _In_ const Vec3& pos)
 {
-    m_rotationXYZ.y = theta;
-    CalcTransform();
+    m_prevPos = prevPos;
+    m_pos = pos;
+    WriteTranslation();
 }
 
-void TransformCmpt::RotationX(_In_ real theta)
+Mat4x4 TransformCmpt::InterpolatedTransform(_In_ real alpha) const
 {
-    m_rotationXYZ.x = theta;
-    CalcTransform();
+    Mat4x4 tsfm = Transform();
+
+    // p = p0 + (p1 - p0) * alpha
+    Vec3 pos = ToVec3(Lerp(Load3(m_prevPos), Load3(m_pos), alpha));
+
+    tsfm._41 = pos.x;
+    tsfm._42 = pos.y;
+    tsfm._43 = pos.z;
+
+    return tsfm;
 }
 
-void TransformCmpt::Position(_In_ const Vec3& newPos)
+void TransformCmpt::CalcTransform() const
 {
-    m_pos = newPos;
-    CalcTransform();
+    QuatTransform world(QuatTransform::EulerToQuaternion(m_rotationXYZ), m_pos, m_scale);
+
+    m_rotation = world.Rotation;
+    m_transform = world.ToMatrix();
+
+    m_isDirty = false;
 }
 
-void TransformCmpt::CalcTransform()
+void TransformCmpt::InvalidateRotation()
 {
-    m_transform = CalcRotationMat();
+    m_isDirty = true;
+    m_pBatch->Queue(this);
+}
 
+// The translation row does not depend on the rotation, it is kept up to date even while the rotation is dirty
+void TransformCmpt::WriteTranslation()
+{
     m_transform._41 = m_pos.x;
     m_transform._42 = m_pos.y;
     m_transform._43 = m_pos.z;
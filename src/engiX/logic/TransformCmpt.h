@@ -2,39 +2,74 @@
 
 #include "engiXDefs.h"
 #include "Actor.h"
+#include "QuatTransform.h"
 
 namespace engiX
 {
+    class TransformBatch;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // TransformCmpt class
+    //
+    // Rotation, uniform scale and position of an actor along with its world matrix. The rotation is authored as
+    // Euler angles applied Z, then X, then Y and kept as a quaternion too, see World. Position changes only write the
+    // matrix translation, rotation and scale changes mark the quaternion and matrix dirty and queue the transform in
+    // the GameLogic TransformBatch which rebuilds all of them in one pass per frame. Reading either before that
+    // rebuilds it on the spot, so readers always get up to date values.
+    //---------------------------------------------------------------------------------------------------------------------
     class TransformCmpt : public ActorComponent
     {
+        friend class TransformBatch;
+
     public:
         DECLARE_COMPONENT(TransformCmpt, 0x76EE7B4E);
 
         TransformCmpt();
+        ~TransformCmpt();
         void OnUpdate(_In_ const Timer& time) {}
         bool Init() {  return true; }
 
         real RotationY() const { return m_rotationXYZ.y; }
         real RotationX() const { return m_rotationXYZ.x; }
+        real RotationZ() const { return m_rotationXYZ.z; }
+        Vec3 Rotation() const { return m_rotationXYZ; }
+        const Vec4& Orientation() const { if (m_isDirty) CalcTransform(); return m_rotation; }
+        real Scale() const { return m_scale; }
+        QuatTransform World() const { return QuatTransform(Orientation(), m_pos, m_scale); }
         Mat4x4 InverseTransform() const;
         Vec3 Position() const { return m_pos; }
+        Vec3 PreviousPosition() const { return m_prevPos; }
         Vec3 Direction() const;
         void RotationY(_In_ real theta);
         void RotationX(_In_ real theta);
+        void RotationZ(_In_ real theta);
         
+        void Rotation(_In_ const Vec3& rotationXYZ);
+        void Orientation(_In_ const Vec4& rotation);
+        void Scale(_In_ real scale);
         void Position(_In_ const Vec3& newPos);
+        void SimulatedPosition(_In_ const Vec3& prevPos, _In_ const Vec3& pos);
         void Transform(_In_ const TransformCmpt& tsfm);
-        const Mat4x4& Transform() const { return m_transform; }
+        void Transform(_In_ const Vec3& rotationXYZ, _In_ const Vec3& pos);
+        const Mat4x4& Transform() const { if (m_isDirty) CalcTransform(); return m_transform; }
+        Mat4x4 InterpolatedTransform(_In_ real alpha) const;
 
     protected:
-        void CalcTransform();
-        Mat4x4 CalcRotationMat() const;
+        void CalcTransform() const;
+        void InvalidateRotation();
+        void WriteTranslation();
 
         Vec3 m_rotationXYZ;
+        real m_scale;
         Vec3 m_pos;
+        Vec3 m_prevPos; // position at the previous physics step, see SimulatedPosition
 
     private:
-        bool m_isDirty;
-        Mat4x4 m_transform;
+        TransformBatch* m_pBatch;
+        size_t m_queueIdx; // in the batch queue, see TransformBatch
+        // Quaternion and rotation part of the matrix are out of date
+        mutable bool m_isDirty;
+        mutable Vec4 m_rotation;
+        mutable Mat4x4 m_transform;
     };
 }
\ No newline at end of file
@@ -11,7 +11,7 @@ namespace engiX
     class TurnController
     {
     public:
-        TurnController::TurnController() :
+        TurnController() :
             m_isTurningRight(false),
             m_isTurningLeft(false),
             m_isTurningUp(false),
@@ -0,0 +1,157 @@
+#include "D3d11Renderer.h"
+#include <DirectXColors.h>
+#include "DXUT.h"
+#include "Logger.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+D3d11Renderer::D3d11Renderer() :
+    m_shader(L"data/fx/default.fxo"),
+    m_boundIndexCount(0)
+{
+    for (unsigned i = 0; i < RasterStateCount; ++i)
+        m_pRasterStates[i] = nullptr;
+}
+
+D3d11Renderer::~D3d11Renderer()
+{
+    for (size_t i = 0; i < m_meshes.size(); ++i)
+        ReleaseMesh(i + 1);
+
+    ReleaseRasterStates();
+}
+
+void D3d11Renderer::ReleaseRasterStates()
+{
+    for (unsigned i = 0; i < RasterStateCount; ++i)
+        SAFE_RELEASE(m_pRasterStates[i]);
+}
+
+HRESULT D3d11Renderer::OnConstruct()
+{
+    ReleaseRasterStates();
+
+    CHRRHR(m_shader.OnConstruct());
+
+    for (unsigned flags = 0; flags < RasterStateCount; ++flags)
+    {
+        D3D11_RASTERIZER_DESC rasterizeDesc;
+        ZeroMemory(&rasterizeDesc, sizeof(D3D11_RASTERIZER_DESC));
+        rasterizeDesc.FillMode = ((flags & RASTER_Wireframe) ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID);
+        rasterizeDesc.CullMode = ((flags & RASTER_Backfacing) ? D3D11_CULL_FRONT : D3D11_CULL_BACK);
+        rasterizeDesc.FrontCounterClockwise = false;
+        rasterizeDesc.DepthClipEnable = true;
+
+        CHRRHR(DXUTGetD3D11Device()->CreateRasterizerState(&rasterizeDesc, &m_pRasterStates[flags]));
+    }
+
+    return S_OK;
+}
+
+void D3d11Renderer::BeginFrame()
+{
+    ID3D11RenderTargetView* pRTV = DXUTGetD3D11RenderTargetView();
+    DXUTGetD3D11DeviceContext()->ClearRenderTargetView(pRTV, DirectX::Colors::LightBlue);
+    ID3D11DepthStencilView* pDSV = DXUTGetD3D11DepthStencilView();
+    DXUTGetD3D11DeviceContext()->ClearDepthStencilView(pDSV, D3D11_CLEAR_DEPTH, 1.0, 0);
+
+    DXUTGetD3D11DeviceContext()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_shader.BindInputLayout();
+
+    m_boundIndexCount = 0;
+    m_frameStats.Reset();
+}
+
+HRESULT D3d11Renderer::CreateMesh(_In_ const Vertex_Position* pVertices, _In_ size_t vertexCount,
+    _In_ const unsigned* pIndices, _In_ size_t indexCount, _Out_ MeshHandle& mesh)
+{
+    mesh = NullMeshHandle;
+
+    Mesh newMesh;
+    CHRRHR(D3dShader::CreateVertexBufferFrom(const_cast<Vertex_Position*>(pVertices), vertexCount, newMesh.pVertexBuffer));
+
+    HRESULT hr = D3dShader::CreateIndexBufferFrom(const_cast<unsigned*>(pIndices), indexCount, newMesh.pIndexBuffer);
+    if (FAILED(hr))
+    {
+        SAFE_RELEASE(newMesh.pVertexBuffer);
+        return hr;
+    }
+
+    newMesh.IndexCount = (unsigned)indexCount;
+
+    size_t slot;
+    if (!m_freeMeshSlots.empty())
+    {
+        slot = m_freeMeshSlots.back();
+        m_freeMeshSlots.pop_back();
+        m_meshes[slot] = newMesh;
+    }
+    else
+    {
+        slot = m_meshes.size();
+        m_meshes.push_back(newMesh);
+    }
+
+    mesh = slot + 1;
+
+    return S_OK;
+}
+
+void D3d11Renderer::ReleaseMesh(_In_ MeshHandle mesh)
+{
+    if (mesh == NullMeshHandle || mesh > m_meshes.size())
+        return;
+
+    Mesh& m = m_meshes[mesh - 1];
+    if (!m.pVertexBuffer)
+        return;
+
+    SAFE_RELEASE(m.pVertexBuffer);
+    SAFE_RELEASE(m.pIndexBuffer);
+    m.IndexCount = 0;
+
+    m_freeMeshSlots.push_back(mesh - 1);
+}
+
+void D3d11Renderer::BindMesh(_In_ MeshHandle mesh)
+{
+    _ASSERTE(mesh != NullMeshHandle && mesh <= m_meshes.size());
+
+    const Mesh& m = m_meshes[mesh - 1];
+    _ASSERTE(m.pVertexBuffer);
+    _ASSERTE(m.pIndexBuffer);
+
+    UINT stride = sizeof(Vertex_Position);
+    UINT offset = 0;
+
+    DXUTGetD3D11DeviceContext()->IASetVertexBuffers(0, 1, &m.pVertexBuffer, &stride, &offset);
+    DXUTGetD3D11DeviceContext()->IASetIndexBuffer(m.pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+    m_boundIndexCount = m.IndexCount;
+    ++m_frameStats.StateChangeCount;
+}
+
+void D3d11Renderer::BindRasterState(_In_ unsigned rasterFlags)
+{
+    _ASSERTE(rasterFlags < RasterStateCount);
+    _ASSERTE(m_pRasterStates[rasterFlags]);
+
+    DXUTGetD3D11DeviceContext()->RSSetState(m_pRasterStates[rasterFlags]);
+
+    ++m_frameStats.StateChangeCount;
+}
+
+void D3d11Renderer::DrawIndexed(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color)
+{
+    _ASSERTE(m_boundIndexCount > 0);
+
+    if (FAILED(m_shader.OnPreRender(worldViewProj, color)))
+        return;
+
+    DXUTGetD3D11DeviceContext()->DrawIndexed(m_boundIndexCount, 0, 0);
+
+    ++m_frameStats.DrawCount;
+    m_frameStats.TriangleCount += m_boundIndexCount / 3;
+}
@@ -1,9 +1,57 @@
 #pragma once
 
+#include <vector>
+#include <d3d11.h>
+#include "ViewInterfaces.h"
+#include "D3dShader.h"
+
 namespace engiX
 {
-    class D3d11Renderer
+    //---------------------------------------------------------------------------------------------------------------------
+    // D3d11Renderer class
+    //
+    // IRenderDevice on the DXUT D3D11 device. Meshes are immutable vertex and index buffers drawn as triangle lists
+    // with the default fx, a mesh handle is its slot index + 1. One rasterizer state is created per RasterFlags
+    // combination on OnConstruct. The topology and input layout are the same for all the meshes and are set once
+    // per frame on BeginFrame.
+    //---------------------------------------------------------------------------------------------------------------------
+    class D3d11Renderer : public IRenderDevice
     {
+    public:
+        D3d11Renderer();
+        ~D3d11Renderer();
+        HRESULT OnConstruct();
+        void BeginFrame();
+        HRESULT CreateMesh(_In_ const Vertex_Position* pVertices, _In_ size_t vertexCount,
+            _In_ const unsigned* pIndices, _In_ size_t indexCount, _Out_ MeshHandle& mesh);
+        void ReleaseMesh(_In_ MeshHandle mesh);
+        void BindMesh(_In_ MeshHandle mesh);
+        void BindRasterState(_In_ unsigned rasterFlags);
+        void DrawIndexed(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color);
+        const RenderStats& FrameStats() const { return m_frameStats; }
+
+    protected:
+        DISALLOW_COPY_AND_ASSIGN(D3d11Renderer);
+
+        static const unsigned RasterStateCount = 4;
+
+        struct Mesh
+        {
+            Mesh() : pVertexBuffer(nullptr), pIndexBuffer(nullptr), IndexCount(0) {}
+
+            ID3D11Buffer* pVertexBuffer;
+            ID3D11Buffer* pIndexBuffer;
+            unsigned IndexCount;
+        };
+
+        void ReleaseRasterStates();
 
+        D3dShader m_shader;
+        ID3D11RasterizerState* m_pRasterStates[RasterStateCount];
+        std::vector<Mesh> m_meshes;
+        std::vector<size_t> m_freeMeshSlots;
+        // Index count of the bound mesh, 0 if none
+        unsigned m_boundIndexCount;
+        RenderStats m_frameStats;
     };
-}
\ No newline at end of file
+}
@@ -1,37 +1,36 @@
 #pragma once
 
 #include "SceneNode.h"
-#include "D3dShader.h"
-#include "Geometry.h"
+#include "MeshCache.h"
 
 namespace engiX
 {
+    //---------------------------------------------------------------------------------------------------------------------
+    // D3dGeneratedMeshNode class
+    //
+    // Scene node of a GeometryGenerator mesh. The geometry comes from the scene MeshCache so that nodes with the same
+    // MeshKey share one CPU copy and one device mesh, the color and rasterizer state are the node own and are passed
+    // with each draw. The draws are added to the scene render queue with the current camera world view projection
+    // matrix.
+    //---------------------------------------------------------------------------------------------------------------------
     class D3dGeneratedMeshNode : public SceneNode
     {
     public:
-        typedef std::vector<D3D11Vertex_PositionColored> VertexList;
-        typedef std::vector<UINT> IndexList;
+        // rasterFlags is a RasterFlags combination
+        D3dGeneratedMeshNode(_In_ ActorID actorId, _In_ const MeshKey& mesh, _In_ Color3 color, _In_ unsigned rasterFlags, _In_ GameScene* pScene);
 
-        D3dGeneratedMeshNode(_In_ ActorID actorId, _In_ const GeometryGenerator::MeshData& mesh, _In_ Color3 color, _In_ GameScene* pScene);
-        ~D3dGeneratedMeshNode();
-
-        HRESULT OnPreRender();
         HRESULT OnConstruct();
         void OnRender();
-        ID3D11Buffer* VertextBuffer() { return m_pVertexBuffer; }
-        ID3D11Buffer* IndexBuffer() { return m_pIndexBuffer; }
-        size_t VertexCount() const { return m_vertices.size(); }
-        size_t IndexCount() const { return m_indices.size(); }
-        bool RenderWireframe() const { return m_rasterizeDesc.FillMode == D3D11_FILL_WIREFRAME; }
-        bool RenderBackface() const { return m_rasterizeDesc.CullMode != D3D11_CULL_BACK; }
+        const SharedMesh& Mesh() const { return *m_pMesh; }
+        size_t VertexCount() const { return m_pMesh->Vertices().size(); }
+        size_t IndexCount() const { return m_pMesh->Indices().size(); }
+        const Color3& Color() const { return m_color; }
+        bool RenderWireframe() const { return (m_rasterFlags & RASTER_Wireframe) != 0; }
+        bool RenderBackface() const { return (m_rasterFlags & RASTER_Backfacing) != 0; }
 
     protected:
-        VertexList m_vertices;
-        IndexList m_indices;
-        D3dShader m_shader;
-        ID3D11Buffer* m_pVertexBuffer;
-        ID3D11Buffer* m_pIndexBuffer;
-        D3D11_RASTERIZER_DESC m_rasterizeDesc;
-        ID3D11RasterizerState* m_pRasterizeState;
+        StrongSharedMeshPtr m_pMesh;
+        Color3 m_color;
+        unsigned m_rasterFlags;
     };
 }
\ No newline at end of file
@@ -5,18 +5,23 @@
 #include "Logger.h"
 #include "DXUT.h"
 #include "Geometry.h"
-#include "GameScene.h"
 
 using namespace engiX;
 using namespace std;
 using namespace DirectX;
 
+static const D3D11_INPUT_ELEMENT_DESC VertexLayout_Position[] =
+{
+    { "POSITION",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
 D3dShader::D3dShader(_In_ const wchar_t* pFxFilename)
 {
     m_pVertexLayout = nullptr;
     m_pFX = nullptr;
     m_pFxTech = nullptr;
     m_pFxWvpMatrix = nullptr;
+    m_pFxColor = nullptr;
 
     m_fxFilename = pFxFilename;
 }
@@ -58,6 +63,7 @@ HRESULT D3dShader::OnConstruct()
 
     m_pFxTech = m_pFX->GetTechniqueByName("DefaultTech");
     m_pFxWvpMatrix = m_pFX->GetVariableByName("gWorldViewProj")->AsMatrix();
+    m_pFxColor = m_pFX->GetVariableByName("gColor")->AsVector();
 
     // Create the input layout using the vertex format
     // Pass the shader input signature to get it validated against the vertex format provided
@@ -65,29 +71,30 @@ HRESULT D3dShader::OnConstruct()
     D3DX11_PASS_DESC passDesc;
     CHRRHR(m_pFxTech->GetPassByIndex(0)->GetDesc(&passDesc));
 
-    CHRRHR(DXUTGetD3D11Device()->CreateInputLayout(D3D11VertexLayout_PositionColored, 2, passDesc.pIAInputSignature, 
+    CHRRHR(DXUTGetD3D11Device()->CreateInputLayout(VertexLayout_Position, 1, passDesc.pIAInputSignature, 
         passDesc.IAInputSignatureSize, &m_pVertexLayout));
 
     return S_OK;
 }
 
-HRESULT D3dShader::OnPreRender(ISceneNode* pNode)
+void D3dShader::BindInputLayout()
 {
-    // Set the vertex shader and the vertex layout
     DXUTGetD3D11DeviceContext()->IASetInputLayout(m_pVertexLayout);
+}
 
-    _ASSERTE(pNode);
-    _ASSERTE(pNode->Scene());
-    _ASSERTE(pNode->Scene()->Camera());
-    Mat4x4 wvpMat = pNode->Scene()->Camera()->SceneWorldViewProjMatrix();
-
+// The pass is applied again on each draw, it is what commits the changed matrix and color to the shader constant buffer
+HRESULT D3dShader::OnPreRender(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color)
+{
     XMMATRIX wvpXMat;
-    wvpXMat = XMLoadFloat4x4(&wvpMat);
+    wvpXMat = XMLoadFloat4x4(&worldViewProj);
 
-    if (m_pFxWvpMatrix && m_pFxTech)
+    if (m_pFxWvpMatrix && m_pFxColor && m_pFxTech)
     {
         m_pFxWvpMatrix->SetMatrix(reinterpret_cast<float*>(&wvpXMat));
 
+        float colorRgba[4] = { color.x, color.y, color.z, 1.0f };
+        m_pFxColor->SetFloatVector(colorRgba);
+
         // For now we use a shader with 1 Tech and 1 Pass
         _ASSERTE(m_pFxTech);
         CHRRHR(m_pFxTech->GetPassByIndex(0)->Apply(0, DXUTGetD3D11DeviceContext()));
@@ -100,7 +107,7 @@ HRESULT D3dShader::CreateVertexBufferFrom(_In_ void* pVertexMemSource, _In_ size
 {
     D3D11_BUFFER_DESC vbd;
     vbd.Usage = D3D11_USAGE_IMMUTABLE;
-    vbd.ByteWidth = sizeof(D3D11Vertex_PositionColored) * vertexCount;
+    vbd.ByteWidth = sizeof(Vertex_Position) * vertexCount;
     vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vbd.CPUAccessFlags = 0;
     vbd.MiscFlags = 0;
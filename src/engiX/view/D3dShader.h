@@ -17,7 +17,8 @@ namespace engiX
     public:
         D3dShader(_In_ const wchar_t* pFxFilename);
         ~D3dShader();
-        HRESULT OnPreRender(ISceneNode* pNode);
+        void BindInputLayout();
+        HRESULT OnPreRender(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color);
         HRESULT OnConstruct();
 
         static HRESULT CreateVertexBufferFrom(_In_ void* pVertexMemSource, _In_ size_t vertexCount, _Out_ ID3D11Buffer*& pVB);
@@ -30,6 +31,7 @@ namespace engiX
         ID3DX11Effect* m_pFX;
         ID3DX11EffectTechnique* m_pFxTech;
         ID3DX11EffectMatrixVariable* m_pFxWvpMatrix; // World View Projection matrix
+        ID3DX11EffectVectorVariable* m_pFxColor; // Instance color
         std::wstring m_fxFilename;
     };
 }
\ No newline at end of file
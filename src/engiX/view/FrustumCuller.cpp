@@ -0,0 +1,150 @@
+#include "FrustumCuller.h"
+#include "D3dUtil.h"
+#include "Simd.h"
+#include "SceneHierarchy.h"
+#include "SceneNode.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+// Radius of the removed nodes and padding lanes, no plane distance is above REAL_MAX so they are never visible
+static const real NeverVisibleRadius = -REAL_MAX;
+
+FrustumCuller::FrustumCuller() :
+    m_count(0),
+    m_liveCount(0),
+    m_culledCount(0)
+{
+}
+
+void FrustumCuller::Cull(_In_ const Mat4x4& viewProj, _In_ const SceneHierarchy& hierarchy)
+{
+    Vec4 planes[6];
+    ExtractFrustumPlanes(planes, XMLoadFloat4x4(&viewProj));
+
+    CalcWorldBounds(hierarchy);
+    TestSpheres(planes);
+
+    m_culledCount = m_liveCount - m_visible.size();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// The world center is the local center transformed by the world matrix, the radius is scaled by the matrix largest
+// axis scale so that the sphere still encloses the geometry under non uniform scaling. The arrays are padded to
+// Simd::PaddedCount so that every flavor runs whole batches.
+//---------------------------------------------------------------------------------------------------------------------
+void FrustumCuller::CalcWorldBounds(_In_ const SceneHierarchy& hierarchy)
+{
+    m_count = hierarchy.Size();
+    m_liveCount = 0;
+
+    const size_t paddedCount = Simd::PaddedCount(m_count);
+
+    m_x.resize(paddedCount);
+    m_y.resize(paddedCount);
+    m_z.resize(paddedCount);
+    m_radius.resize(paddedCount);
+
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        if (!hierarchy.Node(i))
+        {
+            m_x[i] = m_y[i] = m_z[i] = 0.0f;
+            m_radius[i] = NeverVisibleRadius;
+            continue;
+        }
+
+        ++m_liveCount;
+
+        const BoundingSphere& bounds = hierarchy.LocalBounds(i);
+        XMMATRIX world = XMLoadFloat4x4(&hierarchy.WorldTransform(i));
+        XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&bounds.Position()), world);
+        XMVECTOR maxScaleSq = XMVectorMax(XMVector3LengthSq(world.r[0]), XMVectorMax(XMVector3LengthSq(world.r[1]), XMVector3LengthSq(world.r[2])));
+
+        m_x[i] = XMVectorGetX(center);
+        m_y[i] = XMVectorGetY(center);
+        m_z[i] = XMVectorGetZ(center);
+        m_radius[i] = bounds.Radius() * real_sqrt(XMVectorGetX(maxScaleSq));
+    }
+
+    for (size_t i = m_count; i < paddedCount; ++i)
+    {
+        m_x[i] = m_y[i] = m_z[i] = 0.0f;
+        m_radius[i] = NeverVisibleRadius;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Sphere i is visible when dot(plane.xyz, center[i]) + plane.w >= -radius[i] for all the 6 planes
+//---------------------------------------------------------------------------------------------------------------------
+void FrustumCuller::TestSpheres(_In_ const Vec4 planes[6])
+{
+    const real* pX = m_x.data();
+    const real* pY = m_y.data();
+    const real* pZ = m_z.data();
+    const real* pRadius = m_radius.data();
+
+    m_visible.clear();
+
+#if defined(ENGIX_SIMD_AVX)
+    for (size_t i = 0; i < m_count; i += 8)
+    {
+        __m256 x = _mm256_load_ps(pX + i);
+        __m256 y = _mm256_load_ps(pY + i);
+        __m256 z = _mm256_load_ps(pZ + i);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_load_ps(pRadius + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (int p = 0; p < 6; ++p)
+        {
+            __m256 dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes[p].x)), _mm256_mul_ps(y, _mm256_set1_ps(planes[p].y))),
+                _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(planes[p].z)), _mm256_set1_ps(planes[p].w)));
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negRadius, _CMP_GE_OQ));
+        }
+
+        for (unsigned laneMask = (unsigned)_mm256_movemask_ps(inside), lane = 0; laneMask != 0; ++lane, laneMask >>= 1)
+        {
+            if (laneMask & 1)
+                m_visible.push_back(i + lane);
+        }
+    }
+#elif !defined(ENGIX_SIMD_SCALAR)
+    for (size_t i = 0; i < m_count; i += 4)
+    {
+        XMVECTOR x = Simd::Load4(pX + i);
+        XMVECTOR y = Simd::Load4(pY + i);
+        XMVECTOR z = Simd::Load4(pZ + i);
+        XMVECTOR negRadius = XMVectorNegate(Simd::Load4(pRadius + i));
+        XMVECTOR inside = XMVectorTrueInt();
+
+        for (int p = 0; p < 6; ++p)
+        {
+            XMVECTOR dist = XMVectorMultiplyAdd(z, XMVectorReplicate(planes[p].z),
+                XMVectorMultiplyAdd(y, XMVectorReplicate(planes[p].y),
+                XMVectorMultiplyAdd(x, XMVectorReplicate(planes[p].x), XMVectorReplicate(planes[p].w))));
+
+            inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(dist, negRadius));
+        }
+
+        for (unsigned laneMask = Simd::MoveMask4(inside), lane = 0; laneMask != 0; ++lane, laneMask >>= 1)
+        {
+            if (laneMask & 1)
+                m_visible.push_back(i + lane);
+        }
+    }
+#else
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        bool isInside = true;
+
+        for (int p = 0; p < 6 && isInside; ++p)
+            isInside = (planes[p].x * pX[i] + planes[p].y * pY[i] + planes[p].z * pZ[i] + planes[p].w >= -pRadius[i]);
+
+        if (isInside)
+            m_visible.push_back(i);
+    }
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include "engiXDefs.h"
+#include "AlignedAllocator.h"
+
+namespace engiX
+{
+    class SceneHierarchy;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // FrustumCuller class
+    //
+    // Culling stage between the scene update and its rendering. Cull extracts the 6 frustum planes of a camera view
+    // projection matrix, transforms the nodes local bounds spheres by their world matrix into structure-of-arrays and
+    // tests them against the planes 8 spheres per instruction with AVX, 4 with SSE or one at a time with the scalar
+    // fallback, see Simd.h. A sphere is visible unless it lies entirely behind one of the planes, which keeps a few
+    // spheres near the frustum corners that are actually outside, the renderer clips them.
+    //
+    // The visible list holds the hierarchy indices of the visible nodes in increasing order, so it keeps the depth
+    // order, and is valid until the hierarchy changes. Removed nodes are neither visible nor culled.
+    //---------------------------------------------------------------------------------------------------------------------
+    class FrustumCuller
+    {
+    public:
+        FrustumCuller();
+        void Cull(_In_ const Mat4x4& viewProj, _In_ const SceneHierarchy& hierarchy);
+        const std::vector<size_t>& Visible() const { return m_visible; }
+        size_t VisibleCount() const { return m_visible.size(); }
+        size_t CulledCount() const { return m_culledCount; }
+
+    protected:
+        void CalcWorldBounds(_In_ const SceneHierarchy& hierarchy);
+        void TestSpheres(_In_ const Vec4 planes[6]);
+
+    private:
+        RealArray m_x;
+        RealArray m_y;
+        RealArray m_z;
+        RealArray m_radius;
+        size_t m_count;
+        size_t m_liveCount;
+        size_t m_culledCount;
+        std::vector<size_t> m_visible;
+    };
+}
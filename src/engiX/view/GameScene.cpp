@@ -1,9 +1,6 @@
 #include "GameScene.h"
 #include <memory>
-#include <DirectXColors.h>
-#include "DXUT.h"
 #include "EventManager.h"
-#include "WinGameApp.h"
 #include "RenderComponent.h"
 #include "GameLogic.h"
 
@@ -11,31 +8,42 @@ using namespace engiX;
 using namespace std;
 using namespace DirectX;
 
-GameScene::GameScene() :
-    m_pSceneRoot(eNEW RootSceneNode(this)),
-    m_currCameraIdx(-1)
+GameScene::GameScene(_In_ shared_ptr<IRenderDevice> pDevice, _In_ GameLogic* pLogic) :
+    m_pDevice(pDevice),
+    m_pLogic(pLogic),
+    m_aspectRatio(1.0f),
+    m_meshCache(pDevice),
+    m_pRenderWorldTsfm(&m_identityTsfm),
+    m_currCameraIdx(-1),
+    m_traversalTime(0.0f)
 {
+    _ASSERTE(m_pDevice);
+    _ASSERTE(m_pLogic);
 
+    XMStoreFloat4x4(&m_identityTsfm, XMMatrixIdentity());
 }
 
 GameScene::~GameScene()
 {
-    SAFE_DELETE(m_pSceneRoot);
+    for (auto& evtHandler : m_evtHandlers)
+        g_EventMgr->Unregister(evtHandler.first, evtHandler.second);
 }
 
 bool GameScene::Init()
 {
-    Mat4x4 identity;
-    XMStoreFloat4x4(&identity, XMMatrixIdentity());
-    m_worldTransformationStack.push(identity);
-
-    REGISTER_EVT(GameScene, ActorCreatedEvt);
-    REGISTER_EVT(GameScene, ActorDestroyedEvt);
-    REGISTER_EVT(GameScene, ToggleCameraEvt);
+    RegisterEvt(MakeDelegateP1<EventPtr>(this, &GameScene::OnActorCreatedEvt), ActorCreatedEvt::TypeID);
+    RegisterEvt(MakeDelegateP1<EventPtr>(this, &GameScene::OnActorDestroyedEvt), ActorDestroyedEvt::TypeID);
+    RegisterEvt(MakeDelegateP1<EventPtr>(this, &GameScene::OnToggleCameraEvt), ToggleCameraEvt::TypeID);
 
     return true;
 }
 
+void GameScene::RegisterEvt(_In_ EventHandlerPtr pHandler, _In_ EventTypeID type)
+{
+    g_EventMgr->Register(pHandler, type);
+    m_evtHandlers.push_back(make_pair(pHandler, type));
+}
+
 shared_ptr<SceneCameraNode> GameScene::Camera()
 {
     if (m_cameras.empty())
@@ -56,51 +64,82 @@ shared_ptr<SceneCameraNode> GameScene::AddCamera()
         m_currCameraIdx = 0;
 
     m_cameras.push_back(pCamera);
-    m_pSceneRoot->AddChild(pCamera);
 
     return pCamera;
 }
 
 HRESULT GameScene::OnConstruct()
 {
-    _ASSERTE(m_pSceneRoot);
-    return m_pSceneRoot->OnConstruct();
+    CHRRHR(m_pDevice->OnConstruct());
+    CHRRHR(m_meshCache.OnConstruct());
+
+    for (auto pCamera : m_cameras)
+        CHRRHR(pCamera->OnConstruct());
+
+    m_hierarchy.Compact();
+
+    for (size_t i = 0; i < m_hierarchy.Size(); ++i)
+        CHRRHR(m_hierarchy.Node(i)->OnConstruct());
+
+    return S_OK;
 }
 
+// Nodes write their local matrix first, then the hierarchy propagates them to the world matrices in one pass
 void GameScene::OnUpdate(_In_ const Timer& time)
 {
-    _ASSERTE(m_pSceneRoot);
-    m_pSceneRoot->OnUpdate(time);
+    m_hierarchy.Compact();
+
+    for (size_t i = 0; i < m_hierarchy.Size(); ++i)
+        m_hierarchy.Node(i)->OnUpdate(time);
+
+    m_hierarchy.UpdateWorld();
+
+    for (auto pCamera : m_cameras)
+        pCamera->OnUpdate(time);
 }
 
 void GameScene::OnRender()
 {
-    ID3D11RenderTargetView* pRTV = DXUTGetD3D11RenderTargetView();
-    DXUTGetD3D11DeviceContext()->ClearRenderTargetView(pRTV, DirectX::Colors::LightBlue);
-    ID3D11DepthStencilView* pDSV = DXUTGetD3D11DepthStencilView();
-    DXUTGetD3D11DeviceContext()->ClearDepthStencilView(pDSV, D3D11_CLEAR_DEPTH, 1.0, 0);
+    m_pDevice->BeginFrame();
+    m_traversalTime = 0.0f;
+
+    if (m_currCameraIdx < 0 || !m_cameras[m_currCameraIdx])
+        return;
+
+    StopWatch traversalWatch;
+    traversalWatch.Start();
 
-    if (m_pSceneRoot && m_cameras[m_currCameraIdx])
+    m_renderQueue.Clear();
+
+    // Nodes removed since the last update are not in the visible list
+    m_culler.Cull(m_cameras[m_currCameraIdx]->ViewProjMatrix(), m_hierarchy);
+
+    for (size_t i : m_culler.Visible())
     {
-        // Make sure that the stack has only the identify transformation
-        _ASSERTE(m_worldTransformationStack.size() == 1);
+        ISceneNode* pNode = m_hierarchy.Node(i);
+
+        m_pRenderWorldTsfm = &m_hierarchy.WorldTransform(i);
 
-        _ASSERTE(m_pSceneRoot);
-        if (SUCCEEDED(m_pSceneRoot->OnPreRender()))
+        if (SUCCEEDED(pNode->OnPreRender()))
         {
-            m_pSceneRoot->OnRender();
-            m_pSceneRoot->OnPostRender();
+            pNode->OnRender();
+            pNode->OnPostRender();
         }
-
-        m_pSceneRoot->RenderChildren();
     }
+
+    m_pRenderWorldTsfm = &m_identityTsfm;
+
+    m_renderQueue.Sort();
+    m_renderQueue.Submit(*m_pDevice);
+
+    m_traversalTime = traversalWatch.Stop();
 }
 
 void GameScene::OnActorCreatedEvt(_In_ EventPtr pEvt)
 {
     shared_ptr<ActorCreatedEvt> pActrEvt = static_pointer_cast<ActorCreatedEvt>(pEvt);
 
-    auto& a = g_pApp->Logic()->GetActor(pActrEvt->ActorId());
+    auto& a = m_pLogic->GetActor(pActrEvt->ActorId());
     _ASSERTE(!a.IsNull());
 
     auto &renderCmpt = a.Get<RenderComponent>();
@@ -109,16 +148,16 @@ void GameScene::OnActorCreatedEvt(_In_ EventPtr pEvt)
     renderCmpt.SceneNode(pSceneNode);
     CHRR(pSceneNode->OnConstruct());
 
-    m_pSceneRoot->AddChild(pSceneNode);
+    m_hierarchy.Add(static_pointer_cast<SceneNode>(pSceneNode));
 
-    LogVerbose("Actor %s[%x] ScenNode created and added to scene root node children", a.Typename(), a.Id());
+    LogVerbose("Actor %s[%x] ScenNode created and added to scene hierarchy", a.Typename(), a.Id());
 }
 
 void GameScene::OnActorDestroyedEvt(_In_ EventPtr pEvt)
 {
     shared_ptr<ActorDestroyedEvt> pActrEvt = static_pointer_cast<ActorDestroyedEvt>(pEvt);
 
-    m_pSceneRoot->RemoveChild(pActrEvt->ActorId());
+    m_hierarchy.Remove(pActrEvt->ActorId());
 }
 
 void GameScene::OnToggleCameraEvt(_In_ EventPtr pEvt)
@@ -126,22 +165,3 @@ void GameScene::OnToggleCameraEvt(_In_ EventPtr pEvt)
     LogInfo("Game scene toggle its camera");
     m_currCameraIdx = (m_currCameraIdx + 1) % m_cameras.size();
 }
-
-void GameScene::PushTransformation(_In_ const Mat4x4& t)
-{
-    XMMATRIX topMat = XMLoadFloat4x4(&m_worldTransformationStack.top());
-    XMMATRIX newTransMat = XMLoadFloat4x4(&t);
-
-    // Duplicate the matrix on top
-    m_worldTransformationStack.push(m_worldTransformationStack.top());
-    // Replace the top matrix with the new transformation
-    XMStoreFloat4x4(&m_worldTransformationStack.top(), newTransMat * topMat);
-}
-
-void GameScene::PopTransformation()
-{ 
-    // The identity transform should always be there and no one
-    // should ever pop it if the scene rendering logic is correct
-    _ASSERTE(m_worldTransformationStack.size() > 1);
-    m_worldTransformationStack.pop(); 
-}
\ No newline at end of file
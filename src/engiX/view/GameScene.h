@@ -2,22 +2,40 @@
 
 #include <memory>
 #include <vector>
-#include <stack>
-#include <d3d11.h>
 #include "Timer.h"
 #include "Delegate.h"
 #include "Events.h"
+#include "engiX.h"
 #include "SceneCameraNode.h"
 #include "ViewInterfaces.h"
+#include "SceneHierarchy.h"
+#include "FrustumCuller.h"
+#include "RenderQueue.h"
+#include "MeshCache.h"
 
 namespace engiX
 {
     class SceneCameraNode;
+    class GameLogic;
 
+    //---------------------------------------------------------------------------------------------------------------------
+    // GameScene class
+    //
+    // The actors scene nodes live in a flattened SceneHierarchy, the scene updates and renders them with linear loops
+    // over its depth sorted arrays. Cameras are kept aside, they have no actor and are not part of the rendered nodes.
+    // Only the nodes the FrustumCuller finds in the current camera frustum are rendered.
+    //
+    // The nodes share their meshes through the scene MeshCache and add their draws to the scene RenderQueue, which is
+    // sorted and submitted to the device once all the visible nodes rendered. The traversal time measures the culling,
+    // the queue fill, sort and submission of the last rendered frame.
+    //
+    // The view that owns the scene gives it the logic the nodes read their actors from and the viewport aspect ratio
+    // the cameras project with, the scene does not reach for the app so it also runs headless, see NullGameView.
+    //---------------------------------------------------------------------------------------------------------------------
     class GameScene
     {
     public:
-        GameScene();
+        GameScene(_In_ std::shared_ptr<IRenderDevice> pDevice, _In_ GameLogic* pLogic);
         ~GameScene();
         void OnUpdate(_In_ const Timer& time);
         void OnRender();
@@ -27,16 +45,42 @@ namespace engiX
         void OnToggleCameraEvt(_In_ EventPtr pEvt);
         bool Init();
         std::shared_ptr<SceneCameraNode> Camera();
-        void PushTransformation(_In_ const Mat4x4& t);
-        void PopTransformation();
-        const Mat4x4 TopTransformation() const { return m_worldTransformationStack.top(); }
+        // World matrix of the node being rendered, identity outside the nodes rendering
+        const Mat4x4& WorldTransformation() const { return *m_pRenderWorldTsfm; }
         std::shared_ptr<SceneCameraNode> AddCamera();
+        SceneHierarchy& Hierarchy() { return m_hierarchy; }
+        // Last rendered frame culling results
+        const FrustumCuller& Culler() const { return m_culler; }
+        std::shared_ptr<IRenderDevice> Device() { return m_pDevice; }
+        // Owner of the actors the scene nodes show
+        GameLogic* Logic() { return m_pLogic; }
+        // Viewport width over height, the cameras pick it up on OnConstruct
+        real AspectRatio() const { return m_aspectRatio; }
+        void AspectRatio(_In_ real val) { m_aspectRatio = val; }
+        // Draws of the frame being rendered
+        RenderQueue& Queue() { return m_renderQueue; }
+        MeshCache& Meshes() { return m_meshCache; }
+        const RenderStats& FrameStats() const { return m_pDevice->FrameStats(); }
+        // Seconds
+        real TraversalTime() const { return m_traversalTime; }
 
     protected:
-        ISceneNode* m_pSceneRoot;
+        void RegisterEvt(_In_ EventHandlerPtr pHandler, _In_ EventTypeID type);
+
+        std::shared_ptr<IRenderDevice> m_pDevice;
+        GameLogic* m_pLogic;
+        real m_aspectRatio;
+        // Unregistered when the scene is destroyed, the event manager outlives it
+        std::vector<std::pair<EventHandlerPtr, EventTypeID>> m_evtHandlers;
+        SceneHierarchy m_hierarchy;
+        FrustumCuller m_culler;
+        RenderQueue m_renderQueue;
+        MeshCache m_meshCache;
         std::vector<std::shared_ptr<SceneCameraNode>> m_cameras;
-        std::stack<Mat4x4> m_worldTransformationStack;
+        Mat4x4 m_identityTsfm;
+        const Mat4x4* m_pRenderWorldTsfm;
         int m_currCameraIdx;
+        real m_traversalTime;
     };
     
     typedef std::shared_ptr<GameScene> StrongGameScenePtr;
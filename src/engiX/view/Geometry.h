@@ -1,19 +1,13 @@
 #pragma once
 
 #include "engiXDefs.h"
-#include <d3d11.h>
 
 namespace engiX
 {
-    struct D3D11Vertex_PositionColored
+    // Vertex format of the generated meshes, see D3dShader for its D3D11 input layout. The color is per instance and
+    // is passed with each draw so that the meshes can be shared.
+    struct Vertex_Position
     {
         Vec3 Position;
-        Vec3 Color;
-    };
-
-    const D3D11_INPUT_ELEMENT_DESC D3D11VertexLayout_PositionColored[] =
-    {
-        { "POSITION",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR",     0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     };
 }
\ No newline at end of file
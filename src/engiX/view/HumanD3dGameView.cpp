@@ -1,10 +1,13 @@
 #include "HumanD3dGameView.h"
 #include <DirectXColors.h>
 #include <algorithm>
+#include <sstream>
 #include "DXUT.h"
 #include "Logger.h"
 #include "EventManager.h"
 #include "GameScene.h"
+#include "D3d11Renderer.h"
+#include "GameApp.h"
 
 using namespace engiX;
 using namespace DirectX;
@@ -12,7 +15,7 @@ using namespace std;
 
 bool HumanD3dGameView::Init()
 {
-    m_pScene = StrongGameScenePtr(eNEW GameScene);
+    m_pScene = StrongGameScenePtr(eNEW GameScene(shared_ptr<IRenderDevice>(eNEW D3d11Renderer), g_pApp->Logic()));
     CBRB(m_pScene->Init());
     fill(begin(m_downKeys), end(m_downKeys), false);
     return true;
@@ -20,6 +23,8 @@ bool HumanD3dGameView::Init()
 
 HRESULT HumanD3dGameView::OnConstruct()
 {
+    // Called again when the window is resized
+    m_pScene->AspectRatio(g_pApp->AspectRatio());
     return m_pScene->OnConstruct();
 }
 
@@ -33,6 +38,19 @@ void HumanD3dGameView::OnRender()
     m_pScene->OnRender();
 }
 
+wstring HumanD3dGameView::FrameStats() const
+{
+    const FrustumCuller& culler = m_pScene->Culler();
+    const RenderStats& renderStats = m_pScene->FrameStats();
+
+    wostringstream outs;
+    outs << L"Visible: " << culler.VisibleCount() << L" Culled: " << culler.CulledCount()
+        << L" Draws: " << renderStats.DrawCount << L" Triangles: " << renderStats.TriangleCount
+        << L" State changes: " << renderStats.StateChangeCount << L" Traversal (ms): " << m_pScene->TraversalTime() * 1000.0f;
+
+    return outs.str();
+}
+
 bool HumanD3dGameView::OnMsgProc(_In_ const Timer& time, _In_ UINT uMsg, _In_ WPARAM wParam, _In_ LPARAM lParam)
 {
     switch (uMsg) 
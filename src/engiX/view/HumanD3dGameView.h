@@ -22,6 +22,7 @@ namespace engiX
         void OnUpdate(_In_ const Timer& time);
         HRESULT OnConstruct();
         bool OnMsgProc(_In_ const Timer& time, _In_ UINT uMsg, _In_ WPARAM wParam, _In_ LPARAM lParam);
+        std::wstring FrameStats() const;
 
     private:
         void OnKeyDown(_In_ const Timer& time, _In_ const BYTE c);
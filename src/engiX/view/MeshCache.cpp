@@ -0,0 +1,260 @@
+#include "MeshCache.h"
+#include "GeometryGenerator.h"
+#include "Logger.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+MeshKey::MeshKey(_In_ MeshShape shape) :
+    Shape(shape)
+{
+    Dimensions[0] = Dimensions[1] = Dimensions[2] = 0.0f;
+    Tessellation[0] = Tessellation[1] = 0;
+}
+
+// Adding 0 turns -0 into 0 so that both hash and compare equal
+MeshKey MeshKey::Box(_In_ real width, _In_ real height, _In_ real depth)
+{
+    MeshKey key(MESH_Box);
+    key.Dimensions[0] = width + 0.0f;
+    key.Dimensions[1] = height + 0.0f;
+    key.Dimensions[2] = depth + 0.0f;
+
+    return key;
+}
+
+MeshKey MeshKey::Geosphere(_In_ real radius, _In_ unsigned subdivisionCount)
+{
+    MeshKey key(MESH_Geosphere);
+    key.Dimensions[0] = radius + 0.0f;
+    key.Tessellation[0] = subdivisionCount;
+
+    return key;
+}
+
+MeshKey MeshKey::Grid(_In_ real width, _In_ real depth, _In_ unsigned rowCount, _In_ unsigned columnCount)
+{
+    MeshKey key(MESH_Grid);
+    key.Dimensions[0] = width + 0.0f;
+    key.Dimensions[1] = depth + 0.0f;
+    key.Tessellation[0] = rowCount;
+    key.Tessellation[1] = columnCount;
+
+    return key;
+}
+
+MeshKey MeshKey::Cylinder(_In_ real bottomRadius, _In_ real topRadius, _In_ real height, _In_ unsigned sliceCount, _In_ unsigned stackCount)
+{
+    MeshKey key(MESH_Cylinder);
+    key.Dimensions[0] = bottomRadius + 0.0f;
+    key.Dimensions[1] = topRadius + 0.0f;
+    key.Dimensions[2] = height + 0.0f;
+    key.Tessellation[0] = sliceCount;
+    key.Tessellation[1] = stackCount;
+
+    return key;
+}
+
+bool MeshKey::operator == (_In_ const MeshKey& other) const
+{
+    return Shape == other.Shape &&
+        Dimensions[0] == other.Dimensions[0] &&
+        Dimensions[1] == other.Dimensions[1] &&
+        Dimensions[2] == other.Dimensions[2] &&
+        Tessellation[0] == other.Tessellation[0] &&
+        Tessellation[1] == other.Tessellation[1];
+}
+
+// FNV-1a step over the bytes of one key field
+static void HashBytes(_Inout_ unsigned& hash, _In_ const void* pData, _In_ size_t size)
+{
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= pBytes[i];
+        hash *= 16777619U;
+    }
+}
+
+// FNV-1a over the key fields bits, field by field so that the hash does not depend on the size of real
+size_t MeshKey::Hash() const
+{
+    unsigned shape = (unsigned)Shape;
+    unsigned hash = 2166136261U;
+
+    HashBytes(hash, &shape, sizeof(shape));
+    HashBytes(hash, Dimensions, sizeof(Dimensions));
+    HashBytes(hash, Tessellation, sizeof(Tessellation));
+
+    return hash;
+}
+
+SharedMesh::SharedMesh(_In_ const MeshKey& key, _In_ shared_ptr<IRenderDevice> pDevice) :
+    m_key(key),
+    m_pDevice(pDevice),
+    m_handle(NullMeshHandle)
+{
+}
+
+SharedMesh::~SharedMesh()
+{
+    if (m_handle != NullMeshHandle)
+        m_pDevice->ReleaseMesh(m_handle);
+}
+
+MeshCache::MeshCache(_In_ shared_ptr<IRenderDevice> pDevice) :
+    m_pDevice(pDevice),
+    m_sizeAfterRemoval(0)
+{
+    _ASSERTE(m_pDevice);
+}
+
+StrongSharedMeshPtr MeshCache::Acquire(_In_ const MeshKey& key)
+{
+    auto itr = m_meshes.find(key);
+
+    if (itr != m_meshes.end())
+    {
+        StrongSharedMeshPtr pMesh = itr->second.lock();
+        if (pMesh)
+            return pMesh;
+    }
+
+    StrongSharedMeshPtr pMesh(eNEW SharedMesh(key, m_pDevice));
+    Generate(*pMesh);
+
+    m_meshes[key] = pMesh;
+
+    // The released meshes entries are kept until the registry doubles, so the removal cost is amortized
+    if (m_meshes.size() >= 2 * m_sizeAfterRemoval + 16)
+        RemoveExpired();
+
+    LogVerbose("Mesh generated, %d vertices %d indices, %d meshes cached", (int)pMesh->m_vertices.size(), (int)pMesh->m_indices.size(), (int)m_meshes.size());
+
+    return pMesh;
+}
+
+void MeshCache::RemoveExpired()
+{
+    for (auto itr = m_meshes.begin(); itr != m_meshes.end();)
+    {
+        if (itr->second.expired())
+            itr = m_meshes.erase(itr);
+        else
+            ++itr;
+    }
+
+    m_sizeAfterRemoval = m_meshes.size();
+}
+
+size_t MeshCache::LiveCount() const
+{
+    size_t count = 0;
+
+    for (auto& entry : m_meshes)
+    {
+        if (!entry.second.expired())
+            ++count;
+    }
+
+    return count;
+}
+
+HRESULT MeshCache::CreateDeviceMesh(_Inout_ SharedMesh& mesh)
+{
+    if (mesh.m_handle != NullMeshHandle)
+        return S_OK;
+
+    CHRRHR(m_pDevice->CreateMesh(&mesh.m_vertices[0], mesh.m_vertices.size(), &mesh.m_indices[0], mesh.m_indices.size(), mesh.m_handle));
+
+    return S_OK;
+}
+
+HRESULT MeshCache::OnConstruct()
+{
+    RemoveExpired();
+
+    for (auto& entry : m_meshes)
+    {
+        StrongSharedMeshPtr pMesh = entry.second.lock();
+        if (!pMesh)
+            continue;
+
+        if (pMesh->m_handle != NullMeshHandle)
+        {
+            m_pDevice->ReleaseMesh(pMesh->m_handle);
+            pMesh->m_handle = NullMeshHandle;
+        }
+
+        CHRRHR(CreateDeviceMesh(*pMesh));
+    }
+
+    return S_OK;
+}
+
+void MeshCache::Generate(_Inout_ SharedMesh& mesh)
+{
+    GeometryGenerator g;
+    GeometryGenerator::MeshData data;
+    const MeshKey& key = mesh.m_key;
+
+    switch (key.Shape)
+    {
+    case MESH_Box:
+        g.CreateBox(key.Dimensions[0], key.Dimensions[1], key.Dimensions[2], data);
+        break;
+
+    case MESH_Geosphere:
+        g.CreateGeosphere(key.Dimensions[0], key.Tessellation[0], data);
+        break;
+
+    case MESH_Grid:
+        g.CreateGrid(key.Dimensions[0], key.Dimensions[1], key.Tessellation[0], key.Tessellation[1], data);
+        break;
+
+    case MESH_Cylinder:
+        g.CreateCylinder(key.Dimensions[0], key.Dimensions[1], key.Dimensions[2], key.Tessellation[0], key.Tessellation[1], data);
+        break;
+
+    default:
+        _ASSERTE(!"Unknown mesh shape");
+    }
+
+    mesh.m_vertices.resize(data.Vertices.size());
+
+    for (size_t i = 0; i < data.Vertices.size(); ++i)
+        mesh.m_vertices[i].Position = data.Vertices[i].Position;
+
+    mesh.m_indices.assign(data.Indices.begin(), data.Indices.end());
+    mesh.m_localBounds = CalcLocalBounds(mesh.m_vertices);
+}
+
+// Sphere around the vertices bounding box center, not the tightest one but close for the generated shapes
+BoundingSphere MeshCache::CalcLocalBounds(_In_ const vector<Vertex_Position>& vertices)
+{
+    if (vertices.empty())
+        return BoundingSphere();
+
+    XMVECTOR boxMin = XMLoadFloat3(&vertices[0].Position);
+    XMVECTOR boxMax = boxMin;
+
+    for (auto& v : vertices)
+    {
+        XMVECTOR pos = XMLoadFloat3(&v.Position);
+        boxMin = XMVectorMin(boxMin, pos);
+        boxMax = XMVectorMax(boxMax, pos);
+    }
+
+    XMVECTOR center = XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f);
+    XMVECTOR radiusSq = XMVectorZero();
+
+    for (auto& v : vertices)
+        radiusSq = XMVectorMax(radiusSq, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&v.Position), center)));
+
+    Vec3 centerPos;
+    XMStoreFloat3(&centerPos, center);
+
+    return BoundingSphere(XMVectorGetX(XMVectorSqrt(radiusSq)), centerPos);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "engiXDefs.h"
+#include "ViewInterfaces.h"
+#include "Geometry.h"
+#include "CollisionDetection.h"
+
+namespace engiX
+{
+    enum MeshShape
+    {
+        MESH_Box,
+        MESH_Geosphere,
+        MESH_Grid,
+        MESH_Cylinder
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // MeshKey class
+    //
+    // GeometryGenerator parameters of a mesh, meshes with equal keys have the same geometry. The unused dimensions
+    // and tessellation counts of a shape are 0.
+    //---------------------------------------------------------------------------------------------------------------------
+    class MeshKey
+    {
+    public:
+        static MeshKey Box(_In_ real width, _In_ real height, _In_ real depth);
+        static MeshKey Geosphere(_In_ real radius, _In_ unsigned subdivisionCount);
+        static MeshKey Grid(_In_ real width, _In_ real depth, _In_ unsigned rowCount, _In_ unsigned columnCount);
+        static MeshKey Cylinder(_In_ real bottomRadius, _In_ real topRadius, _In_ real height, _In_ unsigned sliceCount, _In_ unsigned stackCount);
+
+        bool operator == (_In_ const MeshKey& other) const;
+        size_t Hash() const;
+
+        MeshShape Shape;
+        real Dimensions[3];
+        unsigned Tessellation[2];
+
+    protected:
+        MeshKey(_In_ MeshShape shape);
+    };
+
+    struct MeshKeyHash
+    {
+        size_t operator () (_In_ const MeshKey& key) const { return key.Hash(); }
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // SharedMesh class
+    //
+    // Generated geometry shared by all the scene nodes with the same MeshKey, it holds the CPU copy of the vertices
+    // and indices and the device mesh. The device mesh is released when the last node releases the shared mesh.
+    //---------------------------------------------------------------------------------------------------------------------
+    class SharedMesh
+    {
+        friend class MeshCache;
+
+    public:
+        SharedMesh(_In_ const MeshKey& key, _In_ std::shared_ptr<IRenderDevice> pDevice);
+        ~SharedMesh();
+        const MeshKey& Key() const { return m_key; }
+        MeshHandle Handle() const { return m_handle; }
+        const std::vector<Vertex_Position>& Vertices() const { return m_vertices; }
+        const std::vector<unsigned>& Indices() const { return m_indices; }
+        const BoundingSphere& LocalBounds() const { return m_localBounds; }
+
+    protected:
+        DISALLOW_COPY_AND_ASSIGN(SharedMesh);
+
+        MeshKey m_key;
+        std::shared_ptr<IRenderDevice> m_pDevice;
+        MeshHandle m_handle;
+        std::vector<Vertex_Position> m_vertices;
+        std::vector<unsigned> m_indices;
+        BoundingSphere m_localBounds;
+    };
+
+    typedef std::shared_ptr<SharedMesh> StrongSharedMeshPtr;
+    typedef std::weak_ptr<SharedMesh> WeakSharedMeshPtr;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // MeshCache class
+    //
+    // Content addressed store of the scene generated meshes. Acquire returns the live SharedMesh of a key or
+    // generates it, the cache only holds weak references so the nodes shared pointers are the reference count. The
+    // device mesh is created on the first CreateDeviceMesh of a shared mesh, OnConstruct creates all the live meshes
+    // again after a device reset.
+    //---------------------------------------------------------------------------------------------------------------------
+    class MeshCache
+    {
+    public:
+        MeshCache(_In_ std::shared_ptr<IRenderDevice> pDevice);
+        StrongSharedMeshPtr Acquire(_In_ const MeshKey& key);
+        HRESULT CreateDeviceMesh(_Inout_ SharedMesh& mesh);
+        HRESULT OnConstruct();
+        // Meshes referenced by at least one node
+        size_t LiveCount() const;
+
+    protected:
+        DISALLOW_COPY_AND_ASSIGN(MeshCache);
+
+        typedef std::unordered_map<MeshKey, WeakSharedMeshPtr, MeshKeyHash> MeshRegistry;
+
+        static void Generate(_Inout_ SharedMesh& mesh);
+        static BoundingSphere CalcLocalBounds(_In_ const std::vector<Vertex_Position>& vertices);
+        void RemoveExpired();
+
+        std::shared_ptr<IRenderDevice> m_pDevice;
+        MeshRegistry m_meshes;
+        // Registry size after the last expired meshes removal
+        size_t m_sizeAfterRemoval;
+    };
+}
@@ -0,0 +1,29 @@
+#include "NullGameView.h"
+#include <sstream>
+#include "NullRenderDevice.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+bool NullGameView::Init()
+{
+    m_pScene = StrongGameScenePtr(eNEW GameScene(shared_ptr<IRenderDevice>(eNEW NullRenderDevice), m_pLogic));
+    m_pScene->AspectRatio(m_aspectRatio);
+    CBRB(m_pScene->Init());
+
+    return true;
+}
+
+wstring NullGameView::FrameStats() const
+{
+    const FrustumCuller& culler = m_pScene->Culler();
+    const RenderStats& renderStats = m_pScene->FrameStats();
+
+    wostringstream outs;
+    outs << L"Visible: " << culler.VisibleCount() << L" Culled: " << culler.CulledCount()
+        << L" Draws: " << renderStats.DrawCount << L" Triangles: " << renderStats.TriangleCount
+        << L" State changes: " << renderStats.StateChangeCount << L" Traversal (ms): " << m_pScene->TraversalTime() * 1000.0f;
+
+    return outs.str();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+#include <memory>
+#include "Timer.h"
+#include "ViewInterfaces.h"
+#include "GameScene.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // NullGameView class
+    //
+    // Game view without a window or a graphics device. It runs the same scene update, transform propagation, culling
+    // and draws traversal as the HumanD3dGameView but submits the draws to a NullRenderDevice, so the frame stats
+    // give the scene cost without the driver and GPU cost. It ignores the window messages, the aspect ratio of its
+    // cameras is given on construction since there is no window to take it from.
+    //---------------------------------------------------------------------------------------------------------------------
+    class NullGameView : public IGameView
+    {
+    public:
+        NullGameView(_In_ GameLogic* pLogic, _In_ real aspectRatio) :
+            m_pLogic(pLogic),
+            m_aspectRatio(aspectRatio)
+        {}
+
+        bool Init();
+        void OnRender() { m_pScene->OnRender(); }
+        void OnUpdate(_In_ const Timer& time) { m_pScene->OnUpdate(time); }
+        HRESULT OnConstruct() { return m_pScene->OnConstruct(); }
+        bool OnMsgProc(_In_ const Timer& time, _In_ UINT uMsg, _In_ WPARAM wParam, _In_ LPARAM lParam) { return false; }
+        std::wstring FrameStats() const;
+        StrongGameScenePtr Scene() { return m_pScene; }
+
+    protected:
+        StrongGameScenePtr m_pScene;
+        GameLogic* m_pLogic;
+        real m_aspectRatio;
+    };
+}
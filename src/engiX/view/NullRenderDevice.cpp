@@ -0,0 +1,55 @@
+#include "NullRenderDevice.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+void NullRenderDevice::BeginFrame()
+{
+    m_boundIndexCount = 0;
+    m_frameStats.Reset();
+}
+
+HRESULT NullRenderDevice::CreateMesh(_In_ const Vertex_Position* pVertices, _In_ size_t vertexCount,
+    _In_ const unsigned* pIndices, _In_ size_t indexCount, _Out_ MeshHandle& mesh)
+{
+    size_t slot;
+    if (!m_freeMeshSlots.empty())
+    {
+        slot = m_freeMeshSlots.back();
+        m_freeMeshSlots.pop_back();
+        m_meshIndexCounts[slot] = (unsigned)indexCount;
+    }
+    else
+    {
+        slot = m_meshIndexCounts.size();
+        m_meshIndexCounts.push_back((unsigned)indexCount);
+    }
+
+    mesh = slot + 1;
+
+    return S_OK;
+}
+
+void NullRenderDevice::ReleaseMesh(_In_ MeshHandle mesh)
+{
+    if (mesh == NullMeshHandle || mesh > m_meshIndexCounts.size())
+        return;
+
+    m_meshIndexCounts[mesh - 1] = 0;
+    m_freeMeshSlots.push_back(mesh - 1);
+}
+
+void NullRenderDevice::BindMesh(_In_ MeshHandle mesh)
+{
+    _ASSERTE(mesh != NullMeshHandle && mesh <= m_meshIndexCounts.size());
+
+    m_boundIndexCount = m_meshIndexCounts[mesh - 1];
+    ++m_frameStats.StateChangeCount;
+}
+
+void NullRenderDevice::DrawIndexed(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color)
+{
+    ++m_frameStats.DrawCount;
+    m_frameStats.TriangleCount += m_boundIndexCount / 3;
+}
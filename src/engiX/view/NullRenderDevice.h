@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include "ViewInterfaces.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // NullRenderDevice class
+    //
+    // IRenderDevice that creates no resources and submits nothing, it only keeps each mesh index count so that the
+    // draws and binds are counted as on a real device. Used by the NullGameView to run the scene without a graphics
+    // API and to benchmark the RenderQueue.
+    //---------------------------------------------------------------------------------------------------------------------
+    class NullRenderDevice : public IRenderDevice
+    {
+    public:
+        NullRenderDevice() : m_boundIndexCount(0) {}
+        HRESULT OnConstruct() { return S_OK; }
+        void BeginFrame();
+        HRESULT CreateMesh(_In_ const Vertex_Position* pVertices, _In_ size_t vertexCount,
+            _In_ const unsigned* pIndices, _In_ size_t indexCount, _Out_ MeshHandle& mesh);
+        void ReleaseMesh(_In_ MeshHandle mesh);
+        void BindMesh(_In_ MeshHandle mesh);
+        void BindRasterState(_In_ unsigned rasterFlags) { ++m_frameStats.StateChangeCount; }
+        void DrawIndexed(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color);
+        const RenderStats& FrameStats() const { return m_frameStats; }
+
+    protected:
+        DISALLOW_COPY_AND_ASSIGN(NullRenderDevice);
+
+        // Index count per mesh slot, 0 for a free slot
+        std::vector<unsigned> m_meshIndexCounts;
+        std::vector<size_t> m_freeMeshSlots;
+        unsigned m_boundIndexCount;
+        RenderStats m_frameStats;
+    };
+}
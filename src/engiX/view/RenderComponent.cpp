@@ -1,59 +1,41 @@
 #include "RenderComponent.h"
 #include "D3dGeneratedMeshNode.h"
 #include "GameScene.h"
-#include "GeometryGenerator.h"
+#include "MeshCache.h"
 
 using namespace engiX;
 using namespace std;
 
+const ComponentID RenderComponent::TypeID;
+
 shared_ptr<ISceneNode> BoxMeshComponent::CreateSceneNode(_In_ GameScene* pScene)
 {
-    GeometryGenerator g;
-    GeometryGenerator::MeshData data;
-
-    g.CreateBox(m_props.Width, m_props.Height, m_props.Depth, data);
-    data.IsBackfacing = m_props.IsBackfacing;
-    data.IsWireframe = m_props.IsWireframe;
+    MeshKey mesh = MeshKey::Box(m_props.Width, m_props.Height, m_props.Depth);
 
     _ASSERTE(pScene);
-    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), data, m_props.Color, pScene));
+    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), mesh, m_props.Color, m_props.RasterFlags(), pScene));
 }
 
 shared_ptr<ISceneNode> SphereMeshComponent::CreateSceneNode(_In_ GameScene* pScene)
 {
-    GeometryGenerator g;
-    GeometryGenerator::MeshData data;
-
-    g.CreateGeosphere(m_props.Radius, 2, data);
-    data.IsBackfacing = m_props.IsBackfacing;
-    data.IsWireframe = m_props.IsWireframe;
+    MeshKey mesh = MeshKey::Geosphere(m_props.Radius, 2);
 
     _ASSERTE(pScene);
-    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), data, m_props.Color, pScene));
+    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), mesh, m_props.Color, m_props.RasterFlags(), pScene));
 }
 
 shared_ptr<ISceneNode> GridMeshComponent::CreateSceneNode(_In_ GameScene* pScene)
 {
-    GeometryGenerator g;
-    GeometryGenerator::MeshData data;
-
-    g.CreateGrid(m_props.Width, m_props.Depth, 10, 10, data);
-    data.IsBackfacing = m_props.IsBackfacing;
-    data.IsWireframe = m_props.IsWireframe;
+    MeshKey mesh = MeshKey::Grid(m_props.Width, m_props.Depth, 10, 10);
 
     _ASSERTE(pScene);
-    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), data, m_props.Color, pScene));
+    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), mesh, m_props.Color, m_props.RasterFlags(), pScene));
 }
 
 shared_ptr<ISceneNode> CylinderMeshComponent::CreateSceneNode(_In_ GameScene* pScene)
 {
-    GeometryGenerator g;
-    GeometryGenerator::MeshData data;
-
-    g.CreateCylinder(m_props.BottomRadius, m_props.TopRadius, m_props.Height, m_props.SliceCount, m_props.StackCount, data);
-    data.IsBackfacing = m_props.IsBackfacing;
-    data.IsWireframe = m_props.IsWireframe;
+    MeshKey mesh = MeshKey::Cylinder(m_props.BottomRadius, m_props.TopRadius, m_props.Height, m_props.SliceCount, m_props.StackCount);
 
     _ASSERTE(pScene);
-    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), data, m_props.Color, pScene));
+    return shared_ptr<ISceneNode>(eNEW D3dGeneratedMeshNode(Owner()->Id(), mesh, m_props.Color, m_props.RasterFlags(), pScene));
 }
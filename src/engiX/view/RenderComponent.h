@@ -2,7 +2,7 @@
 
 #include <memory>
 #include "Geometry.h"
-#include "D3dShader.h"
+#include "ViewInterfaces.h"
 #include "Actor.h"
 #include "GeometryGenerator.h"
 
@@ -34,6 +34,8 @@ namespace engiX
             IsBackfacing(false)
         {}
 
+        unsigned RasterFlags() const { return (IsWireframe ? RASTER_Wireframe : 0) | (IsBackfacing ? RASTER_Backfacing : 0); }
+
         Color3 Color;
         bool IsWireframe;
         bool IsBackfacing;
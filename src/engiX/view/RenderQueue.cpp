@@ -0,0 +1,91 @@
+#include "RenderQueue.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+static const unsigned RasterKeyShift = 56;
+static const unsigned MeshKeyShift = 32;
+static const uint64_t ItemIndexMask = 0xFFFFFFFFULL;
+// The item index bytes are in order already, only the state bytes are sorted
+static const unsigned FirstSortedByte = 4;
+static const unsigned ByteValueCount = 256;
+
+void RenderQueue::Clear()
+{
+    m_keys.clear();
+    m_worldViewProjs.clear();
+    m_colors.clear();
+}
+
+void RenderQueue::Add(_In_ MeshHandle mesh, _In_ unsigned rasterFlags, _In_ const Mat4x4& worldViewProj, _In_ const Color3& color)
+{
+    _ASSERTE(mesh != NullMeshHandle && mesh <= MaxMeshHandle);
+    _ASSERTE(rasterFlags < ByteValueCount);
+    _ASSERTE(m_keys.size() <= ItemIndexMask);
+
+    uint64_t key = ((uint64_t)rasterFlags << RasterKeyShift) | ((uint64_t)mesh << MeshKeyShift) | (uint64_t)m_keys.size();
+
+    m_keys.push_back(key);
+    m_worldViewProjs.push_back(worldViewProj);
+    m_colors.push_back(color);
+}
+
+void RenderQueue::Sort()
+{
+    const size_t count = m_keys.size();
+    m_sortedKeys.resize(count);
+
+    for (unsigned byteIdx = FirstSortedByte; byteIdx < sizeof(uint64_t); ++byteIdx)
+    {
+        const unsigned shift = byteIdx * 8;
+        size_t offsets[ByteValueCount] = { 0 };
+
+        for (size_t i = 0; i < count; ++i)
+            ++offsets[(m_keys[i] >> shift) & 0xFF];
+
+        // All the keys in one bucket, the pass would not move anything
+        if (count == 0 || offsets[(m_keys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        size_t sum = 0;
+        for (unsigned v = 0; v < ByteValueCount; ++v)
+        {
+            size_t bucketSize = offsets[v];
+            offsets[v] = sum;
+            sum += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            m_sortedKeys[offsets[(m_keys[i] >> shift) & 0xFF]++] = m_keys[i];
+
+        m_keys.swap(m_sortedKeys);
+    }
+}
+
+void RenderQueue::Submit(_In_ IRenderDevice& device) const
+{
+    MeshHandle boundMesh = NullMeshHandle;
+    unsigned boundRasterFlags = ByteValueCount;
+
+    for (uint64_t key : m_keys)
+    {
+        unsigned rasterFlags = (unsigned)(key >> RasterKeyShift);
+        MeshHandle mesh = (MeshHandle)((key >> MeshKeyShift) & MaxMeshHandle);
+
+        if (rasterFlags != boundRasterFlags)
+        {
+            device.BindRasterState(rasterFlags);
+            boundRasterFlags = rasterFlags;
+        }
+
+        if (mesh != boundMesh)
+        {
+            device.BindMesh(mesh);
+            boundMesh = mesh;
+        }
+
+        size_t itemIdx = (size_t)(key & ItemIndexMask);
+        device.DrawIndexed(m_worldViewProjs[itemIdx], m_colors[itemIdx]);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "engiXDefs.h"
+#include "ViewInterfaces.h"
+
+namespace engiX
+{
+    //---------------------------------------------------------------------------------------------------------------------
+    // RenderQueue class
+    //
+    // Draw items collected by the scene traversal and submitted to an IRenderDevice in state order. An item is a
+    // 64-bit key, a world view projection matrix and an instance color kept in 3 flat arrays. The key holds the
+    // rasterizer state in the top byte, the mesh handle in the next 24 bits and the item index in the low 32 bits, so
+    // that sorting the keys alone groups the items by state then by mesh and keeps the traversal order inside a group.
+    //
+    // Sort is a least significant digit radix sort over the 4 state bytes, a byte pass is skipped when all the keys
+    // share the same byte value, e.g the rasterizer state byte when all the meshes are solid. Submit binds the
+    // rasterizer state and mesh only when they differ from the previous item ones.
+    //---------------------------------------------------------------------------------------------------------------------
+    class RenderQueue
+    {
+    public:
+        static const unsigned MeshKeyBits = 24;
+        static const MeshHandle MaxMeshHandle = (1 << MeshKeyBits) - 1;
+
+        RenderQueue() {}
+        void Clear();
+        void Add(_In_ MeshHandle mesh, _In_ unsigned rasterFlags, _In_ const Mat4x4& worldViewProj, _In_ const Color3& color);
+        void Sort();
+        void Submit(_In_ IRenderDevice& device) const;
+        size_t Size() const { return m_keys.size(); }
+
+    protected:
+        DISALLOW_COPY_AND_ASSIGN(RenderQueue);
+
+        std::vector<uint64_t> m_keys;
+        std::vector<uint64_t> m_sortedKeys;
+        std::vector<Mat4x4> m_worldViewProjs;
+        std::vector<Color3> m_colors;
+    };
+}
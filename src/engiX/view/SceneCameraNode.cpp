@@ -1,6 +1,6 @@
 #include "SceneCameraNode.h"
 #include "MathHelper.h"
-#include "WinGameApp.h"
+#include "GameScene.h"
 #include "EventManager.h"
 #include "GameLogic.h"
 
@@ -18,6 +18,7 @@ m_farPlane(DefaultFarPlane),
 m_fovAngle(DefaultFovAngle),
 m_targetId(NullActorID)
 {
+    XMStoreFloat4x4(&m_worldTsfm, XMMatrixIdentity());
     XMStoreFloat4x4(&m_projMat, XMMatrixIdentity());
 }
 
@@ -25,7 +26,7 @@ HRESULT SceneCameraNode::OnConstruct()
 {
     LogInfo("Display settings changed, updating camera");
 
-    real aspectRatio = g_pApp->AspectRatio();
+    real aspectRatio = m_pScene->AspectRatio();
     XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f * R_PI, aspectRatio, m_nearPlane, m_farPlane);
     XMStoreFloat4x4(&m_projMat, P);
 
@@ -38,13 +39,12 @@ void SceneCameraNode::OnUpdate(_In_ const Timer& time)
     
     if (m_targetId != NullActorID)
     {
-        auto& a = g_pApp->Logic()->GetActor(m_targetId);
-        auto& targetTsfm = a.Get<TransformCmpt>();
+        auto& a = m_pScene->Logic()->GetActor(m_targetId);
+        QuatTransform targetTsfm = a.Get<TransformCmpt>().World();
+        Vec3 pos = targetTsfm.TransformPoint(m_pos);
+        Vec3 lookat = targetTsfm.TransformPoint(m_lookat);
 
-        cameraTsfm = XMMatrixLookAtLH(
-            XMVector3TransformCoord(XMLoadFloat3(&m_pos), XMLoadFloat4x4(&targetTsfm.Transform())),
-            XMVector3TransformCoord(XMLoadFloat3(&m_lookat), XMLoadFloat4x4(&targetTsfm.Transform())),
-            g_XMIdentityR1);
+        cameraTsfm = XMMatrixLookAtLH(XMLoadFloat3(&pos), XMLoadFloat3(&lookat), g_XMIdentityR1);
     }
     else
     {
@@ -56,9 +56,7 @@ void SceneCameraNode::OnUpdate(_In_ const Timer& time)
 
 Mat4x4 SceneCameraNode::SceneWorldViewProjMatrix() const
 {
-    const Mat4x4 sceneWorldTsfm = m_pScene->TopTransformation();
-
-    XMMATRIX world = XMLoadFloat4x4(&sceneWorldTsfm);
+    XMMATRIX world = XMLoadFloat4x4(&m_pScene->WorldTransformation());
     XMMATRIX view = XMLoadFloat4x4(&m_worldTsfm);
     XMMATRIX proj = XMLoadFloat4x4(&m_projMat);
 
@@ -71,6 +69,14 @@ Mat4x4 SceneCameraNode::SceneWorldViewProjMatrix() const
     return wvp;
 }
 
+Mat4x4 SceneCameraNode::ViewProjMatrix() const
+{
+    Mat4x4 viewProj;
+    XMStoreFloat4x4(&viewProj, XMMatrixMultiply(XMLoadFloat4x4(&m_worldTsfm), XMLoadFloat4x4(&m_projMat)));
+
+    return viewProj;
+}
+
 void SceneCameraNode::PlaceOnSphere(_In_ real radius, _In_ real theta, _In_ real phi, _In_ Vec3 lookat)
 {
     Math::ConvertSphericalToCartesian(radius, theta, phi, m_pos);
@@ -21,6 +21,7 @@ namespace engiX
         virtual ~SceneCameraNode() {}
 
         Mat4x4 SceneWorldViewProjMatrix() const;
+        Mat4x4 ViewProjMatrix() const;
 
         // Place the camera in its own space using spherical coordinates (radius r, inclination Theta, azimuth Phi)
         // Radius r: The radius of the spherical coordinate system
@@ -38,6 +39,7 @@ namespace engiX
         void SetAsThirdPerson(ActorID targetId) { m_targetId = targetId; }
 
     protected:
+        Mat4x4 m_worldTsfm;
         Mat4x4 m_projMat;
         real m_nearPlane;
         real m_farPlane;
@@ -0,0 +1,194 @@
+#include "SceneHierarchy.h"
+#include "SceneNode.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+SceneHierarchy::SceneHierarchy() :
+    m_removedCount(0),
+    m_isUnsorted(false)
+{
+}
+
+bool SceneHierarchy::Add(_In_ shared_ptr<SceneNode> pNode, _In_ ActorID parentId)
+{
+    _ASSERTE(pNode);
+
+    ActorID actorId = pNode->ActorId();
+
+    if (m_nodeIndex.find(actorId) != m_nodeIndex.end())
+    {
+        LogWarning("Actor[%x] already has a scene node in the hierarchy", actorId);
+        return false;
+    }
+
+    size_t parentIdx = NullIndex;
+    unsigned depth = 0;
+
+    if (parentId != NullActorID)
+    {
+        parentIdx = Find(parentId);
+
+        if (parentIdx == NullIndex)
+        {
+            LogWarning("Actor[%x] scene node parent Actor[%x] is not in the hierarchy", actorId, parentId);
+            return false;
+        }
+
+        depth = m_depths[parentIdx] + 1;
+    }
+
+    if (!m_depths.empty() && depth < m_depths.back())
+        m_isUnsorted = true;
+
+    Mat4x4 identity;
+    XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+    size_t idx = m_nodes.size();
+
+    m_nodes.push_back(pNode);
+    m_parents.push_back(parentIdx);
+    m_depths.push_back(depth);
+    m_localTsfms.push_back(identity);
+    m_worldTsfms.push_back(identity);
+    m_localBounds.push_back(pNode->LocalBounds());
+    m_nodeIndex[actorId] = idx;
+    pNode->m_hierarchyIdx = idx;
+
+    return true;
+}
+
+// The descendants are left in place, Compact removes them since their parent is gone
+bool SceneHierarchy::Remove(_In_ ActorID actorId)
+{
+    auto where = m_nodeIndex.find(actorId);
+
+    if (where == m_nodeIndex.end())
+        return false;
+
+    size_t idx = where->second;
+    m_nodeIndex.erase(where);
+
+    m_nodes[idx]->m_hierarchyIdx = NullIndex;
+    m_nodes[idx].reset();
+    ++m_removedCount;
+
+    return true;
+}
+
+size_t SceneHierarchy::Find(_In_ ActorID actorId) const
+{
+    auto where = m_nodeIndex.find(actorId);
+
+    return (where == m_nodeIndex.end() ? NullIndex : where->second);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Stable counting sort by depth that skips the removed nodes:
+//  1. Walking in the current order reaches a parent before its children, so a node whose parent got removed is
+//     removed on the spot, and the live nodes are counted per depth
+//  2. The depth counts prefix sum gives each depth first index, the live nodes are scattered there in their current
+//     order and their parent index is remapped, parents are already placed since they come first
+//---------------------------------------------------------------------------------------------------------------------
+void SceneHierarchy::Compact()
+{
+    if (m_removedCount == 0 && !m_isUnsorted)
+        return;
+
+    const size_t count = m_nodes.size();
+
+    m_depthOffsets.clear();
+    m_newIndices.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t parentIdx = m_parents[i];
+
+        if (m_nodes[i] && parentIdx != NullIndex && !m_nodes[parentIdx])
+        {
+            m_nodeIndex.erase(m_nodes[i]->ActorId());
+            m_nodes[i]->m_hierarchyIdx = NullIndex;
+            m_nodes[i].reset();
+        }
+
+        if (!m_nodes[i])
+            continue;
+
+        unsigned depth = m_depths[i];
+
+        if (depth >= m_depthOffsets.size())
+            m_depthOffsets.resize(depth + 1, 0);
+
+        ++m_depthOffsets[depth];
+    }
+
+    size_t liveCount = 0;
+
+    for (size_t d = 0; d < m_depthOffsets.size(); ++d)
+    {
+        size_t depthCount = m_depthOffsets[d];
+        m_depthOffsets[d] = liveCount;
+        liveCount += depthCount;
+    }
+
+    m_sortedNodes.resize(liveCount);
+    m_sortedParents.resize(liveCount);
+    m_sortedDepths.resize(liveCount);
+    m_sortedLocalTsfms.resize(liveCount);
+    m_sortedLocalBounds.resize(liveCount);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!m_nodes[i])
+            continue;
+
+        size_t newIdx = m_depthOffsets[m_depths[i]]++;
+        size_t parentIdx = m_parents[i];
+
+        m_newIndices[i] = newIdx;
+        m_sortedParents[newIdx] = (parentIdx == NullIndex ? NullIndex : m_newIndices[parentIdx]);
+        m_sortedDepths[newIdx] = m_depths[i];
+        m_sortedLocalTsfms[newIdx] = m_localTsfms[i];
+        m_sortedLocalBounds[newIdx] = m_localBounds[i];
+        m_sortedNodes[newIdx].swap(m_nodes[i]);
+
+        m_sortedNodes[newIdx]->m_hierarchyIdx = newIdx;
+        m_nodeIndex[m_sortedNodes[newIdx]->ActorId()] = newIdx;
+    }
+
+    m_nodes.swap(m_sortedNodes);
+    m_parents.swap(m_sortedParents);
+    m_depths.swap(m_sortedDepths);
+    m_localTsfms.swap(m_sortedLocalTsfms);
+    m_localBounds.swap(m_sortedLocalBounds);
+    m_worldTsfms.resize(liveCount);
+
+    // The scratch nodes are the old slots, all moved out or removed
+    m_sortedNodes.clear();
+
+    m_removedCount = 0;
+    m_isUnsorted = false;
+}
+
+// Parents come first, their world matrix is final by the time their children read it
+void SceneHierarchy::UpdateWorld()
+{
+    const size_t count = m_nodes.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t parentIdx = m_parents[i];
+
+        if (parentIdx == NullIndex)
+        {
+            m_worldTsfms[i] = m_localTsfms[i];
+        }
+        else
+        {
+            XMStoreFloat4x4(&m_worldTsfms[i],
+                XMMatrixMultiply(XMLoadFloat4x4(&m_localTsfms[i]), XMLoadFloat4x4(&m_worldTsfms[parentIdx])));
+        }
+    }
+}
+
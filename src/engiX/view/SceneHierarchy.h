@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "engiXDefs.h"
+#include "Actor.h"
+#include "CollisionDetection.h"
+
+namespace engiX
+{
+    class SceneNode;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // SceneHierarchy class
+    //
+    // Flattened scene graph: the nodes, their parent index, depth, local and world matrices live in parallel arrays
+    // sorted by depth, so a parent always comes before its children and UpdateWorld computes all the world matrices
+    // in one linear pass, with no recursion and no transformation stack. Top level nodes have no parent, their world
+    // matrix is their local one.
+    //
+    // Add appends and Remove clears the node slot, both O(1) through the ActorID index. Removing a node removes its
+    // descendants too. Compact drops the removed nodes and restores the depth order in one stable counting sort pass
+    // when needed, it runs at most once per frame before the nodes update their local matrix.
+    //---------------------------------------------------------------------------------------------------------------------
+    class SceneHierarchy
+    {
+    public:
+        static const size_t NullIndex = size_t(-1);
+
+        SceneHierarchy();
+        bool Add(_In_ std::shared_ptr<SceneNode> pNode, _In_ ActorID parentId = NullActorID);
+        bool Remove(_In_ ActorID actorId);
+        size_t Find(_In_ ActorID actorId) const;
+        void Compact();
+        void UpdateWorld();
+        size_t Size() const { return m_nodes.size(); }
+        // Null for the removed nodes until the next Compact
+        SceneNode* Node(_In_ size_t idx) const { return m_nodes[idx].get(); }
+        size_t Parent(_In_ size_t idx) const { return m_parents[idx]; }
+        unsigned Depth(_In_ size_t idx) const { return m_depths[idx]; }
+        void LocalTransform(_In_ size_t idx, _In_ const Mat4x4& tsfm) { m_localTsfms[idx] = tsfm; }
+        const Mat4x4& LocalTransform(_In_ size_t idx) const { return m_localTsfms[idx]; }
+        const Mat4x4& WorldTransform(_In_ size_t idx) const { return m_worldTsfms[idx]; }
+        // Copied from the node when added, see SceneNode::LocalBounds
+        void LocalBounds(_In_ size_t idx, _In_ const BoundingSphere& bounds) { m_localBounds[idx] = bounds; }
+        const BoundingSphere& LocalBounds(_In_ size_t idx) const { return m_localBounds[idx]; }
+
+    private:
+        std::vector<std::shared_ptr<SceneNode>> m_nodes;
+        std::vector<size_t> m_parents;
+        std::vector<unsigned> m_depths;
+        std::vector<Mat4x4> m_localTsfms;
+        std::vector<Mat4x4> m_worldTsfms;
+        std::vector<BoundingSphere> m_localBounds;
+        std::unordered_map<ActorID, size_t> m_nodeIndex;
+        size_t m_removedCount;
+        // A node was added with a smaller depth than the last one
+        bool m_isUnsorted;
+
+        // Compact scratch, kept to avoid allocations every compaction
+        std::vector<size_t> m_depthOffsets;
+        std::vector<size_t> m_newIndices;
+        std::vector<std::shared_ptr<SceneNode>> m_sortedNodes;
+        std::vector<size_t> m_sortedParents;
+        std::vector<unsigned> m_sortedDepths;
+        std::vector<Mat4x4> m_sortedLocalTsfms;
+        std::vector<BoundingSphere> m_sortedLocalBounds;
+    };
+}
@@ -1,50 +1,47 @@
 #pragma once
 
-#include <set>
 #include "ViewInterfaces.h"
 #include "Actor.h"
 #include "engiXDefs.h"
 #include "Actor.h"
 #include "TransformCmpt.h"
+#include "CollisionDetection.h"
 
 namespace engiX
 {
     class GameScene;
-    class SceneNode;
-
-    typedef std::set<std::shared_ptr<SceneNode>> NodeList;
+    class SceneHierarchy;
 
+    //---------------------------------------------------------------------------------------------------------------------
+    // SceneNode class
+    //
+    // Node of an actor in the GameScene hierarchy. OnUpdate writes the actor transform as the node local matrix, the
+    // hierarchy computes the world matrix that is current while the node renders, see GameScene::WorldTransformation.
+    // The local bounds sphere encloses the node geometry in its local space for the frustum culling, nodes which do
+    // not set it are never culled.
+    //---------------------------------------------------------------------------------------------------------------------
     class SceneNode : public ISceneNode
     {
+        friend class SceneHierarchy;
+
     public:
         SceneNode(_In_ ActorID actorId, _In_ GameScene* pScene);
-        HRESULT OnPreRender();
-        void OnPostRender();
-        HRESULT OnConstruct();
+        HRESULT OnPreRender() { return S_OK; }
+        void OnPostRender() {}
+        HRESULT OnConstruct() { return S_OK; }
         void OnUpdate(_In_ const Timer& time);
-        bool AddChild(_In_ std::shared_ptr<ISceneNode> pChild);
-        bool RemoveChild(_In_ ActorID actor);
-        void RenderChildren();
         GameScene* Scene() { return m_pScene; }
-        ISceneNode* Parent() const { return m_pParent; }
-        void Parent(ISceneNode* pParent) { m_pParent = pParent; }
+        ActorID ActorId() const { return m_actorId; }
+        // In the scene hierarchy arrays, changes when the hierarchy compacts
+        size_t HierarchyIndex() const { return m_hierarchyIdx; }
+        const BoundingSphere& LocalBounds() const { return m_localBounds; }
 
     protected:
         ActorID m_actorId;
         GameScene *m_pScene;
-        NodeList m_children;
-        ISceneNode* m_pParent;
-        Mat4x4 m_worldTsfm;
-    };
-
-    class RootSceneNode : public SceneNode
-    {
-    public:
-        RootSceneNode(GameScene* pScene) :
-            SceneNode(NullActorID, pScene)
-        {
-        }
+        BoundingSphere m_localBounds;
 
-        void OnRender() {}
+    private:
+        size_t m_hierarchyIdx;
     };
-}
\ No newline at end of file
+}
@@ -1,8 +1,12 @@
 #pragma once
 
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
+#include <string>
 #include "Timer.h"
 #include "Actor.h"
+#include "Geometry.h"
 
 namespace engiX
 {
@@ -17,6 +21,8 @@ namespace engiX
         virtual void OnUpdate(_In_ const Timer& time) = 0;
         virtual HRESULT OnConstruct() = 0;
         virtual bool OnMsgProc(_In_ const Timer& time, _In_ UINT uMsg, _In_ WPARAM wParam, _In_ LPARAM lParam) = 0;
+        // Appended to the app frame statistics
+        virtual std::wstring FrameStats() const = 0;
     };
 
     class ISceneNode
@@ -26,23 +32,70 @@ namespace engiX
         virtual HRESULT OnPreRender() = 0;
         virtual void OnPostRender() = 0;
         virtual void OnRender() = 0;
-        virtual void RenderChildren() = 0;
         virtual void OnUpdate(_In_ const Timer& time) = 0;
         virtual HRESULT OnConstruct() = 0;
-        virtual bool AddChild(_In_ std::shared_ptr<ISceneNode> pChild) = 0;
-        virtual bool RemoveChild(_In_ ActorID actor) = 0;
         virtual GameScene* Scene() = 0;
-        virtual ISceneNode* Parent() const = 0;
-        virtual void Parent(ISceneNode* pParent) = 0;
     };
 
     class ID3dShader
     {
     public:
         virtual ~ID3dShader() {}
-        virtual HRESULT OnPreRender(ISceneNode* pNode) = 0;
+        virtual void BindInputLayout() = 0;
+        virtual HRESULT OnPreRender(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color) = 0;
         virtual HRESULT OnConstruct() = 0;
     };
 
+    // Device mesh, 0 is no mesh
+    typedef size_t MeshHandle;
+    const MeshHandle NullMeshHandle = 0;
+
+    enum RasterFlags
+    {
+        RASTER_Wireframe = 0x1,
+        RASTER_Backfacing = 0x2
+    };
+
+    struct RenderStats
+    {
+        RenderStats() { Reset(); }
+
+        void Reset()
+        {
+            DrawCount = 0;
+            TriangleCount = 0;
+            StateChangeCount = 0;
+        }
+
+        unsigned DrawCount;
+        unsigned TriangleCount;
+        // Mesh and rasterizer state binds
+        unsigned StateChangeCount;
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    // IRenderDevice interface
+    //
+    // Where the scene nodes create their meshes and the RenderQueue submits their draws, so that the scene update and
+    // traversal do not depend on the graphics API. Meshes are created again on OnConstruct, the device is reset.
+    // A draw uses the mesh and the rasterizer state bound last, the binds are kept until the next BeginFrame so that
+    // the caller only binds what changes between draws. The stats count the draws and binds since the last BeginFrame.
+    //---------------------------------------------------------------------------------------------------------------------
+    class IRenderDevice
+    {
+    public:
+        virtual ~IRenderDevice() {}
+        virtual HRESULT OnConstruct() = 0;
+        virtual void BeginFrame() = 0;
+        virtual HRESULT CreateMesh(_In_ const Vertex_Position* pVertices, _In_ size_t vertexCount,
+            _In_ const unsigned* pIndices, _In_ size_t indexCount, _Out_ MeshHandle& mesh) = 0;
+        virtual void ReleaseMesh(_In_ MeshHandle mesh) = 0;
+        virtual void BindMesh(_In_ MeshHandle mesh) = 0;
+        // rasterFlags is a RasterFlags combination
+        virtual void BindRasterState(_In_ unsigned rasterFlags) = 0;
+        virtual void DrawIndexed(_In_ const Mat4x4& worldViewProj, _In_ const Color3& color) = 0;
+        virtual const RenderStats& FrameStats() const = 0;
+    };
+
 
 }
\ No newline at end of file
@@ -1,18 +1,18 @@
 //***************************************************************************************
 // color.fx by Frank Luna (C) 2011 All Rights Reserved.
 //
-// Transforms and colors geometry.
+// Transforms geometry and colors it with the per object color.
 //***************************************************************************************
 
 cbuffer cbPerObject
 {
 	float4x4 gWorldViewProj; 
+	float4 gColor;
 };
 
 struct VertexIn
 {
 	float3 PosL  : POSITION;
-    float4 Color : COLOR;
 };
 
 struct VertexOut
@@ -28,8 +28,8 @@ VertexOut VS(VertexIn vin)
 	// Transform to homogeneous clip space.
 	vout.PosH = mul(float4(vin.PosL, 1.0f), gWorldViewProj);
 	
-	// Just pass vertex color into the pixel shader.
-    vout.Color = vin.Color;
+	// Pass the object color into the pixel shader.
+    vout.Color = gColor;
     
     return vout;
 }
@@ -0,0 +1,1007 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "engiXDefs.h"
+#include "Timer.h"
+#include "SpatialHashBroadphase.h"
+#include "AabbTree.h"
+#include "BatchCollision.h"
+#include "AlignedAllocator.h"
+#include "Simd.h"
+#include "QuatTransform.h"
+#include "VecMath.h"
+#include "Random.h"
+#include "WorkerPool.h"
+#include "SimdMath.h"
+#include "RenderQueue.h"
+#include "NullRenderDevice.h"
+#include "MeshCache.h"
+#include "GeometryGenerator.h"
+#include "ParticleIntegrator.h"
+#include "GameApp.h"
+#include "GameLogic.h"
+#include "NullGameView.h"
+#include "RenderComponent.h"
+#include "TransformCmpt.h"
+
+using namespace engiX;
+using namespace std;
+using namespace DirectX;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Broadphase, spatial query and batch collision kernels benchmarks
+//
+// Spheres are spread uniformly in a cube sized to keep the density constant across the runs, so that the time per
+// sphere is comparable. The first Update builds the grid from scratch, the following ones move every sphere by a
+// fraction of a cell like a simulation step would and exercise the incremental relinking.
+//---------------------------------------------------------------------------------------------------------------------
+const real SphereRadius = 0.5f;
+const real SpheresPerUnitVolume = 0.01f;
+const real MaxStepDistance = 0.2f;
+const int IncrementalRuns = 10;
+const int QueryCount = 10000;
+const real QueryRadius = 5.0f;
+const int KernelQueryCount = 100;
+
+void BenchBroadphase(_In_ size_t sphereCount)
+{
+    real worldSize = pow(real(sphereCount) / SpheresPerUnitVolume, 1.0f / 3.0f);
+
+    mt19937 rng(1234);
+    uniform_real_distribution<real> posDist(0.0f, worldSize);
+    uniform_real_distribution<real> stepDist(-MaxStepDistance, MaxStepDistance);
+
+    vector<real> posX(sphereCount), posY(sphereCount), posZ(sphereCount);
+    vector<real> radius(sphereCount, SphereRadius);
+
+    for (size_t i = 0; i < sphereCount; ++i)
+    {
+        posX[i] = posDist(rng);
+        posY[i] = posDist(rng);
+        posZ[i] = posDist(rng);
+    }
+
+    SpatialHashBroadphase broadphase;
+    StopWatch watch;
+
+    watch.Start();
+    broadphase.Update(posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount);
+    real buildTime = watch.Stop();
+
+    real incrementalTime = 0.0f;
+
+    for (int run = 0; run < IncrementalRuns; ++run)
+    {
+        for (size_t i = 0; i < sphereCount; ++i)
+        {
+            posX[i] += stepDist(rng);
+            posY[i] += stepDist(rng);
+            posZ[i] += stepDist(rng);
+        }
+
+        watch.Start();
+        broadphase.Update(posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount);
+        incrementalTime += watch.Stop();
+    }
+
+    printf("%8u spheres: build %8.2fms, incremental update %8.2fms, %8u pairs, %8u cells\n",
+        unsigned(sphereCount),
+        buildTime * 1000.0f,
+        incrementalTime * 1000.0f / IncrementalRuns,
+        unsigned(broadphase.Pairs().size()),
+        unsigned(broadphase.CellCount()));
+}
+
+void BenchAabbTree(_In_ size_t sphereCount)
+{
+    real worldSize = pow(real(sphereCount) / SpheresPerUnitVolume, 1.0f / 3.0f);
+
+    mt19937 rng(1234);
+    uniform_real_distribution<real> posDist(0.0f, worldSize);
+    uniform_real_distribution<real> stepDist(-MaxStepDistance, MaxStepDistance);
+    uniform_real_distribution<real> dirDist(-1.0f, 1.0f);
+
+    vector<Vec3> positions(sphereCount);
+    vector<AabbProxy> proxies(sphereCount);
+
+    for (size_t i = 0; i < sphereCount; ++i)
+        positions[i] = Vec3(posDist(rng), posDist(rng), posDist(rng));
+
+    AabbTree tree;
+    StopWatch watch;
+
+    watch.Start();
+    for (size_t i = 0; i < sphereCount; ++i)
+        proxies[i] = tree.CreateProxy(AxisAlignedBox::FromSphere(positions[i], SphereRadius), ActorID(i + 1));
+    real buildTime = watch.Stop();
+
+    real refitTime = 0.0f;
+
+    for (int run = 0; run < IncrementalRuns; ++run)
+    {
+        for (size_t i = 0; i < sphereCount; ++i)
+        {
+            positions[i].x += stepDist(rng);
+            positions[i].y += stepDist(rng);
+            positions[i].z += stepDist(rng);
+        }
+
+        watch.Start();
+        for (size_t i = 0; i < sphereCount; ++i)
+            tree.RefitProxy(proxies[i], AxisAlignedBox::FromSphere(positions[i], SphereRadius));
+        tree.Refit();
+        refitTime += watch.Stop();
+    }
+
+    vector<ActorID> actors;
+    size_t hitCount = 0;
+
+    watch.Start();
+    for (int q = 0; q < QueryCount; ++q)
+    {
+        Vec3 origin(posDist(rng), posDist(rng), posDist(rng));
+        Vec3 direction(dirDist(rng), dirDist(rng), dirDist(rng));
+        tree.Raycast(origin, direction, worldSize, actors);
+        hitCount += actors.size();
+    }
+    real raycastTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < QueryCount; ++q)
+    {
+        tree.OverlapSphere(BoundingSphere(QueryRadius, Vec3(posDist(rng), posDist(rng), posDist(rng))), actors);
+        hitCount += actors.size();
+    }
+    real sphereTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < QueryCount; ++q)
+    {
+        tree.OverlapBox(AxisAlignedBox::FromSphere(Vec3(posDist(rng), posDist(rng), posDist(rng)), QueryRadius), actors);
+        hitCount += actors.size();
+    }
+    real boxTime = watch.Stop();
+
+    printf("%8u proxies: build %8.2fms, batch refit %8.2fms, height %d\n",
+        unsigned(sphereCount),
+        buildTime * 1000.0f,
+        refitTime * 1000.0f / IncrementalRuns,
+        tree.Height());
+    printf("          queries/s: raycast %10.0f, sphere %10.0f, box %10.0f (%u hits)\n",
+        QueryCount / raycastTime,
+        QueryCount / sphereTime,
+        QueryCount / boxTime,
+        unsigned(hitCount));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Compares the per call BoundingSphere tests to the BatchCollision kernels over the same SoA spheres, in millions of
+// sphere tests per second.
+//---------------------------------------------------------------------------------------------------------------------
+void BenchBatchCollision(_In_ size_t sphereCount)
+{
+    real worldSize = pow(real(sphereCount) / SpheresPerUnitVolume, 1.0f / 3.0f);
+
+    mt19937 rng(1234);
+    uniform_real_distribution<real> posDist(0.0f, worldSize);
+
+    RealArray posX(sphereCount), posY(sphereCount), posZ(sphereCount);
+    RealArray radius(sphereCount, SphereRadius);
+    vector<Vec3> queries(KernelQueryCount);
+
+    for (size_t i = 0; i < sphereCount; ++i)
+    {
+        posX[i] = posDist(rng);
+        posY[i] = posDist(rng);
+        posZ[i] = posDist(rng);
+    }
+
+    for (int q = 0; q < KernelQueryCount; ++q)
+        queries[q] = Vec3(posDist(rng), posDist(rng), posDist(rng));
+
+    vector<unsigned> hitBits(BatchCollision::HitBitsWordCount(sphereCount));
+    vector<unsigned> hitIndices(sphereCount);
+    size_t hitCount[4] = { 0, 0, 0, 0 };
+    real testsPerCall = real(sphereCount) * KernelQueryCount / 1000000.0f;
+    StopWatch watch;
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        BoundingSphere query(QueryRadius, queries[q]);
+
+        for (size_t i = 0; i < sphereCount; ++i)
+        {
+            if (BoundingSphere(radius[i], Vec3(posX[i], posY[i], posZ[i])).Collide(query))
+                ++hitCount[0];
+        }
+    }
+    real perCallTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        BatchCollision::OverlapSphere(BoundingSphere(QueryRadius, queries[q]),
+            posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount, hitBits.data());
+        hitCount[1] += hitBits[0] & 1;
+    }
+    real bitsTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        hitCount[2] += BatchCollision::OverlapSphereIndices(BoundingSphere(QueryRadius, queries[q]),
+            posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount, hitIndices.data());
+    }
+    real indicesTime = watch.Stop();
+
+    printf("%8u spheres: sphere overlap Mtests/s: per call %8.1f, batch bits %8.1f, batch indices %8.1f (%u/%u hits)\n",
+        unsigned(sphereCount),
+        testsPerCall / perCallTime,
+        testsPerCall / bitsTime,
+        testsPerCall / indicesTime,
+        unsigned(hitCount[0]),
+        unsigned(hitCount[2]));
+
+    hitCount[0] = hitCount[2] = 0;
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        for (size_t i = 0; i < sphereCount; ++i)
+        {
+            if (BoundingSphere(radius[i], Vec3(posX[i], posY[i], posZ[i])).IsPointInside(queries[q]))
+                ++hitCount[0];
+        }
+    }
+    perCallTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        BatchCollision::ContainsPoint(queries[q], posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount, hitBits.data());
+        hitCount[3] += hitBits[0] & 1;
+    }
+    bitsTime = watch.Stop();
+
+    watch.Start();
+    for (int q = 0; q < KernelQueryCount; ++q)
+    {
+        hitCount[2] += BatchCollision::ContainsPointIndices(queries[q],
+            posX.data(), posY.data(), posZ.data(), radius.data(), sphereCount, hitIndices.data());
+    }
+    indicesTime = watch.Stop();
+
+    printf("%8u spheres: point inside  Mtests/s: per call %8.1f, batch bits %8.1f, batch indices %8.1f (%u/%u hits)\n",
+        unsigned(sphereCount),
+        testsPerCall / perCallTime,
+        testsPerCall / bitsTime,
+        testsPerCall / indicesTime,
+        unsigned(hitCount[0]),
+        unsigned(hitCount[2]));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Compares the Euler angles 4x4 matrix path to the QuatTransform path over the same transforms, in millions of
+// transforms per second: building the world transform, composing it with the view, inverting it (world to local)
+// and reading its forward direction. The sums only keep the compiler from dropping the loops.
+//---------------------------------------------------------------------------------------------------------------------
+void BenchTransforms(_In_ size_t transformCount)
+{
+    mt19937 rng(1234);
+    uniform_real_distribution<real> angleDist(-XM_PI, XM_PI);
+    uniform_real_distribution<real> posDist(-100.0f, 100.0f);
+
+    vector<Vec3> rotations(transformCount), positions(transformCount);
+
+    for (size_t i = 0; i < transformCount; ++i)
+    {
+        rotations[i] = Vec3(angleDist(rng), angleDist(rng), angleDist(rng));
+        positions[i] = Vec3(posDist(rng), posDist(rng), posDist(rng));
+    }
+
+    vector<Mat4x4> matrices(transformCount);
+    vector<QuatTransform> quats(transformCount);
+    real count = real(transformCount) / 1000000.0f;
+    real matSum = 0.0f;
+    real quatSum = 0.0f;
+    StopWatch watch;
+
+    Mat4x4 viewMat;
+    XMStoreFloat4x4(&viewMat, XMMatrixLookAtLH(XMVectorSet(10.0f, 20.0f, -50.0f, 1.0f), g_XMZero, g_XMIdentityR1));
+    QuatTransform view;
+    XMStoreFloat4(&view.Rotation, XMQuaternionRotationMatrix(XMLoadFloat4x4(&viewMat)));
+    view.Translation = Vec3(viewMat._41, viewMat._42, viewMat._43);
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+    {
+        XMMATRIX m = XMMatrixRotationRollPitchYaw(rotations[i].x, rotations[i].y, rotations[i].z);
+        m.r[3] = XMVectorSetW(XMLoadFloat3(&positions[i]), 1.0f);
+        XMStoreFloat4x4(&matrices[i], m);
+    }
+    real matBuildTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+        quats[i] = QuatTransform(QuatTransform::EulerToQuaternion(rotations[i]), positions[i]);
+    real quatBuildTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+    {
+        Mat4x4 worldView;
+        XMStoreFloat4x4(&worldView, XMMatrixMultiply(XMLoadFloat4x4(&matrices[i]), XMLoadFloat4x4(&viewMat)));
+        matSum += worldView._43;
+    }
+    real matComposeTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+        quatSum += QuatTransform::Compose(quats[i], view).Translation.z;
+    real quatComposeTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+    {
+        Mat4x4 inv;
+        XMStoreFloat4x4(&inv, XMMatrixInverse(nullptr, XMLoadFloat4x4(&matrices[i])));
+        matSum += inv._43;
+    }
+    real matInverseTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+        quatSum += quats[i].Inverse().Translation.z;
+    real quatInverseTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+    {
+        Vec3 dir;
+        XMStoreFloat3(&dir, XMVector3TransformNormal(g_XMIdentityR2, XMLoadFloat4x4(&matrices[i])));
+        matSum += dir.z;
+    }
+    real matDirTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < transformCount; ++i)
+        quatSum += quats[i].Forward().z;
+    real quatDirTime = watch.Stop();
+
+    printf("%8u transforms Mtsfm/s: build %8.1f / %8.1f, compose %8.1f / %8.1f, inverse %8.1f / %8.1f, direction %8.1f / %8.1f (sums %.1f/%.1f)\n",
+        unsigned(transformCount),
+        count / matBuildTime, count / quatBuildTime,
+        count / matComposeTime, count / quatComposeTime,
+        count / matInverseTime, count / quatInverseTime,
+        count / matDirTime, count / quatDirTime,
+        matSum, quatSum);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// VecMath kernels throughput in millions of operations per second for the backend this benchmark is compiled with,
+// build it with /arch:SSE2, /arch:AVX, /arch:AVX2 or ENGIX_VECMATH_SCALAR defined to compare the backends. The
+// DirectXMath columns run the same operations through DirectXMath as the reference.
+//---------------------------------------------------------------------------------------------------------------------
+void BenchVecMath(_In_ size_t vectorCount)
+{
+    mt19937 rng(1234);
+    uniform_real_distribution<real> valueDist(-1.0f, 1.0f);
+
+    vector<Vec3> vectors(vectorCount);
+    vector<Vec4> quats(vectorCount);
+    vector<Mat4x4> matrices(vectorCount / 16 + 1);
+
+    for (size_t i = 0; i < vectorCount; ++i)
+    {
+        vectors[i] = Vec3(valueDist(rng), valueDist(rng), valueDist(rng));
+        quats[i] = QuatTransform::EulerToQuaternion(Vec3(valueDist(rng) * XM_PI, valueDist(rng) * XM_PI, valueDist(rng) * XM_PI));
+    }
+
+    for (auto& m : matrices)
+    {
+        for (int r = 0; r < 4; ++r)
+            for (int c = 0; c < 4; ++c)
+                m.m[r][c] = valueDist(rng);
+    }
+
+    real count = real(vectorCount) / 1000000.0f;
+    real vmSum = 0.0f;
+    real xmSum = 0.0f;
+    StopWatch watch;
+
+    // Normalized cross product
+    watch.Start();
+    for (size_t i = 1; i < vectorCount; ++i)
+        vmSum += VecMath::GetX(VecMath::Normalize3(VecMath::Cross3(VecMath::Load3(vectors[i - 1]), VecMath::Load3(vectors[i]))));
+    real vmCrossTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 1; i < vectorCount; ++i)
+        xmSum += XMVectorGetX(XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&vectors[i - 1]), XMLoadFloat3(&vectors[i]))));
+    real xmCrossTime = watch.Stop();
+
+    // Point transform, 16 points per matrix
+    watch.Start();
+    for (size_t i = 0; i < vectorCount; ++i)
+        vmSum += VecMath::GetY(VecMath::TransformPoint3(VecMath::Load3(vectors[i]), VecMath::LoadMatrix(matrices[i / 16])));
+    real vmTransformTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < vectorCount; ++i)
+        xmSum += XMVectorGetY(XMVector3Transform(XMLoadFloat3(&vectors[i]), XMLoadFloat4x4(&matrices[i / 16])));
+    real xmTransformTime = watch.Stop();
+
+    // Matrix concatenation
+    Mat4x4 product;
+    const size_t matrixCount = matrices.size();
+
+    watch.Start();
+    for (size_t i = 1; i < matrixCount; ++i)
+    {
+        VecMath::StoreMatrix(product, VecMath::MatrixMultiply(VecMath::LoadMatrix(matrices[i - 1]), VecMath::LoadMatrix(matrices[i])));
+        vmSum += product._44;
+    }
+    real vmMultiplyTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 1; i < matrixCount; ++i)
+    {
+        XMStoreFloat4x4(&product, XMMatrixMultiply(XMLoadFloat4x4(&matrices[i - 1]), XMLoadFloat4x4(&matrices[i])));
+        xmSum += product._44;
+    }
+    real xmMultiplyTime = watch.Stop();
+
+    // Quaternion rotation
+    watch.Start();
+    for (size_t i = 0; i < vectorCount; ++i)
+        vmSum += VecMath::GetZ(VecMath::Rotate3(VecMath::Load3(vectors[i]), VecMath::Load4(quats[i])));
+    real vmRotateTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < vectorCount; ++i)
+        xmSum += XMVectorGetZ(XMVector3Rotate(XMLoadFloat3(&vectors[i]), XMLoadFloat4(&quats[i])));
+    real xmRotateTime = watch.Stop();
+
+    real matrixOps = real(matrixCount) / 1000000.0f;
+
+    printf("%8u vectors Mops/s VecMath / DirectXMath: cross+normalize %8.1f / %8.1f, transform %8.1f / %8.1f, matrix multiply %8.1f / %8.1f, rotate %8.1f / %8.1f (sums %.1f/%.1f)\n",
+        unsigned(vectorCount),
+        count / vmCrossTime, count / xmCrossTime,
+        count / vmTransformTime, count / xmTransformTime,
+        matrixOps / vmMultiplyTime, matrixOps / xmMultiplyTime,
+        count / vmRotateTime, count / xmRotateTime,
+        vmSum, xmSum);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Random number generation benchmark
+//
+// Fills an SoA array with uniform reals through the C runtime rand, the scalar Random and the 4 lanes Random4, then
+// fills unit vectors with Random4. The parallel fill runs on pools of different sizes and must give the same numbers
+// since each block has its own stream.
+//---------------------------------------------------------------------------------------------------------------------
+void BenchRandom(_In_ size_t valueCount)
+{
+    RealArray values(valueCount);
+    RealArray x(valueCount), y(valueCount), z(valueCount);
+    real count = real(valueCount) / 1000000.0f;
+    real sum = 0.0f;
+    StopWatch watch;
+
+    watch.Start();
+    for (size_t i = 0; i < valueCount; ++i)
+        values[i] = real(rand()) / real(RAND_MAX);
+    real crtTime = watch.Stop();
+    sum += values[valueCount - 1];
+
+    Random scalarRng(1234);
+
+    watch.Start();
+    for (size_t i = 0; i < valueCount; ++i)
+        values[i] = scalarRng.NextReal();
+    real scalarTime = watch.Stop();
+    sum += values[valueCount - 1];
+
+    Random4 rng(1234);
+
+    watch.Start();
+    rng.FillUniform(&values[0], valueCount);
+    real simdTime = watch.Stop();
+    sum += values[valueCount - 1];
+
+    watch.Start();
+    rng.FillUnitVec3(&x[0], &y[0], &z[0], valueCount);
+    real unitVecTime = watch.Stop();
+    sum += z[valueCount - 1];
+
+    WorkerPool serialPool(0);
+    WorkerPool parallelPool;
+    RealArray parallelValues(valueCount);
+
+    Random4::ParallelBlocks(serialPool, 1234, valueCount, [&](Random4& blockRng, size_t begin, size_t end) {
+        blockRng.FillUniform(&values[begin], end - begin);
+    });
+
+    watch.Start();
+    Random4::ParallelBlocks(parallelPool, 1234, valueCount, [&](Random4& blockRng, size_t begin, size_t end) {
+        blockRng.FillUniform(&parallelValues[begin], end - begin);
+    });
+    real parallelTime = watch.Stop();
+
+    bool isDeterministic = equal(values.begin(), values.end(), parallelValues.begin());
+
+    printf("%8u values M/s rand %8.1f, Random %8.1f, Random4 %8.1f, unit vec3 %8.1f, %u threads %8.1f %s (sum %.1f)\n",
+        unsigned(valueCount),
+        count / crtTime, count / scalarTime, count / simdTime, count / unitVecTime,
+        parallelPool.ThreadCount() + 1, count / parallelTime,
+        isDeterministic ? "deterministic" : "MISMATCH",
+        sum);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Batch transcendentals benchmark
+//
+// Runs the C library functions through the real_* macros, then each Simd batch accuracy tier on the same inputs and
+// reports the tiers throughput and max error against the C library results computed in double precision, flagged
+// when above the tier bound. The sine and cosine errors are absolute, the exponent and power ones relative. The power inputs mimic the damping: bases in
+// (0, 1] raised to a time step.
+//---------------------------------------------------------------------------------------------------------------------
+void BenchTranscendentals(_In_ size_t valueCount)
+{
+    mt19937 rng(1234);
+    uniform_real_distribution<real> angleDist(-100.0f, 100.0f);
+    uniform_real_distribution<real> expDist(-20.0f, 20.0f);
+    uniform_real_distribution<real> baseDist(0.01f, 1.0f);
+    const real dt = 1.0f / 60.0f;
+
+    RealArray angles(valueCount), exponents(valueCount), bases(valueCount);
+    RealArray sines(valueCount), cosines(valueCount), results(valueCount);
+
+    for (size_t i = 0; i < valueCount; ++i)
+    {
+        angles[i] = angleDist(rng);
+        exponents[i] = expDist(rng);
+        bases[i] = baseDist(rng);
+    }
+
+    real count = real(valueCount) / 1000000.0f;
+    real sum = 0.0f;
+    StopWatch watch;
+
+    watch.Start();
+    for (size_t i = 0; i < valueCount; ++i)
+    {
+        sines[i] = real_sin(angles[i]);
+        cosines[i] = real_cos(angles[i]);
+    }
+    real crtSinCosTime = watch.Stop();
+
+    watch.Start();
+    for (size_t i = 0; i < valueCount; ++i)
+        results[i] = real_exp(exponents[i]);
+    real crtExpTime = watch.Stop();
+    sum += results[valueCount - 1];
+
+    watch.Start();
+    for (size_t i = 0; i < valueCount; ++i)
+        results[i] = real_pow(bases[i], dt);
+    real crtPowTime = watch.Stop();
+    sum += sines[valueCount - 1] + cosines[valueCount - 1] + results[valueCount - 1];
+
+    printf("%8u values M/s C library: sin+cos %8.1f, exp %8.1f, pow %8.1f\n",
+        unsigned(valueCount), count / crtSinCosTime, count / crtExpTime, count / crtPowTime);
+
+    const char* tierNames[] = { "Full", "Medium", "Fast" };
+    const Simd::MathAccuracy tiers[] = { Simd::ACCURACY_Full, Simd::ACCURACY_Medium, Simd::ACCURACY_Fast };
+    // Max error of each tier with some headroom over the SimdMath.h figures, the power exponent is small enough
+    // for its logarithm error term to vanish
+    const double maxErrors[] = { 1e-6, 2e-5, 3e-3 };
+
+    for (int t = 0; t < 3; ++t)
+    {
+        double sinCosError = 0.0;
+        double expError = 0.0;
+        double powError = 0.0;
+
+        watch.Start();
+        Simd::SinCos(&angles[0], &sines[0], &cosines[0], valueCount, tiers[t]);
+        real sinCosTime = watch.Stop();
+
+        for (size_t i = 0; i < valueCount; ++i)
+        {
+            sinCosError = max(sinCosError, fabs(sines[i] - sin(double(angles[i]))));
+            sinCosError = max(sinCosError, fabs(cosines[i] - cos(double(angles[i]))));
+        }
+
+        watch.Start();
+        Simd::Exp(&exponents[0], &results[0], valueCount, tiers[t]);
+        real expTime = watch.Stop();
+
+        for (size_t i = 0; i < valueCount; ++i)
+            expError = max(expError, fabs(results[i] / exp(double(exponents[i])) - 1.0));
+
+        watch.Start();
+        Simd::Pow(&bases[0], dt, &results[0], valueCount, tiers[t]);
+        real powTime = watch.Stop();
+
+        for (size_t i = 0; i < valueCount; ++i)
+            powError = max(powError, fabs(results[i] / pow(double(bases[i]), double(dt)) - 1.0));
+
+        sum += sines[valueCount - 1] + results[valueCount - 1];
+
+        bool isAccurate = sinCosError <= maxErrors[t] && expError <= maxErrors[t] && powError <= maxErrors[t];
+
+        printf("%8u values M/s %-6s   : sin+cos %8.1f, exp %8.1f, pow %8.1f, max error sin+cos %.1e, exp %.1e, pow %.1e %s\n",
+            unsigned(valueCount), tierNames[t],
+            count / sinCosTime, count / expTime, count / powTime,
+            sinCosError, expError, powError,
+            isAccurate ? "within bounds" : "MISMATCH");
+    }
+
+    printf("(sum %.1f)\n", sum);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Render queue benchmark
+//
+// Fills the queue with draws of random meshes, a quarter of them wireframe, and submits them to a NullRenderDevice
+// once in traversal order and once radix sorted, reporting the time per frame and the binds each order costs.
+//---------------------------------------------------------------------------------------------------------------------
+const int RenderQueueMeshCount = 64;
+const int RenderQueueFrames = 10;
+
+void BenchRenderQueue(_In_ size_t drawCount)
+{
+    mt19937 rng(1234);
+    uniform_int_distribution<int> meshDist(0, RenderQueueMeshCount - 1);
+    uniform_int_distribution<int> flagsDist(0, 3);
+
+    NullRenderDevice device;
+    vector<MeshHandle> meshes(RenderQueueMeshCount);
+    vector<unsigned> indices(36);
+
+    for (int i = 0; i < RenderQueueMeshCount; ++i)
+        device.CreateMesh(nullptr, 0, &indices[0], indices.size(), meshes[i]);
+
+    vector<MeshHandle> drawMeshes(drawCount);
+    vector<unsigned> drawFlags(drawCount);
+
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        drawMeshes[i] = meshes[meshDist(rng)];
+        drawFlags[i] = (flagsDist(rng) == 0 ? RASTER_Wireframe : 0);
+    }
+
+    Mat4x4 worldViewProj;
+    XMStoreFloat4x4(&worldViewProj, XMMatrixIdentity());
+    Color3 color(1.0f, 0.0f, 0.0f);
+
+    RenderQueue queue;
+    StopWatch watch;
+    real unsortedTime = 0.0f;
+    real sortedTime = 0.0f;
+    unsigned unsortedBinds = 0;
+    unsigned sortedBinds = 0;
+    unsigned sortedDraws = 0;
+
+    for (int frame = 0; frame < RenderQueueFrames; ++frame)
+    {
+        device.BeginFrame();
+        watch.Start();
+        queue.Clear();
+        for (size_t i = 0; i < drawCount; ++i)
+            queue.Add(drawMeshes[i], drawFlags[i], worldViewProj, color);
+        queue.Submit(device);
+        unsortedTime += watch.Stop();
+        unsortedBinds = device.FrameStats().StateChangeCount;
+
+        device.BeginFrame();
+        watch.Start();
+        queue.Clear();
+        for (size_t i = 0; i < drawCount; ++i)
+            queue.Add(drawMeshes[i], drawFlags[i], worldViewProj, color);
+        queue.Sort();
+        queue.Submit(device);
+        sortedTime += watch.Stop();
+        sortedBinds = device.FrameStats().StateChangeCount;
+        sortedDraws = device.FrameStats().DrawCount;
+    }
+
+    printf("%8u draws unsorted %8.3f ms %8u binds, sorted %8.3f ms %8u binds%s\n",
+        unsigned(drawCount),
+        unsortedTime * 1000.0f / RenderQueueFrames, unsortedBinds,
+        sortedTime * 1000.0f / RenderQueueFrames, sortedBinds,
+        sortedDraws == drawCount ? "" : " DRAW COUNT MISMATCH");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Mesh cache benchmark
+//
+// Creates the meshes of a scene of bullets, a few sphere sizes repeated many times, once by generating every node
+// own copy like the nodes did before the cache and once through the MeshCache. Reports the time and the vertex and
+// index memory both ways.
+//---------------------------------------------------------------------------------------------------------------------
+const int MeshCacheSphereSizes = 4;
+
+void BenchMeshCache(_In_ size_t nodeCount)
+{
+    StopWatch watch;
+    GeometryGenerator g;
+    size_t ownBytes = 0;
+
+    watch.Start();
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        GeometryGenerator::MeshData data;
+        g.CreateGeosphere(0.5f + real(i % MeshCacheSphereSizes), 2, data);
+        ownBytes += data.Vertices.size() * sizeof(Vertex_Position) + data.Indices.size() * sizeof(unsigned);
+    }
+    real ownTime = watch.Stop();
+
+    shared_ptr<IRenderDevice> pDevice(eNEW NullRenderDevice);
+    MeshCache cache(pDevice);
+    vector<StrongSharedMeshPtr> nodeMeshes(nodeCount);
+
+    watch.Start();
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        nodeMeshes[i] = cache.Acquire(MeshKey::Geosphere(0.5f + real(i % MeshCacheSphereSizes), 2));
+        cache.CreateDeviceMesh(*nodeMeshes[i]);
+    }
+    real cacheTime = watch.Stop();
+
+    size_t sharedBytes = 0;
+    for (int i = 0; i < MeshCacheSphereSizes; ++i)
+        sharedBytes += nodeMeshes[i]->Vertices().size() * sizeof(Vertex_Position) + nodeMeshes[i]->Indices().size() * sizeof(unsigned);
+
+    bool isShared = (cache.LiveCount() == MeshCacheSphereSizes && nodeMeshes[0] == nodeMeshes[MeshCacheSphereSizes]);
+
+    nodeMeshes.clear();
+
+    printf("%8u nodes own copies %8.3f ms %8u KB, cached %8.3f ms %8u KB %s, %u live after release\n",
+        unsigned(nodeCount),
+        ownTime * 1000.0f, unsigned(ownBytes / 1024),
+        cacheTime * 1000.0f, unsigned(sharedBytes / 1024),
+        isShared ? "shared" : "NOT SHARED",
+        unsigned(cache.LiveCount()));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// ParticleIntegrator step on one core in millions of particles per second and milliseconds per frame. Particles get
+// random masses, velocities and one of a few damping values like the game objects, a quarter of them are
+// immovable so the masks are exercised.
+//---------------------------------------------------------------------------------------------------------------------
+const int IntegratorRuns = 10;
+const real IntegratorTimeStep = 1.0f / 60.0f;
+const int IntegratorDampingCount = 4;
+const real IntegratorDampings[IntegratorDampingCount] = { 1.0f, 0.99f, 0.95f, 0.8f };
+
+void BenchIntegrator(_In_ size_t particleCount)
+{
+    mt19937 rng(1234);
+    uniform_real_distribution<real> velDist(-10.0f, 10.0f);
+    uniform_real_distribution<real> invMassDist(0.1f, 2.0f);
+    uniform_int_distribution<int> dampingDist(0, IntegratorDampingCount - 1);
+
+    ParticleIntegrator integrator;
+
+    for (size_t i = 0; i < particleCount; ++i)
+    {
+        ParticleSlot slot = integrator.Allocate(nullptr);
+        integrator.InverseMass(slot, (i % 4 == 0) ? 0.0f : invMassDist(rng));
+        integrator.Velocity(slot, Vec3(velDist(rng), velDist(rng), velDist(rng)));
+        integrator.BaseAcceleration(slot, Vec3(0.0f, -10.0f, 0.0f));
+        integrator.Damping(slot, IntegratorDampings[dampingDist(rng)]);
+    }
+
+    StopWatch watch;
+    real integrateTime = 0.0f;
+
+    for (int run = 0; run < IntegratorRuns; ++run)
+    {
+        watch.Start();
+        integrator.Integrate(IntegratorTimeStep);
+        integrateTime += watch.Stop();
+    }
+
+    real frameTime = integrateTime / IntegratorRuns;
+    Vec3 pos = integrator.Position(ParticleSlot(particleCount - 1));
+
+    printf("%8u particles: integrate %8.2fms, %8.1f Mparticles/s (last at %.1f %.1f %.1f)\n",
+        unsigned(particleCount),
+        frameTime * 1000.0f,
+        real(particleCount) / 1000000.0f / frameTime,
+        pos.x, pos.y, pos.z);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Scene benchmark
+//
+// Runs whole frames of a headless game, a grid of box and sphere actors seen from above by one camera: the logic
+// update dispatches the events, steps the simulation and updates the NullGameView scene, then the view renders to its
+// NullRenderDevice. Reports per frame the update time, the scene traversal time and the draws and triangles
+// submitted.
+//---------------------------------------------------------------------------------------------------------------------
+const int SceneFrames = 10;
+const real SceneNodeSpacing = 2.0f;
+
+class BenchSceneApp : public GameApp
+{
+public:
+    bool Init(HINSTANCE hInstance, LPWSTR lpCmdLine) { return true; }
+    void Deinit() {}
+    void Run() {}
+    int ExitCode() const { return 0; }
+    real AspectRatio() const { return 4.0f / 3.0f; }
+};
+
+class BenchSceneLogic : public GameLogic
+{
+public:
+    BenchSceneLogic(_In_ size_t nodeCount) :
+        m_nodeCount(nodeCount)
+    {}
+
+    // Nodes per row of the square grid
+    size_t GridSide() const { return size_t(real_sqrt(real(m_nodeCount))) + 1; }
+
+protected:
+    bool LoadLevel()
+    {
+        const size_t side = GridSide();
+        const real halfExtent = 0.5f * SceneNodeSpacing * real(side);
+
+        for (size_t i = 0; i < m_nodeCount; ++i)
+        {
+            ActorUniquePtr pActor(eNEW Actor(L"SceneNode"));
+
+            if (i % 2 == 0)
+            {
+                BoxMeshComponent::Properties props;
+                props.Width = props.Height = props.Depth = 1.0f;
+                pActor->Add<BoxMeshComponent>(props);
+            }
+            else
+            {
+                SphereMeshComponent::Properties props;
+                props.Radius = 0.5f;
+                pActor->Add<SphereMeshComponent>(props);
+            }
+
+            pActor->Add<TransformCmpt>().Position(Vec3(SceneNodeSpacing * real(i % side) - halfExtent, 0.0f, SceneNodeSpacing * real(i / side) - halfExtent));
+            CBRB(AddInitActor(std::move(pActor)));
+        }
+
+        return true;
+    }
+
+    size_t m_nodeCount;
+};
+
+void BenchScene(_In_ size_t nodeCount)
+{
+    BenchSceneApp app;
+    BenchSceneLogic logic(nodeCount);
+    NullGameView* pView = eNEW NullGameView(&logic, app.AspectRatio());
+
+    // The actor components find their logic systems through the app
+    g_pApp = &app;
+    app.m_pGameLogic = &logic;
+    logic.View(pView);
+
+    if (!logic.Init())
+    {
+        printf("%8u nodes SCENE INIT FAILED\n", unsigned(nodeCount));
+        g_pApp = nullptr;
+        return;
+    }
+
+    // Looks down on the grid center from far enough to see most of it
+    pView->Scene()->AddCamera()->PlaceOnSphere(SceneNodeSpacing * real(logic.GridSide()), 0.25f * R_PI, 0.25f * R_PI);
+    pView->OnConstruct();
+
+    // The first update dispatches the actors created events, the scene nodes are created then
+    Timer time;
+    time.Reset();
+    time.Tick();
+    logic.OnUpdate(time);
+
+    StopWatch watch;
+    real updateTime = 0.0f;
+    real traversalTime = 0.0f;
+
+    for (int frame = 0; frame < SceneFrames; ++frame)
+    {
+        time.Tick();
+
+        watch.Start();
+        logic.OnUpdate(time);
+        updateTime += watch.Stop();
+
+        pView->OnRender();
+        traversalTime += pView->Scene()->TraversalTime();
+    }
+
+    const FrustumCuller& culler = pView->Scene()->Culler();
+    const RenderStats& stats = pView->Scene()->FrameStats();
+
+    printf("%8u nodes update %8.3f ms traversal %8.3f ms, %8u visible %8u draws %10u triangles\n",
+        unsigned(nodeCount),
+        updateTime * 1000.0f / SceneFrames,
+        traversalTime * 1000.0f / SceneFrames,
+        unsigned(culler.VisibleCount()),
+        unsigned(stats.DrawCount),
+        unsigned(stats.TriangleCount));
+
+    g_pApp = nullptr;
+}
+
+int main()
+{
+    printf("SpatialHashBroadphase, cell size %.2f\n", SpatialHashBroadphase::DefaultCellSize);
+
+    BenchBroadphase(10000);
+    BenchBroadphase(100000);
+    BenchBroadphase(1000000);
+
+    printf("AabbTree, fat margin %.2f\n", AabbTree::DefaultFatMargin);
+
+    BenchAabbTree(10000);
+    BenchAabbTree(100000);
+    BenchAabbTree(1000000);
+
+    printf("BatchCollision, %u wide\n", unsigned(Simd::Width));
+
+    BenchBatchCollision(10000);
+    BenchBatchCollision(100000);
+    BenchBatchCollision(1000000);
+
+    printf("Transforms, Euler matrix / quaternion\n");
+
+    BenchTransforms(10000);
+    BenchTransforms(100000);
+    BenchTransforms(1000000);
+
+    printf("VecMath, %s backend\n", VecMath::BackendName);
+
+    BenchVecMath(100000);
+    BenchVecMath(1000000);
+
+    printf("Random, xoshiro128+\n");
+
+    BenchRandom(100000);
+    BenchRandom(1000000);
+
+    printf("Batch transcendentals, default accuracy %d\n", int(REAL_BATCH_ACCURACY));
+
+    BenchTranscendentals(100000);
+    BenchTranscendentals(1000000);
+
+    printf("ParticleIntegrator, %u wide\n", unsigned(Simd::Width));
+
+    BenchIntegrator(10000);
+    BenchIntegrator(100000);
+    BenchIntegrator(1000000);
+
+    printf("RenderQueue, %d meshes, NullRenderDevice\n", RenderQueueMeshCount);
+
+    BenchRenderQueue(1000);
+    BenchRenderQueue(10000);
+    BenchRenderQueue(100000);
+
+    printf("MeshCache, %d sphere sizes\n", MeshCacheSphereSizes);
+
+    BenchMeshCache(1000);
+    BenchMeshCache(10000);
+
+    printf("Scene, %d frames, NullGameView\n", SceneFrames);
+
+    BenchScene(1000);
+    BenchScene(10000);
+
+    return 0;
+}